@@ -22,6 +22,7 @@
 #include <Utils/BinaryWriter.h>
 
 std::string otrFileName = "oot.otr";
+size_t otrRawFileSize = 0;
 std::shared_ptr<Ship::Archive> otrArchive;
 BinaryWriter* fileWriter;
 std::chrono::steady_clock::time_point fileStart, resStart;
@@ -54,6 +55,8 @@ static void ExporterParseFileMode(const std::string& buildMode, ZFileMode& fileM
 			auto fileData = File::ReadAllBytes(item);
 			otrArchive->AddFile(StringHelper::Split(item, "Extract\\")[1], (uintptr_t)fileData.data(), fileData.size());
 		}
+
+		otrArchive->WriteCRCIndex();
 	}
 }
 
@@ -67,7 +70,8 @@ static void ExporterProgramEnd()
 		for (auto item : files)
 		{
 			auto fileData = item.second;
-			otrArchive->AddFile(item.first, (uintptr_t)fileData.data(), fileData.size());
+			// Small resources are stored uncompressed so the game can read them straight out of the mapped archive.
+			otrArchive->AddFile(item.first, (uintptr_t)fileData.data(), fileData.size(), fileData.size() > otrRawFileSize);
 		}
 
 		// Add any additional files that need to be manually copied...
@@ -82,6 +86,8 @@ static void ExporterProgramEnd()
 		otrArchive->AddFile("Audiobank", (uintptr_t)Globals::Instance->GetBaseromFile("Audiobank").data(), Globals::Instance->GetBaseromFile("Audiobank").size());
 		otrArchive->AddFile("Audioseq", (uintptr_t)Globals::Instance->GetBaseromFile("Audioseq").data(), Globals::Instance->GetBaseromFile("Audioseq").size());
 		otrArchive->AddFile("Audiotable", (uintptr_t)Globals::Instance->GetBaseromFile("Audiotable").data(), Globals::Instance->GetBaseromFile("Audiotable").size());
+
+		otrArchive->WriteCRCIndex();
 	}
 }
 
@@ -95,6 +101,11 @@ static void ExporterParseArgs(int argc, char* argv[], int& i)
 		otrFileName = argv[i + 1];
 		i++;
 	}
+	else if (arg == "--otrrawsize")
+	{
+		otrRawFileSize = std::stoul(argv[i + 1]);
+		i++;
+	}
 }
 
 static bool ExporterProcessFileMode(ZFileMode fileMode)
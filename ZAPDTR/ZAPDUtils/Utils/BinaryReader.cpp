@@ -13,86 +13,66 @@ BinaryReader::BinaryReader(std::shared_ptr<Stream> nStream)
 	stream = nStream;
 }
 
-void BinaryReader::Close()
-{
-	stream->Close();
-}
-
-void BinaryReader::Seek(uint32_t offset, SeekOffsetType seekType)
-{
-	stream->Seek(offset, seekType);
-}
-
-uint32_t BinaryReader::GetBaseAddress()
+BinaryReader::BinaryReader(const char* nBuffer, size_t nBufferSize)
 {
-	return stream->GetBaseAddress();
+	span = nBuffer;
+	spanSize = nBufferSize;
+	spanPos = 0;
 }
 
-void BinaryReader::Read([[maybe_unused]] char* buffer, int32_t length)
-{
-	stream->Read(length);
-}
-
-char BinaryReader::ReadChar()
-{
-	return (char)stream->ReadByte();
-}
-
-int8_t BinaryReader::ReadByte()
-{
-	return stream->ReadByte();
-}
-
-uint8_t BinaryReader::ReadUByte()
+void BinaryReader::Close()
 {
-	return (uint8_t)stream->ReadByte();
+	if (stream != nullptr)
+		stream->Close();
 }
 
-int16_t BinaryReader::ReadInt16()
+void BinaryReader::Seek(uint32_t offset, SeekOffsetType seekType)
 {
-	int16_t result = 0;
+	if (span == nullptr)
+	{
+		stream->Seek(offset, seekType);
+		return;
+	}
 
-	stream->Read((char*)&result, sizeof(int16_t));
-	return result;
+	// Mirrors MemoryStream::Seek.
+	if (seekType == SeekOffsetType::Start)
+		spanPos = offset;
+	else if (seekType == SeekOffsetType::Current)
+		spanPos += (int32_t)offset;
+	else if (seekType == SeekOffsetType::End)
+		spanPos = spanSize - 1 - offset;
 }
 
-int32_t BinaryReader::ReadInt32()
+uint32_t BinaryReader::GetBaseAddress()
 {
-	int32_t result = 0;
-
-	stream->Read((char*)&result, sizeof(int32_t));
-	return result;
+	return span != nullptr ? (uint32_t)spanPos : stream->GetBaseAddress();
 }
 
-uint16_t BinaryReader::ReadUInt16()
+uint64_t BinaryReader::GetLength()
 {
-	uint16_t result = 0;
-
-	stream->Read((char*)&result, sizeof(uint16_t));
-	return result;
+	return span != nullptr ? spanSize : stream->GetLength();
 }
 
-uint32_t BinaryReader::ReadUInt32()
+void BinaryReader::Read(char* buffer, int32_t length)
 {
-	uint32_t result = 0;
-
-	stream->Read((char*)&result, sizeof(uint32_t));
-	return result;
+	ReadBytes(buffer, length);
 }
 
-uint64_t BinaryReader::ReadUInt64()
+void BinaryReader::ReadBytes(char* dest, size_t length)
 {
-	uint64_t result = 0;
-
-	stream->Read((char*)&result, sizeof(uint64_t));
-	return result;
+	if (span != nullptr)
+	{
+		CheckSpan(length);
+		memcpy(dest, span + spanPos, length);
+		spanPos += length;
+	}
+	else
+		stream->Read(dest, length);
 }
 
 float BinaryReader::ReadSingle()
 {
-	float result = NAN;
-
-	stream->Read((char*)&result, sizeof(float));
+	float result = ReadScalar<float>();
 
 	if (std::isnan(result))
 		throw std::runtime_error("BinaryReader::ReadSingle(): Error reading stream");
@@ -102,9 +82,8 @@ float BinaryReader::ReadSingle()
 
 double BinaryReader::ReadDouble()
 {
-	double result = NAN;
+	double result = ReadScalar<double>();
 
-	stream->Read((char*)&result, sizeof(double));
 	if (std::isnan(result))
 		throw std::runtime_error("BinaryReader::ReadDouble(): Error reading stream");
 
@@ -138,11 +117,14 @@ Color3b BinaryReader::ReadColor3b()
 
 std::string BinaryReader::ReadString()
 {
-	std::string res;
 	int numChars = ReadInt32();
 
-	for (int i = 0; i < numChars; i++)
-		res += ReadChar();
+	if (numChars <= 0)
+		return "";
+
+	std::string res(numChars, '\0');
+
+	ReadBytes(res.data(), numChars);
 
 	return res;
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <array>
+#include <cstring>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "../Color3b.h"
@@ -15,21 +17,25 @@ class BinaryReader
 public:
 	BinaryReader(Stream* nStream);
 	BinaryReader(std::shared_ptr<Stream> nStream);
+	// Reads straight out of nBuffer instead of going through a Stream. The buffer is not copied, so it has to outlive the reader.
+	BinaryReader(const char* nBuffer, size_t nBufferSize);
 
 	void Close();
 
 	void Seek(uint32_t offset, SeekOffsetType seekType);
 	uint32_t GetBaseAddress();
+	uint64_t GetLength();
 
 	void Read(char* buffer, int32_t length);
-	char ReadChar();
-	int8_t ReadByte();
-	int16_t ReadInt16();
-	int32_t ReadInt32();
-	uint8_t ReadUByte();
-	uint16_t ReadUInt16();
-	uint32_t ReadUInt32();
-	uint64_t ReadUInt64();
+	void ReadBytes(char* dest, size_t length);
+	char ReadChar() { return ReadScalar<char>(); }
+	int8_t ReadByte() { return ReadScalar<int8_t>(); }
+	int16_t ReadInt16() { return ReadScalar<int16_t>(); }
+	int32_t ReadInt32() { return ReadScalar<int32_t>(); }
+	uint8_t ReadUByte() { return ReadScalar<uint8_t>(); }
+	uint16_t ReadUInt16() { return ReadScalar<uint16_t>(); }
+	uint32_t ReadUInt32() { return ReadScalar<uint32_t>(); }
+	uint64_t ReadUInt64() { return ReadScalar<uint64_t>(); }
 	float ReadSingle();
 	double ReadDouble();
 	Vec3f ReadVec3f();
@@ -41,4 +47,31 @@ public:
 
 protected:
 	std::shared_ptr<Stream> stream;
-};
\ No newline at end of file
+	const char* span = nullptr;
+	size_t spanSize = 0;
+	size_t spanPos = 0;
+
+	void CheckSpan(size_t length)
+	{
+		if (spanPos > spanSize || spanSize - spanPos < length)
+			throw std::runtime_error("BinaryReader: Read past the end of the buffer");
+	}
+
+	// Resources are stored little endian, same as every platform we run on, so values are copied as is.
+	template <typename T>
+	T ReadScalar()
+	{
+		T result;
+
+		if (span != nullptr)
+		{
+			CheckSpan(sizeof(T));
+			memcpy(&result, span + spanPos, sizeof(T));
+			spanPos += sizeof(T);
+		}
+		else
+			stream->Read((char*)&result, sizeof(T));
+
+		return result;
+	}
+};
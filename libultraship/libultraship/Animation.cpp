@@ -14,9 +14,8 @@ void Ship::AnimationV0::ParseFileBinary(BinaryReader* reader, Resource* res)
 		anim->frameCount = reader->ReadInt16();
 
 		uint32_t rotValuesCnt = reader->ReadUInt32();
-		anim->rotationValues.reserve(rotValuesCnt);
-		for (uint32_t i = 0; i < rotValuesCnt; i++)
-			anim->rotationValues.push_back(reader->ReadUInt16());
+		anim->rotationValues.resize(rotValuesCnt);
+		reader->ReadBytes((char*)anim->rotationValues.data(), rotValuesCnt * sizeof(uint16_t));
 
 
 		uint32_t rotIndCnt = reader->ReadUInt32();
@@ -35,9 +34,8 @@ void Ship::AnimationV0::ParseFileBinary(BinaryReader* reader, Resource* res)
 		anim->frameCount = reader->ReadInt16();
 
 		uint32_t refArrCnt = reader->ReadUInt32();
-		anim->refIndexArr.reserve(refArrCnt);
-		for (uint32_t i = 0; i < refArrCnt; i++)
-			anim->refIndexArr.push_back(reader->ReadUByte());
+		anim->refIndexArr.resize(refArrCnt);
+		reader->ReadBytes((char*)anim->refIndexArr.data(), refArrCnt);
 
 		uint32_t transformDataCnt = reader->ReadUInt32();
 		anim->transformDataArr.reserve(transformDataCnt);
@@ -54,11 +52,8 @@ void Ship::AnimationV0::ParseFileBinary(BinaryReader* reader, Resource* res)
 		}
 
 		uint32_t copyValuesCnt = reader->ReadUInt32();
-		anim->copyValuesArr.reserve(copyValuesCnt);
-		for (uint32_t i = 0; i < copyValuesCnt; i++)
-		{
-			anim->copyValuesArr.push_back(reader->ReadInt16());
-		}
+		anim->copyValuesArr.resize(copyValuesCnt);
+		reader->ReadBytes((char*)anim->copyValuesArr.data(), copyValuesCnt * sizeof(int16_t));
 	}
 	else if (animType == AnimationType::Link)
 	{
@@ -70,3 +65,10 @@ void Ship::AnimationV0::ParseFileBinary(BinaryReader* reader, Resource* res)
 		SPDLOG_DEBUG("BEYTAH ANIMATION?!");
 	}
 }
+
+size_t Ship::Animation::GetMemorySize()
+{
+	return sizeof(Animation) + rotationValues.capacity() * sizeof(uint16_t) +
+	       rotationIndices.capacity() * sizeof(RotationIndex) + refIndexArr.capacity() +
+	       transformDataArr.capacity() * sizeof(TransformData) + copyValuesArr.capacity() * sizeof(int16_t);
+}
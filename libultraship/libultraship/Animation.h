@@ -59,5 +59,7 @@ namespace Ship
 		// LINK
 		uint32_t segPtr; // This is temp
 
+		size_t GetMemorySize() override;
+
 	};
 }
\ No newline at end of file
@@ -5,14 +5,30 @@
 #include "Utils/StringHelper.h"
 #include "Lib/StrHash64.h"
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace Ship {
+	// Layout of the CRC index: a uint32 entry count, then the entries sorted by hash, each a uint64 hash followed by the uint32 offset of its
+	// null terminated name in the string table that closes the file. Everything is little endian, like the resources themselves.
+	static const char* CRCIndexPath = "(crc64 index)";
+	static constexpr size_t CRCIndexEntrySize = sizeof(uint64_t) + sizeof(uint32_t);
+
 	Archive::Archive(const std::string& MainPath, bool enableWriting) : Archive(MainPath, "", enableWriting) 
 	{
 		mainMPQ = nullptr;
 	}
 
-	Archive::Archive(const std::string& MainPath, const std::string& PatchesPath, bool enableWriting, bool genCRCMap) : MainPath(MainPath), PatchesPath(PatchesPath) {
+	Archive::Archive(const std::string& MainPath, const std::string& PatchesPath, bool enableWriting, bool genCRCMap) : MainPath(MainPath), PatchesPath(PatchesPath), crcIndexCount(0), crcIndexNames(nullptr), crcIndexNamesSize(0), mainMappingSize(0), mainHeaderOffset(0), maxReaders(1) {
 		mainMPQ = nullptr;
 		Load(enableWriting, genCRCMap);
 	}
@@ -26,6 +42,70 @@ namespace Ship {
 		return mainMPQ != nullptr;
 	}
 
+	void Archive::SetReaderCount(size_t Count)
+	{
+		const std::lock_guard<std::mutex> Lock(readerMutex);
+		maxReaders = Count > 0 ? Count : 1;
+	}
+
+	HANDLE Archive::AcquireReader()
+	{
+		std::unique_lock<std::mutex> Lock(readerMutex);
+
+		if (mainMPQ == nullptr) {
+			return nullptr;
+		}
+
+		while (idleReaders.empty()) {
+			// Extra readers are opened lazily, the first one is always the main mpq handle.
+			if (readers.size() + 1 < maxReaders) {
+				HANDLE reader = OpenReader();
+
+				if (reader != nullptr) {
+					readers.push_back(reader);
+					return reader;
+				}
+
+				// Could not open another handle, stop trying and share the ones we have.
+				maxReaders = readers.size() + 1;
+			}
+
+			readerNotifier.wait(Lock);
+		}
+
+		HANDLE reader = idleReaders.back();
+		idleReaders.pop_back();
+
+		return reader;
+	}
+
+	void Archive::ReleaseReader(HANDLE reader)
+	{
+		if (reader == nullptr) {
+			return;
+		}
+
+		{
+			const std::lock_guard<std::mutex> Lock(readerMutex);
+			idleReaders.push_back(reader);
+		}
+
+		readerNotifier.notify_one();
+	}
+
+	HANDLE Archive::OpenReader()
+	{
+		HANDLE readerHandle = NULL;
+		std::wstring wFileName = std::filesystem::absolute(MainPath).wstring();
+
+		if (!SFileOpenArchive(wFileName.c_str(), 0, MPQ_OPEN_READ_ONLY, &readerHandle)) {
+			SPDLOG_ERROR("({}) Failed to open reader for main mpq file {}.", GetLastError(), MainPath.c_str());
+			return nullptr;
+		}
+
+		return readerHandle;
+	}
+
 	std::shared_ptr<Archive> Archive::CreateArchive(const std::string& archivePath, int fileCapacity)
 	{
 		Archive* archive = new Archive(archivePath, true);
@@ -39,7 +119,8 @@ namespace Ship {
 
 		if (success) {
 			archive->mpqHandles[archivePath] = archive->mainMPQ;
-			return std::make_shared<Archive>(*archive);
+			archive->idleReaders.push_back(archive->mainMPQ);
+			return std::shared_ptr<Archive>(archive);
 		} else {
 			SPDLOG_ERROR("({}) We tried to create an archive, but it has fallen and cannot get up.");
 			return nullptr;
@@ -47,33 +128,47 @@ namespace Ship {
 	}
 
 	std::shared_ptr<File> Archive::LoadFile(const std::string& filePath, bool includeParent, std::shared_ptr<File> FileToLoad) {
+		// A file some patch archive provides is read from that archive alone, the main one is never touched.
+		if (FindPatch(filePath) != nullptr) {
+			return LoadPatchFile(filePath, includeParent, FileToLoad);
+		}
+
 		HANDLE fileHandle = NULL;
+		HANDLE readerHandle = AcquireReader();
 
-		if (!SFileOpenFileEx(mainMPQ, filePath.c_str(), 0, &fileHandle)) {
+		if (!SFileOpenFileEx(readerHandle, filePath.c_str(), 0, &fileHandle)) {
 			SPDLOG_ERROR("({}) Failed to open file {} from mpq archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
+			ReleaseReader(readerHandle);
 			std::unique_lock<std::mutex> Lock(FileToLoad->FileLoadMutex);
 			FileToLoad->bHasLoadError = true;
 			return nullptr;
 		}
 
 		DWORD dwFileSize = SFileGetFileSize(fileHandle, 0);
-		std::shared_ptr<char[]> fileData(new char[dwFileSize]);
-		DWORD dwBytes;
+		std::shared_ptr<char[]> fileData = GetMappedFileView(fileHandle, dwFileSize);
 
-		if (!SFileReadFile(fileHandle, fileData.get(), dwFileSize, &dwBytes, NULL)) {
-			SPDLOG_ERROR("({}) Failed to read file {} from mpq archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
-			if (!SFileCloseFile(fileHandle)) {
-				SPDLOG_ERROR("({}) Failed to close file {} from mpq after read failure in archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
+		if (fileData == nullptr) {
+			fileData = std::shared_ptr<char[]>(new char[dwFileSize]);
+			DWORD dwBytes;
+
+			if (!SFileReadFile(fileHandle, fileData.get(), dwFileSize, &dwBytes, NULL)) {
+				SPDLOG_ERROR("({}) Failed to read file {} from mpq archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
+				if (!SFileCloseFile(fileHandle)) {
+					SPDLOG_ERROR("({}) Failed to close file {} from mpq after read failure in archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
+				}
+				ReleaseReader(readerHandle);
+				std::unique_lock<std::mutex> Lock(FileToLoad->FileLoadMutex);
+				FileToLoad->bHasLoadError = true;
+				return nullptr;
 			}
-			std::unique_lock<std::mutex> Lock(FileToLoad->FileLoadMutex);
-			FileToLoad->bHasLoadError = true;
-			return nullptr;
 		}
 
 		if (!SFileCloseFile(fileHandle)) {
 			SPDLOG_ERROR("({}) Failed to close file {} from mpq archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
 		}
 
+		ReleaseReader(readerHandle);
+
 		if (FileToLoad == nullptr) {
 			FileToLoad = std::make_shared<File>();
 			FileToLoad->path = filePath;
@@ -89,30 +184,37 @@ namespace Ship {
 	}
 
 	std::shared_ptr<File> Archive::LoadPatchFile(const std::string& filePath, bool includeParent, std::shared_ptr<File> FileToLoad) {
-		HANDLE fileHandle = NULL;
-		HANDLE mpqHandle = NULL;
-
-		for(auto [path, handle] : mpqHandles) {
-			if (SFileOpenFileEx(mpqHandle, filePath.c_str(), 0, &fileHandle)) {
-				std::unique_lock Lock(FileToLoad->FileLoadMutex);
-				FileToLoad->bHasLoadError = false;
-				mpqHandle = handle;
-			}
+		if (FileToLoad == nullptr) {
+			FileToLoad = std::make_shared<File>();
+			FileToLoad->path = filePath;
 		}
 
-		if(!mpqHandle) {
+		std::shared_ptr<PatchArchive> patch = FindPatch(filePath);
+
+		if (patch == nullptr) {
+			std::unique_lock<std::mutex> Lock(FileToLoad->FileLoadMutex);
 			FileToLoad->bHasLoadError = true;
 			return FileToLoad;
 		}
 
+		const std::lock_guard<std::mutex> ReadLock(patch->ReadMutex);
+		HANDLE fileHandle = NULL;
+
+		if (!SFileOpenFileEx(patch->Handle, filePath.c_str(), 0, &fileHandle)) {
+			SPDLOG_ERROR("({}) Failed to open file {} from patch mpq {}", GetLastError(), filePath.c_str(), patch->Path.c_str());
+			std::unique_lock<std::mutex> Lock(FileToLoad->FileLoadMutex);
+			FileToLoad->bHasLoadError = true;
+			return nullptr;
+		}
+
 		DWORD dwFileSize = SFileGetFileSize(fileHandle, 0);
 		std::shared_ptr<char[]> fileData(new char[dwFileSize]);
 		DWORD dwBytes;
 
 		if (!SFileReadFile(fileHandle, fileData.get(), dwFileSize, &dwBytes, NULL)) {
-			SPDLOG_ERROR("({}) Failed to read file {} from mpq archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
+			SPDLOG_ERROR("({}) Failed to read file {} from patch mpq {}", GetLastError(), filePath.c_str(), patch->Path.c_str());
 			if (!SFileCloseFile(fileHandle)) {
-				SPDLOG_ERROR("({}) Failed to close file {} from mpq after read failure in archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
+				SPDLOG_ERROR("({}) Failed to close file {} from patch mpq after read failure in {}", GetLastError(), filePath.c_str(), patch->Path.c_str());
 			}
 			std::unique_lock<std::mutex> Lock(FileToLoad->FileLoadMutex);
 			FileToLoad->bHasLoadError = true;
@@ -120,24 +222,20 @@ namespace Ship {
 		}
 
 		if (!SFileCloseFile(fileHandle)) {
-			SPDLOG_ERROR("({}) Failed to close file {} from mpq archive {}", GetLastError(), filePath.c_str(), MainPath.c_str());
-		}
-
-		if (FileToLoad == nullptr) {
-			FileToLoad = std::make_shared<File>();
-			FileToLoad->path = filePath;
+			SPDLOG_ERROR("({}) Failed to close file {} from patch mpq {}", GetLastError(), filePath.c_str(), patch->Path.c_str());
 		}
 
 		std::unique_lock<std::mutex> Lock(FileToLoad->FileLoadMutex);
 		FileToLoad->parent = includeParent ? shared_from_this() : nullptr;
 		FileToLoad->buffer = fileData;
 		FileToLoad->dwBufferSize = dwFileSize;
+		FileToLoad->bHasLoadError = false;
 		FileToLoad->bIsLoaded = true;
 
 		return FileToLoad;
 	}
 
-	bool Archive::AddFile(const std::string& path, uintptr_t fileData, DWORD dwFileSize) {
+	bool Archive::AddFile(const std::string& path, uintptr_t fileData, DWORD dwFileSize, bool compress) {
 		HANDLE hFile;
 
 		SYSTEMTIME sysTime;
@@ -146,12 +244,12 @@ namespace Ship {
 		SystemTimeToFileTime(&sysTime, &t);
 		ULONGLONG stupidHack = static_cast<uint64_t>(t.dwHighDateTime) << (sizeof(t.dwHighDateTime) * 8) | t.dwLowDateTime;
 
-		if (!SFileCreateFile(mainMPQ, path.c_str(), stupidHack, dwFileSize, 0, MPQ_FILE_COMPRESS, &hFile)) {
+		if (!SFileCreateFile(mainMPQ, path.c_str(), stupidHack, dwFileSize, 0, compress ? MPQ_FILE_COMPRESS : 0, &hFile)) {
 			SPDLOG_ERROR("({}) Failed to create file of {} bytes {} in archive {}", GetLastError(), dwFileSize, path.c_str(), MainPath.c_str());
 			return false;
 		}
 
-		if (!SFileWriteFile(hFile, (void*)fileData, dwFileSize, MPQ_COMPRESSION_ZLIB)) {
+		if (!SFileWriteFile(hFile, (void*)fileData, dwFileSize, compress ? MPQ_COMPRESSION_ZLIB : 0)) {
 			SPDLOG_ERROR("({}) Failed to write {} bytes to {} in archive {}", GetLastError(), dwFileSize, path.c_str(), MainPath.c_str());
 			if (!SFileCloseFile(hFile)) {
 				SPDLOG_ERROR("({}) Failed to close file {} after write failure in archive {}", GetLastError(), path.c_str(), MainPath.c_str());
@@ -197,12 +295,16 @@ namespace Ship {
 	}
 
 	std::vector<SFILE_FIND_DATA> Archive::ListFiles(const std::string& searchMask) {
+		return ListFiles(mainMPQ, searchMask);
+	}
+
+	std::vector<SFILE_FIND_DATA> Archive::ListFiles(HANDLE mpqHandle, const std::string& searchMask) {
 		auto fileList = std::vector<SFILE_FIND_DATA>();
 		SFILE_FIND_DATA findContext;
 		HANDLE hFind;
 
 		
-		hFind = SFileFindFirstFile(mainMPQ, searchMask.c_str(), &findContext, nullptr);
+		hFind = SFileFindFirstFile(mpqHandle, searchMask.c_str(), &findContext, nullptr);
 		//if (hFind && GetLastError() != ERROR_NO_MORE_FILES) {
 		if (hFind != nullptr) {
 			fileList.push_back(findContext);
@@ -259,8 +361,80 @@ namespace Ship {
 		return result;
 	}
 
-	std::string Archive::HashToString(uint64_t hash) {
-		return hashes[hash];
+	bool Archive::WriteCRCIndex() {
+		std::vector<std::pair<uint64_t, std::string>> entries;
+
+		for (const auto& item : ListFiles("*")) {
+			std::string name = item.cFileName;
+
+			// Skips the index itself along with (listfile), (attributes) and the other internal files.
+			if (name.empty() || name[0] == '(') {
+				continue;
+			}
+
+			entries.emplace_back(CRC64(name.c_str()), name);
+		}
+
+		std::sort(entries.begin(), entries.end());
+
+		std::vector<char> names;
+		std::vector<char> index(sizeof(uint32_t) + (entries.size() * CRCIndexEntrySize));
+		uint32_t count = (uint32_t)entries.size();
+		memcpy(index.data(), &count, sizeof(count));
+
+		for (size_t i = 0; i < entries.size(); i++) {
+			char* entry = index.data() + sizeof(uint32_t) + (i * CRCIndexEntrySize);
+			uint32_t nameOffset = (uint32_t)names.size();
+			memcpy(entry, &entries[i].first, sizeof(uint64_t));
+			memcpy(entry + sizeof(uint64_t), &nameOffset, sizeof(uint32_t));
+			names.insert(names.end(), entries[i].second.c_str(), entries[i].second.c_str() + entries[i].second.size() + 1);
+		}
+
+		index.insert(index.end(), names.begin(), names.end());
+
+		if (SFileHasFile(mainMPQ, CRCIndexPath) && !RemoveFile(CRCIndexPath)) {
+			return false;
+		}
+
+		// Stored raw so read only archives can search it straight out of the mapping.
+		return AddFile(CRCIndexPath, (uintptr_t)index.data(), (DWORD)index.size(), false);
+	}
+
+	const char* Archive::HashToString(uint64_t hash) {
+		if (crcIndexCount > 0) {
+			const char* entries = crcIndex.get() + sizeof(uint32_t);
+			size_t low = 0;
+			size_t high = crcIndexCount;
+
+			// The entries may be unaligned when the index is a view into the archive, so they are read with memcpy.
+			while (low < high) {
+				size_t mid = low + ((high - low) / 2);
+				uint64_t midHash;
+				memcpy(&midHash, entries + (mid * CRCIndexEntrySize), sizeof(uint64_t));
+
+				if (midHash < hash) {
+					low = mid + 1;
+				} else {
+					high = mid;
+				}
+			}
+
+			uint64_t foundHash = 0;
+			if (low < crcIndexCount) {
+				memcpy(&foundHash, entries + (low * CRCIndexEntrySize), sizeof(uint64_t));
+			}
+
+			if (low < crcIndexCount && foundHash == hash) {
+				uint32_t nameOffset;
+				memcpy(&nameOffset, entries + (low * CRCIndexEntrySize) + sizeof(uint64_t), sizeof(uint32_t));
+				return nameOffset < crcIndexNamesSize ? crcIndexNames + nameOffset : "";
+			}
+		}
+
+		// Files added to a writable archive and archives exported without an index are looked up here.
+		// Don't use operator[] here, it would insert on a miss and this gets called from several threads.
+		auto hashFind = hashes.find(hash);
+		return hashFind != hashes.end() ? hashFind->second.c_str() : "";
 	}
 
 	bool Archive::Load(bool enableWriting, bool genCRCMap) {
@@ -277,26 +451,252 @@ namespace Ship {
 			}
 		}
 
+		for (HANDLE reader : readers) {
+			if (!SFileCloseArchive(reader)) {
+				SPDLOG_ERROR("({}) Failed to close reader of mpq {}", GetLastError(), MainPath.c_str());
+				success = false;
+			}
+		}
+
+		{
+			const std::unique_lock<std::shared_mutex> Lock(patchMutex);
+			patchOverlay.clear();
+			patchArchives.clear();
+		}
+
+		readers.clear();
+		idleReaders.clear();
 		mainMPQ = nullptr;
+		mainMapping.reset();
+		mainMappingSize = 0;
+		crcIndex.reset();
+		crcIndexCount = 0;
+		crcIndexNames = nullptr;
+		crcIndexNamesSize = 0;
 
 		return success;
 	}
 
 	bool Archive::LoadPatchMPQs() {
-		// OTRTODO: We also want to periodically scan the patch directories for new MPQs. When new MPQs are found we will load the contents to fileCache and then copy over to gameResourceAddresses
-		if (PatchesPath.length() > 0) {
-			if (std::filesystem::is_directory(PatchesPath)) {
-				for (const auto& p : std::filesystem::recursive_directory_iterator(PatchesPath)) {
-					if (StringHelper::IEquals(p.path().extension().string(), ".otr") || StringHelper::IEquals(p.path().extension().string(), ".mpq")) {
-						SPDLOG_ERROR("Reading {} mpq patch", p.path().string().c_str());
-						if (!LoadPatchMPQ(p.path().string())) {
-							return false;
-						}
+		RefreshPatchMPQs(true);
+		return true;
+	}
+
+	std::vector<std::string> Archive::RefreshPatchMPQs(bool force) {
+		std::map<std::string, std::filesystem::file_time_type> found;
+		std::error_code error;
+
+		// Adding, removing or renaming an archive moves the directory's write time, walking the whole tree is only needed then.
+		const std::filesystem::file_time_type dirWriteTime = std::filesystem::last_write_time(PatchesPath, error);
+		const bool dirFound = PatchesPath.length() > 0 && !error;
+
+		if (!force && patchesScanned && dirFound == patchesDirFound && (!dirFound || dirWriteTime == patchesWriteTime)) {
+			return {};
+		}
+
+		patchesScanned = true;
+		patchesDirFound = dirFound;
+		patchesWriteTime = dirWriteTime;
+
+		if (dirFound && std::filesystem::is_directory(PatchesPath, error)) {
+			const std::string mainFullPath = std::filesystem::absolute(MainPath).string();
+
+			for (const auto& p : std::filesystem::recursive_directory_iterator(PatchesPath, error)) {
+				if (StringHelper::IEquals(p.path().extension().string(), ".otr") || StringHelper::IEquals(p.path().extension().string(), ".mpq")) {
+					std::string fullPath = std::filesystem::absolute(p.path()).string();
+
+					if (fullPath != mainFullPath) {
+						found[fullPath] = p.last_write_time(error);
 					}
 				}
 			}
 		}
 
+		std::vector<std::string> changed;
+		const std::unique_lock<std::shared_mutex> Lock(patchMutex);
+
+		// Archives that were rewritten in place are dropped and loaded again.
+		for (auto it = patchArchives.begin(); it != patchArchives.end();) {
+			auto foundIt = found.find(it->first);
+
+			if (foundIt != found.end() && foundIt->second == it->second->WriteTime) {
+				++it;
+				continue;
+			}
+
+			SPDLOG_INFO("Removing patch mpq {}", it->first.c_str());
+			std::shared_ptr<PatchArchive> removed = it->second;
+			it = patchArchives.erase(it);
+			RemoveFromOverlay(removed, changed);
+		}
+
+		for (const auto& [path, writeTime] : found) {
+			if (patchArchives.contains(path)) {
+				continue;
+			}
+
+			SPDLOG_INFO("Reading {} mpq patch", path.c_str());
+			LoadPatchMPQ(path, writeTime, changed);
+		}
+
+		std::sort(changed.begin(), changed.end());
+		changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+		return changed;
+	}
+
+	std::string Archive::GetLookupKey(const std::string& filePath) {
+		std::string key = filePath;
+
+		for (char& c : key) {
+			c = c == '/' ? '\\' : (char)tolower((unsigned char)c);
+		}
+
+		return key;
+	}
+
+	std::shared_ptr<Archive::PatchArchive> Archive::FindPatch(const std::string& filePath) {
+		const std::string key = GetLookupKey(filePath);
+		const std::shared_lock<std::shared_mutex> Lock(patchMutex);
+
+		auto patchFind = patchOverlay.find(key);
+		return patchFind != patchOverlay.end() ? patchFind->second : nullptr;
+	}
+
+	void Archive::RemoveFromOverlay(const std::shared_ptr<PatchArchive>& patch, std::vector<std::string>& changed) {
+		for (const auto& name : patch->Files) {
+			const std::string key = GetLookupKey(name);
+			auto overlayFind = patchOverlay.find(key);
+
+			if (overlayFind == patchOverlay.end() || overlayFind->second != patch) {
+				continue;
+			}
+
+			changed.push_back(key);
+			patchOverlay.erase(overlayFind);
+
+			// Hand the file to the next archive in line that has it, if any.
+			for (auto it = patchArchives.rbegin(); it != patchArchives.rend(); ++it) {
+				const std::lock_guard<std::mutex> ReadLock(it->second->ReadMutex);
+
+				if (SFileHasFile(it->second->Handle, name.c_str())) {
+					patchOverlay[key] = it->second;
+					break;
+				}
+			}
+		}
+	}
+
+	bool Archive::MapMainMPQ() {
+		if (!SFileGetFileInfo(mainMPQ, SFileMpqHeaderOffset, &mainHeaderOffset, sizeof(mainHeaderOffset), NULL)) {
+			return false;
+		}
+
+		// The mapping is copy on write, since some callers byteswap the buffers they are handed in place.
+#ifdef _WIN32
+		HANDLE file = CreateFileW(std::filesystem::absolute(MainPath).wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = NULL;
+		void* view = NULL;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+			mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		}
+		if (mapping != NULL) {
+			view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+
+		if (view == NULL) {
+			return false;
+		}
+
+		mainMapping = std::shared_ptr<char>((char*)view, [](char* base) { UnmapViewOfFile(base); });
+		mainMappingSize = (size_t)fileSize.QuadPart;
+#else
+		int file = open(std::filesystem::absolute(MainPath).string().c_str(), O_RDONLY);
+		if (file < 0) {
+			return false;
+		}
+
+		struct stat fileStat;
+		void* view = MAP_FAILED;
+		if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0) {
+			view = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		}
+		close(file);
+
+		if (view == MAP_FAILED) {
+			return false;
+		}
+
+		size_t size = fileStat.st_size;
+		mainMapping = std::shared_ptr<char>((char*)view, [size](char* base) { munmap(base, size); });
+		mainMappingSize = size;
+#endif
+
+		return true;
+	}
+
+	std::shared_ptr<char[]> Archive::GetMappedFileView(HANDLE fileHandle, DWORD dwFileSize) {
+		if (mainMapping == nullptr || dwFileSize == 0) {
+			return nullptr;
+		}
+
+		DWORD flags = 0;
+		ULONGLONG byteOffset = 0;
+		DWORD compressedSize = 0;
+		if (!SFileGetFileInfo(fileHandle, SFileInfoFlags, &flags, sizeof(flags), NULL) ||
+			!SFileGetFileInfo(fileHandle, SFileInfoByteOffset, &byteOffset, sizeof(byteOffset), NULL) ||
+			!SFileGetFileInfo(fileHandle, SFileInfoCompressedSize, &compressedSize, sizeof(compressedSize), NULL)) {
+			return nullptr;
+		}
+
+		// Only files that are stored as is can be handed out as views. Files from patch archives never get here.
+		if ((flags & (MPQ_FILE_COMPRESS_MASK | MPQ_FILE_ENCRYPTED | MPQ_FILE_PATCH_FILE | MPQ_FILE_DELETE_MARKER | MPQ_FILE_SECTOR_CRC)) != 0 || compressedSize != dwFileSize) {
+			return nullptr;
+		}
+
+		ULONGLONG fileOffset = mainHeaderOffset + byteOffset;
+		if (fileOffset > mainMappingSize || mainMappingSize - fileOffset < dwFileSize) {
+			return nullptr;
+		}
+
+		return std::shared_ptr<char[]>(mainMapping, mainMapping.get() + fileOffset);
+	}
+
+	bool Archive::LoadCRCIndex() {
+		if (!SFileHasFile(mainMPQ, CRCIndexPath)) {
+			return false;
+		}
+
+		auto indexFile = LoadFile(CRCIndexPath, false);
+
+		if (indexFile == nullptr || indexFile->dwBufferSize < sizeof(uint32_t)) {
+			return false;
+		}
+
+		uint32_t count;
+		memcpy(&count, indexFile->buffer.get(), sizeof(count));
+
+		size_t namesStart = sizeof(uint32_t) + ((size_t)count * CRCIndexEntrySize);
+		size_t namesSize = indexFile->dwBufferSize - std::min<size_t>(namesStart, indexFile->dwBufferSize);
+
+		// Every name has to be terminated inside the file, so a truncated index can't send a lookup past its end.
+		if (namesStart > indexFile->dwBufferSize || (count > 0 && (namesSize == 0 || indexFile->buffer[indexFile->dwBufferSize - 1] != '\0'))) {
+			SPDLOG_ERROR("CRC index in main mpq {} is malformed.", MainPath.c_str());
+			return false;
+		}
+
+		crcIndex = indexFile->buffer;
+		crcIndexCount = count;
+		crcIndexNames = crcIndex.get() + namesStart;
+		crcIndexNamesSize = namesSize;
+
 		return true;
 	}
 
@@ -313,8 +713,14 @@ namespace Ship {
 
 		mpqHandles[fullPath] = mpqHandle;
 		mainMPQ = mpqHandle;
+		idleReaders.push_back(mainMPQ);
+
+		if (!enableWriting && !MapMainMPQ()) {
+			SPDLOG_WARN("Failed to map main mpq file {}, raw files will be copied out of the archive.", fullPath.c_str());
+		}
 
-		if (genCRCMap) {
+		if (genCRCMap && !LoadCRCIndex()) {
+			SPDLOG_INFO("Main mpq {} has no CRC index, hashing its listfile instead.", fullPath.c_str());
 			auto listFile = LoadFile("(listfile)", false);
 
 			std::vector<std::string> lines = StringHelper::Split(std::string(listFile->buffer.get(), listFile->dwBufferSize), "\n");
@@ -331,27 +737,47 @@ namespace Ship {
 		return true;
 	}
 
-	bool Archive::LoadPatchMPQ(const std::string& path) {
+	bool Archive::LoadPatchMPQ(const std::string& path, std::filesystem::file_time_type writeTime, std::vector<std::string>& changed) {
 		HANDLE patchHandle = NULL;
-		std::string fullPath = std::filesystem::absolute(path).string();
-		if (mpqHandles.contains(fullPath)) {
-			return true;
-		}
-
-		std::wstring wPath = std::filesystem::absolute(path).wstring();
+		std::wstring wPath = std::filesystem::path(path).wstring();
 
 		if (!SFileOpenArchive(wPath.c_str(), 0, MPQ_OPEN_READ_ONLY, &patchHandle)) {
 			SPDLOG_ERROR("({}) Failed to open patch mpq file {} while applying to {}.", GetLastError(), path.c_str(), MainPath.c_str());
 			return false;
 		}
 
-		if (!SFileOpenPatchArchive(mainMPQ, wPath.c_str(), "", 0)) {
-			SPDLOG_ERROR("({}) Failed to apply patch mpq file {} to main mpq {}.", GetLastError(), path.c_str(), MainPath.c_str());
-			return false;
+		auto patch = std::make_shared<PatchArchive>();
+		patch->Path = path;
+		patch->Handle = patchHandle;
+		patch->WriteTime = writeTime;
+
+		for (const auto& item : ListFiles(patchHandle, "*")) {
+			std::string name = item.cFileName;
+
+			if (!name.empty() && name[0] != '(') {
+				patch->Files.push_back(name);
+			}
 		}
 
-		mpqHandles[fullPath] = patchHandle;
+		patchArchives[path] = patch;
+
+		// Archives later in path order take precedence, so the same set of mods always resolves the same way.
+		for (const auto& name : patch->Files) {
+			const std::string key = GetLookupKey(name);
+			auto& owner = patchOverlay[key];
+
+			if (owner == nullptr || owner->Path < path) {
+				owner = patch;
+				changed.push_back(key);
+			}
+		}
 
 		return true;
 	}
+
+	Archive::PatchArchive::~PatchArchive() {
+		if (Handle != nullptr && !SFileCloseArchive(Handle)) {
+			SPDLOG_ERROR("({}) Failed to close patch mpq {}", GetLastError(), Path.c_str());
+		}
+	}
 }
\ No newline at end of file
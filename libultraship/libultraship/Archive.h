@@ -6,8 +6,14 @@
 
 #include <stdint.h>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <filesystem>
+#include <condition_variable>
 #include "Resource.h"
 //#include "Lib/StrHash64.h"
 #include "Lib/StormLib/StormLib.h"
@@ -26,30 +32,82 @@ namespace Ship
 
 		bool IsMainMPQValid();
 
+		// Allows up to Count threads to read from the archive at once. StormLib handles are not thread safe, so each extra reader is its own read-only handle.
+		void SetReaderCount(size_t Count);
+
 		static std::shared_ptr<Archive> CreateArchive(const std::string& archivePath, int fileCapacity);
 		
 		std::shared_ptr<File> LoadFile(const std::string& filePath, bool includeParent = true, std::shared_ptr<File> FileToLoad = nullptr);
+		// Only loads the file if a patch archive provides it, LoadFile already prefers patched files over the main archive.
 		std::shared_ptr<File> LoadPatchFile(const std::string& filePath, bool includeParent = true, std::shared_ptr<File> FileToLoad = nullptr);
+		// Picks up patch archives added to, removed from or rewritten in the patches directory. Returns the files that now resolve to a different archive,
+		// as lookup keys. Unless forced, the directory is only scanned again once its write time moved, which misses archives rewritten in place.
+		std::vector<std::string> RefreshPatchMPQs(bool force = false);
+		// Archive lookups ignore case and don't tell / and \ apart, this is the form of a path they come down to.
+		static std::string GetLookupKey(const std::string& filePath);
 
-		bool AddFile(const std::string& path, uintptr_t fileData, DWORD dwFileSize);
+		// Uncompressed files are stored raw, read only archives hand those out as views into a mapping of the archive instead of copies.
+		bool AddFile(const std::string& path, uintptr_t fileData, DWORD dwFileSize, bool compress = true);
 		bool RemoveFile(const std::string& path);
 		bool RenameFile(const std::string& oldPath, const std::string& newPath);
 		std::vector<SFILE_FIND_DATA> ListFiles(const std::string& searchMask);
 		bool HasFile(const std::string& searchMask);
-		std::string HashToString(uint64_t hash);
+		// Writes the sorted CRC64 name index read by HashToString. Call it once every file has been added to the archive.
+		bool WriteCRCIndex();
+		// Returns an empty string when the hash is unknown.
+		const char* HashToString(uint64_t hash);
 	protected:
 		bool Load(bool enableWriting, bool genCRCMap);
 		bool Unload();
 	private:
+		struct PatchArchive {
+			std::string Path;
+			HANDLE Handle = nullptr;
+			std::filesystem::file_time_type WriteTime;
+			std::vector<std::string> Files;
+			// StormLib handles are not thread safe, reads from the same patch archive take turns.
+			std::mutex ReadMutex;
+
+			~PatchArchive();
+		};
+
 		std::string MainPath;
 		std::string PatchesPath;
 		std::map<std::string, HANDLE> mpqHandles;
 		std::vector<std::string> addedFiles;
 		std::map<uint64_t, std::string> hashes;
+		std::map<std::string, std::shared_ptr<PatchArchive>> patchArchives;
+		// Every file provided by a patch archive, by lookup key, mapped to the one archive it is read from.
+		std::unordered_map<std::string, std::shared_ptr<PatchArchive>> patchOverlay;
+		std::shared_mutex patchMutex;
+		bool patchesScanned = false;
+		bool patchesDirFound = false;
+		std::filesystem::file_time_type patchesWriteTime;
+		std::shared_ptr<char[]> crcIndex;
+		size_t crcIndexCount;
+		const char* crcIndexNames;
+		size_t crcIndexNamesSize;
 		HANDLE mainMPQ;
+		std::shared_ptr<char> mainMapping;
+		size_t mainMappingSize;
+		ULONGLONG mainHeaderOffset;
+		std::vector<HANDLE> readers;
+		std::vector<HANDLE> idleReaders;
+		size_t maxReaders;
+		std::mutex readerMutex;
+		std::condition_variable readerNotifier;
 
+		HANDLE AcquireReader();
+		void ReleaseReader(HANDLE reader);
+		HANDLE OpenReader();
+		bool MapMainMPQ();
+		std::shared_ptr<char[]> GetMappedFileView(HANDLE fileHandle, DWORD dwFileSize);
+		bool LoadCRCIndex();
 		bool LoadMainMPQ(bool enableWriting, bool genCRCMap);
 		bool LoadPatchMPQs();
-		bool LoadPatchMPQ(const std::string& path);
+		bool LoadPatchMPQ(const std::string& path, std::filesystem::file_time_type writeTime, std::vector<std::string>& changed);
+		std::shared_ptr<PatchArchive> FindPatch(const std::string& filePath);
+		void RemoveFromOverlay(const std::shared_ptr<PatchArchive>& patch, std::vector<std::string>& changed);
+		std::vector<SFILE_FIND_DATA> ListFiles(HANDLE mpqHandle, const std::string& searchMask);
 	};
 }
\ No newline at end of file
@@ -81,5 +81,7 @@ namespace Ship
 		std::vector<ScalarData> scalars;
 		std::vector<Vtx> vertices;
 
+		size_t GetMemorySize() override;
+
 	};
 }
\ No newline at end of file
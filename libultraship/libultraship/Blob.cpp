@@ -15,4 +15,9 @@ namespace Ship
         for (uint32_t i = 0; i < dataSize; i++)
             blob->data.push_back(reader->ReadUByte());
     }
+
+    size_t Blob::GetMemorySize()
+    {
+        return sizeof(Blob) + data.capacity();
+    }
 }
\ No newline at end of file
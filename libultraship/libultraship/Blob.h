@@ -15,5 +15,7 @@ namespace Ship
 	{
 	public:
 		std::vector<uint8_t> data;
+
+		size_t GetMemorySize() override;
 	};
 };
\ No newline at end of file
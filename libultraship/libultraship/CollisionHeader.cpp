@@ -96,4 +96,18 @@ Ship::PolygonEntry::PolygonEntry(BinaryReader* reader)
 
 Ship::WaterBoxHeader::WaterBoxHeader()
 {
-}
\ No newline at end of file
+}
+
+size_t Ship::CollisionHeader::GetMemorySize()
+{
+	size_t size = sizeof(CollisionHeader) + vertices.capacity() * sizeof(Vec3f) + polygons.capacity() * sizeof(PolygonEntry) +
+	              polygonTypes.capacity() * sizeof(uint64_t) + waterBoxes.capacity() * sizeof(WaterBoxHeader);
+
+	if (camData != nullptr)
+	{
+		size += sizeof(CameraDataList) + camData->entries.size() * (sizeof(CameraDataEntry*) + sizeof(CameraDataEntry)) +
+		        camData->cameraPositionData.size() * (sizeof(CameraPositionData*) + sizeof(CameraPositionData));
+	}
+
+	return size;
+}
@@ -81,5 +81,7 @@ namespace Ship
 		std::vector<uint64_t> polygonTypes;
 		std::vector<WaterBoxHeader> waterBoxes;
 		CameraDataList* camData = nullptr;
+
+		size_t GetMemorySize() override;
     };
 }
\ No newline at end of file
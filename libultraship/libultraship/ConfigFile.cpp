@@ -57,6 +57,8 @@ namespace Ship {
 	bool ConfigFile::CreateDefaultConfig() {
 		(*this)["ARCHIVE"]["Main Archive"] = "oot.otr";
 		(*this)["ARCHIVE"]["Patches Directory"] = "";
+		(*this)["ARCHIVE"]["Load Threads"] = std::to_string(0);
+		(*this)["ARCHIVE"]["Cache Budget MB"] = std::to_string(0);
 
 		(*this)["CONTROLLERS"]["CONTROLLER 1"] = "Auto";
 		(*this)["CONTROLLERS"]["CONTROLLER 2"] = "Unplugged";
@@ -72,6 +74,12 @@ namespace Ship {
 		(*this)["WINDOW"]["FULLSCREEN HEIGHT"] = std::to_string(1080);
 		(*this)["WINDOW"]["FULLSCREEN"] = std::to_string(false);
 		(*this)["WINDOW"]["GFX BACKEND"] = "sdl";
+		(*this)["WINDOW"]["TEXTURE CACHE MB"] = std::to_string(256);
+		(*this)["WINDOW"]["TEXTURE DEDUP"] = std::to_string(true);
+		(*this)["WINDOW"]["RENDER PIPELINE"] = std::to_string(false);
+		(*this)["WINDOW"]["AUDIO FRAMES AHEAD"] = std::to_string(2);
+		(*this)["WINDOW"]["GFX REPLAY"] = "";
+		(*this)["WINDOW"]["GFX REPLAY FRAMES"] = std::to_string(600);
 
 		(*this)["KEYBOARD CONTROLLER BINDING 1"][STR(BTN_CRIGHT)] = std::to_string(0x14D);
 		(*this)["KEYBOARD CONTROLLER BINDING 1"][STR(BTN_CLEFT)] = std::to_string(0x14B);
@@ -19,3 +19,8 @@ void Ship::CutsceneV0::ParseFileBinary(BinaryReader* reader, Resource* res)
 
 	//int bp = 0;
 }
+
+size_t Ship::Cutscene::GetMemorySize()
+{
+	return sizeof(Cutscene) + commands.capacity() * sizeof(uint32_t);
+}
@@ -24,5 +24,7 @@ namespace Ship
 	public:
 		//int32_t endFrame;
 		std::vector<uint32_t> commands;
+
+		size_t GetMemorySize() override;
 	};
 }
\ No newline at end of file
@@ -1,13 +1,31 @@
 #include "cvar.h"
 #include <map>
+#include <shared_mutex>
 #include <string>
 #include <PR/ultra64/gbi.h>
 
 std::map<std::string, CVar*> cvars;
+// The game may add CVars from its own thread while the menus read them, so the map is guarded. The values are not.
+static std::shared_mutex cvarsMutex;
 
 CVar* CVar_GetVar(const char* name) {
-    std::string key(name);
-    return cvars.contains(key) ? cvars[key] : nullptr;
+    std::shared_lock<std::shared_mutex> lock(cvarsMutex);
+    auto it = cvars.find(name);
+    return it != cvars.end() ? it->second : nullptr;
+}
+
+static CVar* CVar_GetOrCreate(const char* name) {
+    CVar* cvar = CVar_Get(name);
+    if (cvar != nullptr) {
+        return cvar;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(cvarsMutex);
+    CVar*& slot = cvars[std::string(name)];
+    if (slot == nullptr) {
+        slot = new CVar;
+    }
+    return slot;
 }
 
 extern "C" CVar* CVar_Get(const char* name) {
@@ -48,31 +66,19 @@ extern "C" char* CVar_GetString(const char* name, char* defaultValue) {
 }
 
 extern "C" void CVar_SetS32(const char* name, s32 value) {
-    CVar* cvar = CVar_Get(name);
-    if (!cvar) {
-        cvar = new CVar;
-        cvars[std::string(name)] = cvar;
-    }
+    CVar* cvar = CVar_GetOrCreate(name);
     cvar->type = CVAR_TYPE_S32;
     cvar->value.valueS32 = value;
 }
 
 void CVar_SetFloat(const char* name, float value) {
-    CVar* cvar = CVar_Get(name);
-    if (!cvar) {
-        cvar = new CVar;
-        cvars[std::string(name)] = cvar;
-    }
+    CVar* cvar = CVar_GetOrCreate(name);
     cvar->type = CVAR_TYPE_FLOAT;
     cvar->value.valueFloat = value;
 }
 
 void CVar_SetString(const char* name, char* value) {
-    CVar* cvar = CVar_Get(name);
-    if (!cvar) {
-        cvar = new CVar;
-        cvars[std::string(name)] = cvar;
-    }
+    CVar* cvar = CVar_GetOrCreate(name);
     cvar->type = CVAR_TYPE_STRING;
     cvar->value.valueStr = value;
 }
@@ -12,6 +12,9 @@ namespace Ship
 		while (reader->GetBaseAddress() % 8 != 0)
 			reader->ReadByte();
 
+		// The rest of the file is the display list, so this is exact up to trailing padding.
+		dl->instructions.reserve((reader->GetLength() - reader->GetBaseAddress()) / sizeof(uint64_t));
+
 		while (true)
 		{
 			uint64_t data = reader->ReadUInt64();
@@ -28,4 +31,9 @@ namespace Ship
 				break;
 		}
 	}
+
+	size_t DisplayList::GetMemorySize()
+	{
+		return sizeof(DisplayList) + instructions.capacity() * sizeof(uint64_t);
+	}
 }
\ No newline at end of file
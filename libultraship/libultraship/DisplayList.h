@@ -19,5 +19,7 @@ namespace Ship
     {
     public:
 		std::vector<uint64_t> instructions;
+
+		size_t GetMemorySize() override;
     };
 }
\ No newline at end of file
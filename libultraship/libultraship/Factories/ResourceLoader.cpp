@@ -15,14 +15,14 @@
 #include "TextureFactory.h"
 #include "BlobFactory.h"
 #include "MtxFactory.h"
-#include <Utils/MemoryStream.h>
+#include <Utils/BinaryReader.h>
 
 namespace Ship
 {
     Resource* ResourceLoader::LoadResource(std::shared_ptr<File> FileToLoad)
     {
-        auto memStream = std::make_shared<MemoryStream>(FileToLoad->buffer.get(), FileToLoad->dwBufferSize);
-        auto reader = std::make_shared<BinaryReader>(memStream);
+        // Reads the File's buffer in place, it stays alive until the Resource is parsed.
+        auto reader = std::make_shared<BinaryReader>(FileToLoad->buffer.get(), FileToLoad->dwBufferSize);
 
         Endianess endianess = (Endianess)reader->ReadByte();
 
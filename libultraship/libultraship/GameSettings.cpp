@@ -48,6 +48,15 @@ namespace Game {
 
     	Settings.debug.n64mode = stob(Conf[ConfSection]["n64_mode"]);
 
+        Settings.debug.incremental_dynapoly = stob(Conf[ConfSection]["incremental_dynapoly"], true);
+        CVar_SetS32("gIncrementalDynaPoly", Settings.debug.incremental_dynapoly);
+
+        Settings.debug.flat_static_collision = stob(Conf[ConfSection]["flat_static_collision"], true);
+        CVar_SetS32("gFlatStaticCollision", Settings.debug.flat_static_collision);
+
+        Settings.debug.collision_broad_phase = stob(Conf[ConfSection]["collision_broad_phase"], true);
+        CVar_SetS32("gCollisionBroadPhase", Settings.debug.collision_broad_phase);
+
         // Enhancements
         Settings.enhancements.skip_text = stob(Conf[EnhancementSection]["skip_text"]);
         CVar_SetS32("gSkipText", Settings.enhancements.skip_text);
@@ -166,6 +175,9 @@ namespace Game {
         Conf[ConfSection]["menu_bar"] = std::to_string(Settings.debug.menu_bar);
         Conf[ConfSection]["soh_debug"] = std::to_string(Settings.debug.soh);
         Conf[ConfSection]["n64_mode"] = std::to_string(Settings.debug.n64mode);
+        Conf[ConfSection]["incremental_dynapoly"] = std::to_string(Settings.debug.incremental_dynapoly);
+        Conf[ConfSection]["flat_static_collision"] = std::to_string(Settings.debug.flat_static_collision);
+        Conf[ConfSection]["collision_broad_phase"] = std::to_string(Settings.debug.collision_broad_phase);
 
         // Audio
         Conf[AudioSection]["master"] = std::to_string(Settings.audio.master);
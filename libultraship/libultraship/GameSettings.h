@@ -7,6 +7,9 @@ struct SoHConfigType {
         bool n64mode = false;
         bool menu_bar = false;
         bool soh_sink = true;
+        bool incremental_dynapoly = true;
+        bool flat_static_collision = true;
+        bool collision_broad_phase = true;
     } debug;
 
     // Audio
@@ -8,6 +8,7 @@
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/sinks/sohconsole_sink.h"
 #include "ModManager.h"
+#include "stox.h"
 
 namespace Ship {
     std::weak_ptr<GlobalCtx2> GlobalCtx2::Context;
@@ -49,7 +50,9 @@ namespace Ship {
         if (PatchesPath.empty()) {
             PatchesPath = "./";
         }
-        ResMan = std::make_shared<ResourceMgr>(GlobalCtx2::GetInstance(), MainPath, PatchesPath);
+        const uint32_t LoadThreadCount = std::max(Ship::stoi((*Config)["ARCHIVE"]["Load Threads"]), 0);
+        ResMan = std::make_shared<ResourceMgr>(GlobalCtx2::GetInstance(), MainPath, PatchesPath, LoadThreadCount);
+        ResMan->SetCacheBudget((size_t)std::max(Ship::stoi((*Config)["ARCHIVE"]["Cache Budget MB"]), 0) * 1024 * 1024);
         Win = std::make_shared<Window>(GlobalCtx2::GetInstance());
 
         if (!ResMan->DidLoadSuccessfully())
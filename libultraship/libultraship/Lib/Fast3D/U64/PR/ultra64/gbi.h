@@ -170,6 +170,12 @@
 #define G_TEXRECT_WIDE          0x37
 #define G_FILLWIDERECT          0x38
 
+// Never exported, the renderer rewrites the OTR commands above to these once their hash is resolved.
+// The first word keeps its operands, the resolved address is in the second word.
+#define G_DL_OTR_RESOLVED       0x39
+#define G_MTX_OTR_RESOLVED      0x3A
+#define G_BRANCH_Z_OTR_RESOLVED 0x3B
+
 /*
  * The following commands are the "generated" RDP commands; the user
  * never sees them, the RSP microcode generates them.
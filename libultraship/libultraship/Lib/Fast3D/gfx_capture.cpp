@@ -0,0 +1,279 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx_capture.h"
+#include <PR/ultra64/gs2dex.h>
+
+#include "gfx_pc.h"
+
+#define GFX_CAPTURE_MAGIC 0x43584647 // "GFXC"
+#define GFX_CAPTURE_VERSION 1
+
+// File layout, all uint32_t in the byte order of the machine: magic, version, command count, relocation count, blob count,
+// the commands as w0 w1 pairs, the indices of the commands whose w1 is a blob index, then every blob as size and bytes.
+static struct {
+    std::mutex mutex;
+    std::string pending_path;
+    std::string path;
+    std::vector<uint32_t> words;
+    std::vector<uint32_t> relocs;
+    std::vector<std::vector<uint8_t>> blobs;
+    std::unordered_map<const void*, uint32_t> texture_blobs;
+    const uint8_t* texture_addr;
+    uint32_t texture_blob;
+} capture;
+
+bool gfx_capture_active;
+
+void gfx_capture_next_frame(const std::string& path) {
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    capture.pending_path = path;
+}
+
+void gfx_capture_begin_frame(void) {
+    {
+        std::lock_guard<std::mutex> lock(capture.mutex);
+        if (capture.pending_path.empty()) {
+            return;
+        }
+        capture.path.swap(capture.pending_path);
+        capture.pending_path.clear();
+    }
+
+    capture.words.clear();
+    capture.relocs.clear();
+    capture.blobs.clear();
+    capture.texture_blobs.clear();
+    capture.texture_addr = nullptr;
+    gfx_capture_active = true;
+}
+
+static void gfx_capture_emit(uint32_t w0, uint32_t w1) {
+    capture.words.push_back(w0);
+    capture.words.push_back(w1);
+}
+
+static uint32_t gfx_capture_blob(const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    capture.blobs.emplace_back(bytes, bytes + size);
+    return (uint32_t)capture.blobs.size() - 1;
+}
+
+// The command gets the blob index as its w1, the replay swaps in the address of its copy of the blob.
+static void gfx_capture_emit_blob(uint32_t w0, uint32_t blob) {
+    capture.relocs.push_back((uint32_t)capture.words.size() / 2);
+    gfx_capture_emit(w0, blob);
+}
+
+void gfx_capture_end_frame(void) {
+    if (!gfx_capture_active) {
+        return;
+    }
+
+    gfx_capture_active = false;
+    gfx_capture_emit((uint32_t)(uint8_t)G_ENDDL << 24, 0);
+
+    FILE* file = fopen(capture.path.c_str(), "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not write the frame capture to %s\n", capture.path.c_str());
+        return;
+    }
+
+    uint32_t header[] = { GFX_CAPTURE_MAGIC, GFX_CAPTURE_VERSION, (uint32_t)capture.words.size() / 2, (uint32_t)capture.relocs.size(),
+                          (uint32_t)capture.blobs.size() };
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(capture.words.data(), sizeof(uint32_t), capture.words.size(), file);
+    fwrite(capture.relocs.data(), sizeof(uint32_t), capture.relocs.size(), file);
+
+    for (const auto& blob : capture.blobs) {
+        uint32_t size = (uint32_t)blob.size();
+        fwrite(&size, sizeof(size), 1, file);
+        fwrite(blob.data(), 1, size, file);
+    }
+
+    fclose(file);
+}
+
+// Commands that read memory are written by the hooks below, control flow is already flattened and segments are resolved,
+// so neither is kept. Framebuffer switches are dropped too as the framebuffers don't exist in the replay.
+void gfx_capture_command(const Gfx* first, const Gfx* last) {
+    switch ((uint8_t)(first->words.w0 >> 24)) {
+        case G_NOOP:
+        case G_MARKER:
+        case G_INVALTEXCACHE:
+        case (uint8_t)G_DL:
+        case G_DL_OTR:
+        case G_DL_OTR_RESOLVED:
+        case G_BRANCH_Z_OTR:
+        case G_BRANCH_Z_OTR_RESOLVED:
+        case (uint8_t)G_ENDDL:
+        case (uint8_t)G_MTX:
+        case G_MTX_OTR:
+        case G_MTX_OTR_RESOLVED:
+        case (uint8_t)G_MOVEMEM:
+        case (uint8_t)G_VTX:
+        case G_VTX_OTR:
+        case (uint8_t)G_SETTIMG:
+        case G_SETTIMG_OTR:
+        case G_SETFB:
+        case G_RESETFB:
+        case G_SETTIMG_FB:
+            return;
+        case G_BG_COPY: {
+            // The copy went through the texture image hook, whose blob now holds every texel it read. The replay points
+            // imagePtr back at that blob, until then it holds the blob index.
+            uObjBg bg = *(const uObjBg*)first->words.w1;
+            if (capture.texture_addr != (const uint8_t*)bg.b.imagePtr) {
+                return;
+            }
+            bg.b.imagePtr = (u64*)(uintptr_t)capture.texture_blob;
+            gfx_capture_emit_blob(first->words.w0, gfx_capture_blob(&bg, sizeof(bg)));
+            return;
+        }
+        case (uint8_t)G_MOVEWORD:
+            if (((first->words.w0 >> 16) & 0xFF) == G_MW_SEGMENT) {
+                return;
+            }
+            break;
+    }
+
+    // Z and color image addresses are only compared with each other, so they are kept as they are.
+    for (const Gfx* cmd = first; cmd <= last; cmd++) {
+        gfx_capture_emit(cmd->words.w0, cmd->words.w1);
+    }
+}
+
+void gfx_capture_vertex(size_t n_vertices, size_t dest_index, const Vtx* vertices) {
+    uint32_t w0 = ((uint32_t)(uint8_t)G_VTX << 24) | ((uint32_t)n_vertices << 12) | ((uint32_t)(dest_index + n_vertices) << 1);
+    gfx_capture_emit_blob(w0, gfx_capture_blob(vertices, n_vertices * sizeof(Vtx)));
+}
+
+void gfx_capture_matrix(uint8_t parameters, const int32_t* addr) {
+    uint32_t w0 = ((uint32_t)(uint8_t)G_MTX << 24) | (uint8_t)(parameters ^ G_MTX_PUSH);
+    gfx_capture_emit_blob(w0, gfx_capture_blob(addr, 16 * sizeof(int32_t)));
+}
+
+void gfx_capture_movemem(uint8_t index, uint8_t offset, const void* data) {
+    uint32_t w0 = ((uint32_t)(uint8_t)G_MOVEMEM << 24) | ((uint32_t)(offset / 8) << 8) | index;
+    gfx_capture_emit_blob(w0, gfx_capture_blob(data, index == G_MV_VIEWPORT ? sizeof(Vp_t) : sizeof(Light_t)));
+}
+
+// Images get a blob when first set and it is grown as loads read further into them.
+// Setting the same address again shares the blob, which keeps the texture cache behaving as it did live.
+void gfx_capture_texture_image(uint32_t format, uint32_t size, uint32_t width, const void* addr) {
+    auto it = capture.texture_blobs.find(addr);
+    if (it == capture.texture_blobs.end()) {
+        it = capture.texture_blobs.emplace(addr, gfx_capture_blob(nullptr, 0)).first;
+    }
+
+    capture.texture_addr = (const uint8_t*)addr;
+    capture.texture_blob = it->second;
+
+    uint32_t w0 = ((uint32_t)G_SETTIMG_OTR << 24) | (format << 21) | (size << 19) | (width & 0x3FF);
+    gfx_capture_emit_blob(w0, it->second);
+    gfx_capture_emit(0, 0);
+}
+
+void gfx_capture_texture_load(size_t size_bytes) {
+    if (capture.texture_addr == nullptr) {
+        return;
+    }
+
+    std::vector<uint8_t>& blob = capture.blobs[capture.texture_blob];
+    if (size_bytes > blob.size()) {
+        blob.insert(blob.end(), capture.texture_addr + blob.size(), capture.texture_addr + size_bytes);
+    }
+}
+
+static bool gfx_replay_read(FILE* file, void* data, size_t size) {
+    return size == 0 || fread(data, size, 1, file) == 1;
+}
+
+bool gfx_replay(const std::string& path, uint32_t frames, struct GfxReplayStats* stats) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    uint32_t header[5];
+    std::vector<uint32_t> words;
+    std::vector<uint32_t> relocs;
+    std::vector<std::vector<uint8_t>> blobs;
+    bool ok = gfx_replay_read(file, header, sizeof(header)) && header[0] == GFX_CAPTURE_MAGIC && header[1] == GFX_CAPTURE_VERSION;
+
+    if (ok) {
+        words.resize((size_t)header[2] * 2);
+        relocs.resize(header[3]);
+        blobs.resize(header[4]);
+        ok = gfx_replay_read(file, words.data(), words.size() * sizeof(uint32_t)) &&
+             gfx_replay_read(file, relocs.data(), relocs.size() * sizeof(uint32_t));
+    }
+
+    for (size_t i = 0; ok && i < blobs.size(); i++) {
+        uint32_t size;
+        ok = gfx_replay_read(file, &size, sizeof(size));
+        if (ok) {
+            // Images that were set but never loaded are empty, they still need an address of their own.
+            blobs[i].resize(std::max<size_t>(size, 1));
+            ok = gfx_replay_read(file, blobs[i].data(), size);
+        }
+    }
+
+    fclose(file);
+
+    if (!ok || words.empty()) {
+        return false;
+    }
+
+    std::vector<Gfx> commands(words.size() / 2);
+    for (size_t i = 0; i < commands.size(); i++) {
+        commands[i].words.w0 = words[i * 2];
+        commands[i].words.w1 = words[i * 2 + 1];
+    }
+
+    for (uint32_t index : relocs) {
+        if (index >= commands.size() || commands[index].words.w1 >= blobs.size()) {
+            return false;
+        }
+        std::vector<uint8_t>& blob = blobs[commands[index].words.w1];
+        commands[index].words.w1 = (uintptr_t)blob.data();
+
+        if ((uint8_t)(commands[index].words.w0 >> 24) == G_BG_COPY) {
+            uObjBg* bg = (uObjBg*)blob.data();
+            if (blob.size() < sizeof(uObjBg) || (uintptr_t)bg->b.imagePtr >= blobs.size()) {
+                return false;
+            }
+            bg->b.imagePtr = (u64*)blobs[(uintptr_t)bg->b.imagePtr].data();
+        }
+    }
+
+    // Addresses of earlier blobs may be reused by these ones, and imports should be counted from cold anyway.
+    gfx_texture_cache_clear();
+    struct GfxTextureCacheStats textures = gfx_texture_cache_get_stats();
+    struct GfxDrawStats draws = gfx_get_draw_stats();
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        gfx_start_frame();
+        gfx_run(commands.data());
+        gfx_end_frame();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // The game's own frames must not find textures at addresses that are about to be freed.
+    gfx_texture_cache_clear();
+
+    stats->frames = frames;
+    stats->commands = (uint32_t)commands.size();
+    stats->flushes = gfx_get_draw_stats().flushes - draws.flushes;
+    stats->triangles = gfx_get_draw_stats().triangles - draws.triangles;
+    stats->texture_imports = gfx_texture_cache_get_stats().misses - textures.misses;
+    stats->ns_per_frame = frames != 0 ? elapsed / frames : 0.0;
+    stats->triangles_per_second = elapsed > 0.0 ? stats->triangles / (elapsed / 1e9) : 0.0;
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef GFX_CAPTURE_H
+#define GFX_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#ifndef _LANGUAGE_C
+#define _LANGUAGE_C
+#endif
+#include <PR/ultra64/gbi.h>
+
+// A capture holds one frame as gfx_pc consumed it: display lists are flattened, OTR resources and segments are
+// resolved, and every vertex, matrix, light, viewport and texture the frame read is copied next to the commands.
+// Replaying it reads nothing from the game or the archives, so it is a fixed workload for timing the interpreter. The replay
+// still starts from Window::MainLoop, after the normal startup has opened the archives, as the window and backend are set up there.
+
+struct GfxReplayStats {
+    uint32_t frames;
+    uint32_t commands;
+    double ns_per_frame;
+    double triangles_per_second;
+    uint64_t flushes;
+    uint64_t triangles;
+    uint64_t texture_imports;
+};
+
+// Writes the next frame gfx_run interprets to path.
+void gfx_capture_next_frame(const std::string& path);
+// Interprets the capture at path frames times through the current backend, starting from an empty texture cache.
+bool gfx_replay(const std::string& path, uint32_t frames, struct GfxReplayStats* stats);
+
+// Called by gfx_pc, the per command hooks only while gfx_capture_active is set.
+extern bool gfx_capture_active;
+void gfx_capture_begin_frame(void);
+void gfx_capture_end_frame(void);
+void gfx_capture_command(const Gfx* first, const Gfx* last);
+void gfx_capture_vertex(size_t n_vertices, size_t dest_index, const Vtx* vertices);
+void gfx_capture_matrix(uint8_t parameters, const int32_t* addr);
+void gfx_capture_movemem(uint8_t index, uint8_t offset, const void* data);
+void gfx_capture_texture_image(uint32_t format, uint32_t size, uint32_t width, const void* addr);
+// A load read the first size_bytes of the current texture image.
+void gfx_capture_texture_load(size_t size_bytes);
+
+#endif
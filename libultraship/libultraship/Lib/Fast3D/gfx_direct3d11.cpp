@@ -280,7 +280,7 @@ static void gfx_d3d11_init(void) {
     ZeroMemory(&vertex_buffer_desc, sizeof(D3D11_BUFFER_DESC));
 
     vertex_buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
-    vertex_buffer_desc.ByteWidth = 256 * 32 * 3 * sizeof(float); // Same as buf_vbo size in gfx_pc
+    vertex_buffer_desc.ByteWidth = GFX_MAX_DRAW_TRIANGLES * 32 * 3 * sizeof(float); // 3 vertices in a triangle and 32 floats per vtx
     vertex_buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
     vertex_buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
     vertex_buffer_desc.MiscFlags = 0;
@@ -1016,7 +1016,9 @@ struct GfxRenderingAPI gfx_direct3d11_api = {
     gfx_d3d11_get_pixel_depth,
     gfx_d3d11_get_framebuffer_texture_id,
     gfx_d3d11_select_texture_fb,
-    gfx_d3d11_delete_texture
+    gfx_d3d11_delete_texture,
+    NULL,
+    NULL
 };
 
 #endif
@@ -0,0 +1,234 @@
+#include <chrono>
+#include <map>
+#include <utility>
+
+#include "../../SohImGuiImpl.h"
+
+#include "gfx_null.h"
+#include "gfx_cc.h"
+#include "gfx_screen_config.h"
+
+struct ShaderProgram {
+    uint8_t num_inputs;
+    bool used_textures[2];
+};
+
+static std::map<std::pair<uint64_t, uint32_t>, struct ShaderProgram> shader_program_pool;
+static uint32_t next_texture_id = 1;
+static int next_framebuffer_id = 1;
+
+static void gfx_null_wm_init(const char* game_name, bool start_in_fullscreen) {
+    SohImGui::WindowImpl window_impl;
+    window_impl.backend = SohImGui::Backend::Null;
+    SohImGui::Init(window_impl);
+}
+
+static void gfx_null_set_keyboard_callbacks(bool (*on_key_down)(int scancode), bool (*on_key_up)(int scancode), void (*on_all_keys_up)(void)) {
+}
+
+static void gfx_null_set_fullscreen_changed_callback(void (*on_fullscreen_changed)(bool is_now_fullscreen)) {
+}
+
+static void gfx_null_set_fullscreen(bool enable) {
+}
+
+static void gfx_null_show_cursor(bool hide) {
+}
+
+static void gfx_null_main_loop(void (*run_one_game_iter)(void)) {
+    while (1) {
+        run_one_game_iter();
+    }
+}
+
+static void gfx_null_get_dimensions(uint32_t* width, uint32_t* height) {
+    *width = DESIRED_SCREEN_WIDTH;
+    *height = DESIRED_SCREEN_HEIGHT;
+}
+
+static void gfx_null_handle_events(void) {
+}
+
+static bool gfx_null_wm_start_frame(void) {
+    return true;
+}
+
+static void gfx_null_swap_buffers_begin(void) {
+}
+
+static void gfx_null_swap_buffers_end(void) {
+}
+
+static double gfx_null_get_time(void) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void gfx_null_set_frame_divisor(int divisor) {
+}
+
+static struct GfxClipParameters gfx_null_get_clip_parameters(void) {
+    return { false, false };
+}
+
+static void gfx_null_unload_shader(struct ShaderProgram* old_prg) {
+}
+
+static void gfx_null_load_shader(struct ShaderProgram* new_prg) {
+}
+
+// gfx_pc lays out the vertex buffer from the program's inputs, so those still have to be worked out.
+static struct ShaderProgram* gfx_null_create_and_load_new_shader(uint64_t shader_id0, uint32_t shader_id1) {
+    struct CCFeatures cc_features;
+    gfx_cc_get_features(shader_id0, shader_id1, &cc_features);
+
+    struct ShaderProgram* prg = &shader_program_pool[std::make_pair(shader_id0, shader_id1)];
+    prg->num_inputs = cc_features.num_inputs;
+    prg->used_textures[0] = cc_features.used_textures[0];
+    prg->used_textures[1] = cc_features.used_textures[1];
+    return prg;
+}
+
+static struct ShaderProgram* gfx_null_lookup_shader(uint64_t shader_id0, uint32_t shader_id1) {
+    auto it = shader_program_pool.find(std::make_pair(shader_id0, shader_id1));
+    return it == shader_program_pool.end() ? nullptr : &it->second;
+}
+
+static void gfx_null_shader_get_info(struct ShaderProgram* prg, uint8_t* num_inputs, bool used_textures[2]) {
+    *num_inputs = prg->num_inputs;
+    used_textures[0] = prg->used_textures[0];
+    used_textures[1] = prg->used_textures[1];
+}
+
+static uint32_t gfx_null_new_texture(void) {
+    return next_texture_id++;
+}
+
+static void gfx_null_select_texture(int tile, uint32_t texture_id) {
+}
+
+static void gfx_null_upload_texture(const uint8_t* rgba32_buf, uint32_t width, uint32_t height) {
+}
+
+static void gfx_null_set_sampler_parameters(int sampler, bool linear_filter, uint32_t cms, uint32_t cmt) {
+}
+
+static void gfx_null_set_depth_test_and_mask(bool depth_test, bool z_upd) {
+}
+
+static void gfx_null_set_zmode_decal(bool zmode_decal) {
+}
+
+static void gfx_null_set_viewport(int x, int y, int width, int height) {
+}
+
+static void gfx_null_set_scissor(int x, int y, int width, int height) {
+}
+
+static void gfx_null_set_use_alpha(bool use_alpha) {
+}
+
+static void gfx_null_draw_triangles(float buf_vbo[], size_t buf_vbo_len, size_t buf_vbo_num_tris) {
+}
+
+static void gfx_null_init(void) {
+}
+
+static void gfx_null_on_resize(void) {
+}
+
+static void gfx_null_start_frame(void) {
+}
+
+static void gfx_null_end_frame(void) {
+}
+
+static void gfx_null_finish_render(void) {
+}
+
+static int gfx_null_create_framebuffer(void) {
+    return next_framebuffer_id++;
+}
+
+static void gfx_null_update_framebuffer_parameters(int fb_id, uint32_t width, uint32_t height, uint32_t msaa_level, bool opengl_invert_y, bool render_target, bool has_depth_buffer, bool can_extract_depth) {
+}
+
+static void gfx_null_start_draw_to_framebuffer(int fb_id, float noise_scale) {
+}
+
+static void gfx_null_clear_framebuffer(void) {
+}
+
+static void gfx_null_resolve_msaa_color_buffer(int fb_id_target, int fb_id_source) {
+}
+
+// Nothing is drawn, so every point reads as the near plane.
+static std::map<std::pair<float, float>, uint16_t> gfx_null_get_pixel_depth(int fb_id, const std::set<std::pair<float, float>>& coordinates) {
+    std::map<std::pair<float, float>, uint16_t> res;
+
+    for (const auto& coordinate : coordinates) {
+        res.emplace(coordinate, 0);
+    }
+
+    return res;
+}
+
+static void* gfx_null_get_framebuffer_texture_id(int fb_id) {
+    return nullptr;
+}
+
+static void gfx_null_select_texture_fb(int fb_id) {
+}
+
+static void gfx_null_delete_texture(uint32_t texID) {
+}
+
+struct GfxWindowManagerAPI gfx_null_wapi = {
+    gfx_null_wm_init,
+    gfx_null_set_keyboard_callbacks,
+    gfx_null_set_fullscreen_changed_callback,
+    gfx_null_set_fullscreen,
+    gfx_null_show_cursor,
+    gfx_null_main_loop,
+    gfx_null_get_dimensions,
+    gfx_null_handle_events,
+    gfx_null_wm_start_frame,
+    gfx_null_swap_buffers_begin,
+    gfx_null_swap_buffers_end,
+    gfx_null_get_time,
+    gfx_null_set_frame_divisor
+};
+
+struct GfxRenderingAPI gfx_null_api = {
+    gfx_null_get_clip_parameters,
+    gfx_null_unload_shader,
+    gfx_null_load_shader,
+    gfx_null_create_and_load_new_shader,
+    gfx_null_lookup_shader,
+    gfx_null_shader_get_info,
+    gfx_null_new_texture,
+    gfx_null_select_texture,
+    gfx_null_upload_texture,
+    gfx_null_set_sampler_parameters,
+    gfx_null_set_depth_test_and_mask,
+    gfx_null_set_zmode_decal,
+    gfx_null_set_viewport,
+    gfx_null_set_scissor,
+    gfx_null_set_use_alpha,
+    gfx_null_draw_triangles,
+    gfx_null_init,
+    gfx_null_on_resize,
+    gfx_null_start_frame,
+    gfx_null_end_frame,
+    gfx_null_finish_render,
+    gfx_null_create_framebuffer,
+    gfx_null_update_framebuffer_parameters,
+    gfx_null_start_draw_to_framebuffer,
+    gfx_null_clear_framebuffer,
+    gfx_null_resolve_msaa_color_buffer,
+    gfx_null_get_pixel_depth,
+    gfx_null_get_framebuffer_texture_id,
+    gfx_null_select_texture_fb,
+    gfx_null_delete_texture,
+    NULL,
+    NULL
+};
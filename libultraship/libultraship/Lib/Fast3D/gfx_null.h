@@ -0,0 +1,12 @@
+#ifndef GFX_NULL_H
+#define GFX_NULL_H
+
+#include "gfx_window_manager_api.h"
+#include "gfx_rendering_api.h"
+
+// Backend without a window or GPU. Everything gfx_pc does up to handing triangles over still runs,
+// so it is what display list timings and captured frame replays are measured against.
+extern struct GfxWindowManagerAPI gfx_null_wapi;
+extern struct GfxRenderingAPI gfx_null_api;
+
+#endif
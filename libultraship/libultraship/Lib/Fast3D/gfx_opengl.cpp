@@ -40,6 +40,21 @@
 #include "../../GlobalCtx2.h"
 #include "gfx_pc.h"
 
+#include <vector>
+#include <string.h>
+
+// Program binaries and persistently mapped buffers are extensions that are only looked up through GLEW.
+#if defined(_MSC_VER) || FOR_WINDOWS
+#define GFX_OPENGL_GLEW 1
+#endif
+
+#define PROGRAM_BINARY_CACHE_PATH "shaders_opengl.bin"
+#define PROGRAM_BINARY_CACHE_MAGIC "OTRGLBIN1"
+
+// Vertices are streamed through one ring of VBO_RING_SEGMENTS segments, each frame writes to the next one.
+#define VBO_RING_SEGMENT_SIZE (4 * 1024 * 1024)
+#define VBO_RING_SEGMENTS 3
+
 using namespace std;
 
 struct ShaderProgram {
@@ -66,6 +81,12 @@ struct Framebuffer {
 
 static map<pair<uint64_t, uint32_t>, struct ShaderProgram> shader_program_pool;
 static GLuint opengl_vbo;
+static size_t vbo_ring_offset;
+static size_t vbo_ring_segment;
+#ifdef GFX_OPENGL_GLEW
+static uint8_t* vbo_ring_mapped;
+static GLsync vbo_ring_fences[VBO_RING_SEGMENTS];
+#endif
 static bool current_depth_mask;
 
 static uint32_t frame_count;
@@ -77,6 +98,31 @@ static float current_noise_scale;
 GLuint pixel_depth_rb, pixel_depth_fb;
 size_t pixel_depth_rb_size;
 
+#ifdef GFX_OPENGL_GLEW
+// Depth reads queued at the end of a frame land in one of these pixel buffers and are picked up once the GPU got to them.
+#define PIXEL_DEPTH_READBACKS 2
+
+struct PixelDepthReadback {
+    GLuint pbo;
+    size_t pbo_size;
+    GLsync fence;
+    vector<pair<float, float>> coordinates;
+};
+
+static PixelDepthReadback pixel_depth_readbacks[PIXEL_DEPTH_READBACKS];
+static size_t pixel_depth_readback_index;
+#endif
+
+#ifdef GFX_OPENGL_GLEW
+struct ProgramBinary {
+    uint32_t format;
+    vector<uint8_t> data;
+};
+
+static map<pair<uint64_t, uint32_t>, struct ProgramBinary> program_binaries;
+static FILE* program_binary_file;
+#endif
+
 static struct GfxClipParameters gfx_opengl_get_clip_parameters(void) {
     return { false, framebuffers[current_framebuffer].invert_y };
 }
@@ -206,6 +252,134 @@ static void append_formula(char *buf, size_t *len, uint8_t c[2][4], bool do_sing
     }
 }
 
+#ifdef GFX_OPENGL_GLEW
+static void gfx_opengl_open_program_binaries(void) {
+    if (!GLEW_ARB_get_program_binary) {
+        return;
+    }
+
+    // Binaries only load on the driver that produced them, so the file is thrown away whenever the renderer or its version changes.
+    string driver = string((const char*)glGetString(GL_RENDERER)) + " " + (const char*)glGetString(GL_VERSION);
+    bool valid = false;
+
+    FILE* file = fopen(PROGRAM_BINARY_CACHE_PATH, "rb");
+
+    if (file != NULL) {
+        char magic[sizeof(PROGRAM_BINARY_CACHE_MAGIC)] = {};
+        uint32_t driver_len = 0;
+        string file_driver;
+
+        if (fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, PROGRAM_BINARY_CACHE_MAGIC, sizeof(magic)) == 0 &&
+            fread(&driver_len, sizeof(driver_len), 1, file) == 1 && driver_len == driver.size()) {
+            file_driver.resize(driver_len);
+            valid = fread(file_driver.data(), 1, driver_len, file) == driver_len && file_driver == driver;
+        }
+
+        while (valid) {
+            uint64_t shader_id0;
+            uint32_t shader_id1, format, length;
+
+            if (fread(&shader_id0, sizeof(shader_id0), 1, file) != 1 || fread(&shader_id1, sizeof(shader_id1), 1, file) != 1 ||
+                fread(&format, sizeof(format), 1, file) != 1 || fread(&length, sizeof(length), 1, file) != 1) {
+                break;
+            }
+
+            struct ProgramBinary& binary = program_binaries[make_pair(shader_id0, shader_id1)];
+            binary.format = format;
+            binary.data.resize(length);
+
+            if (fread(binary.data.data(), 1, length, file) != length) {
+                // A torn write at the end of the file, everything before it is still good.
+                program_binaries.erase(make_pair(shader_id0, shader_id1));
+                break;
+            }
+        }
+
+        fclose(file);
+    }
+
+    if (!valid) {
+        program_binaries.clear();
+    }
+
+    // Rewrite the file from what was just read so a binary saved again after failing to load, or anything from an old
+    // driver, is dropped instead of piling up; entries read later replaced earlier ones with the same ids above.
+    program_binary_file = fopen(PROGRAM_BINARY_CACHE_PATH, "wb");
+
+    if (program_binary_file != NULL) {
+        uint32_t driver_len = driver.size();
+        fwrite(PROGRAM_BINARY_CACHE_MAGIC, 1, sizeof(PROGRAM_BINARY_CACHE_MAGIC), program_binary_file);
+        fwrite(&driver_len, sizeof(driver_len), 1, program_binary_file);
+        fwrite(driver.data(), 1, driver_len, program_binary_file);
+
+        for (const auto& entry : program_binaries) {
+            uint32_t length = entry.second.data.size();
+            fwrite(&entry.first.first, sizeof(entry.first.first), 1, program_binary_file);
+            fwrite(&entry.first.second, sizeof(entry.first.second), 1, program_binary_file);
+            fwrite(&entry.second.format, sizeof(entry.second.format), 1, program_binary_file);
+            fwrite(&length, sizeof(length), 1, program_binary_file);
+            fwrite(entry.second.data.data(), 1, length, program_binary_file);
+        }
+
+        fflush(program_binary_file);
+    }
+}
+#endif
+
+static GLuint gfx_opengl_load_program_binary(uint64_t shader_id0, uint32_t shader_id1) {
+#ifdef GFX_OPENGL_GLEW
+    auto it = program_binaries.find(make_pair(shader_id0, shader_id1));
+
+    if (it == program_binaries.end()) {
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, it->second.format, it->second.data.data(), it->second.data.size());
+    program_binaries.erase(it);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+#else
+    return 0;
+#endif
+}
+
+static void gfx_opengl_save_program_binary(uint64_t shader_id0, uint32_t shader_id1, GLuint program) {
+#ifdef GFX_OPENGL_GLEW
+    if (program_binary_file == NULL) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0) {
+        return;
+    }
+
+    vector<uint8_t> data(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, data.data());
+
+    uint32_t format32 = format;
+    uint32_t length32 = length;
+    fwrite(&shader_id0, sizeof(shader_id0), 1, program_binary_file);
+    fwrite(&shader_id1, sizeof(shader_id1), 1, program_binary_file);
+    fwrite(&format32, sizeof(format32), 1, program_binary_file);
+    fwrite(&length32, sizeof(length32), 1, program_binary_file);
+    fwrite(data.data(), 1, length32, program_binary_file);
+    fflush(program_binary_file);
+#endif
+}
+
 static struct ShaderProgram* gfx_opengl_create_and_load_new_shader(uint64_t shader_id0, uint32_t shader_id1) {
     struct CCFeatures cc_features;
     gfx_cc_get_features(shader_id0, shader_id1, &cc_features);
@@ -377,42 +551,53 @@ static struct ShaderProgram* gfx_opengl_create_and_load_new_shader(uint64_t shad
     puts(fs_buf);
     puts("End");*/
 
-    const GLchar *sources[2] = { vs_buf, fs_buf };
-    const GLint lengths[2] = { (GLint) vs_len, (GLint) fs_len };
-    GLint success;
+    GLuint shader_program = gfx_opengl_load_program_binary(shader_id0, shader_id1);
+
+    if (shader_program == 0) {
+        const GLchar *sources[2] = { vs_buf, fs_buf };
+        const GLint lengths[2] = { (GLint) vs_len, (GLint) fs_len };
+        GLint success;
+
+        GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex_shader, 1, &sources[0], &lengths[0]);
+        glCompileShader(vertex_shader);
+        glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLint max_length = 0;
+            glGetShaderiv(vertex_shader, GL_INFO_LOG_LENGTH, &max_length);
+            char error_log[1024];
+            //fprintf(stderr, "Vertex shader compilation failed\n");
+            glGetShaderInfoLog(vertex_shader, max_length, &max_length, &error_log[0]);
+            //fprintf(stderr, "%s\n", &error_log[0]);
+            abort();
+        }
 
-    GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader, 1, &sources[0], &lengths[0]);
-    glCompileShader(vertex_shader);
-    glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        GLint max_length = 0;
-        glGetShaderiv(vertex_shader, GL_INFO_LOG_LENGTH, &max_length);
-        char error_log[1024];
-        //fprintf(stderr, "Vertex shader compilation failed\n");
-        glGetShaderInfoLog(vertex_shader, max_length, &max_length, &error_log[0]);
-        //fprintf(stderr, "%s\n", &error_log[0]);
-        abort();
-    }
-
-    GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader, 1, &sources[1], &lengths[1]);
-    glCompileShader(fragment_shader);
-    glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        GLint max_length = 0;
-        glGetShaderiv(fragment_shader, GL_INFO_LOG_LENGTH, &max_length);
-        char error_log[1024];
-        //fprintf(stderr, "Fragment shader compilation failed\n");
-        glGetShaderInfoLog(fragment_shader, max_length, &max_length, &error_log[0]);
-        //fprintf(stderr, "%s\n", &error_log[0]);
-        abort();
-    }
+        GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment_shader, 1, &sources[1], &lengths[1]);
+        glCompileShader(fragment_shader);
+        glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLint max_length = 0;
+            glGetShaderiv(fragment_shader, GL_INFO_LOG_LENGTH, &max_length);
+            char error_log[1024];
+            //fprintf(stderr, "Fragment shader compilation failed\n");
+            glGetShaderInfoLog(fragment_shader, max_length, &max_length, &error_log[0]);
+            //fprintf(stderr, "%s\n", &error_log[0]);
+            abort();
+        }
 
-    GLuint shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertex_shader);
-    glAttachShader(shader_program, fragment_shader);
-    glLinkProgram(shader_program);
+        shader_program = glCreateProgram();
+        glAttachShader(shader_program, vertex_shader);
+        glAttachShader(shader_program, fragment_shader);
+#ifdef GFX_OPENGL_GLEW
+        if (program_binary_file != NULL) {
+            glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+#endif
+        glLinkProgram(shader_program);
+
+        gfx_opengl_save_program_binary(shader_id0, shader_id1, shader_program);
+    }
 
     size_t cnt = 0;
 
@@ -571,10 +756,53 @@ static void gfx_opengl_set_use_alpha(bool use_alpha) {
     }
 }
 
+// Returns where in the ring the next size bytes go. The attribute pointers are set up from the start of the buffer,
+// so the offset is kept a multiple of the vertex stride and the draw picks its vertices through the first index.
+static size_t gfx_opengl_vbo_ring_alloc(size_t size, size_t stride) {
+#ifdef GFX_OPENGL_GLEW
+    if (vbo_ring_mapped != NULL) {
+        size_t segment_start = vbo_ring_segment * VBO_RING_SEGMENT_SIZE;
+        size_t offset = (vbo_ring_offset + stride - 1) / stride * stride;
+
+        if (offset + size > segment_start + VBO_RING_SEGMENT_SIZE) {
+            // This frame outgrew its segment, so the draws already made from it have to finish before it is reused.
+            glFinish();
+            offset = (segment_start + stride - 1) / stride * stride;
+        }
+
+        vbo_ring_offset = offset + size;
+        return offset;
+    }
+#endif
+
+    size_t offset = (vbo_ring_offset + stride - 1) / stride * stride;
+
+    if (offset + size > VBO_RING_SEGMENT_SIZE * VBO_RING_SEGMENTS) {
+        // Orphan the storage once per lap instead of on every upload.
+        glBufferData(GL_ARRAY_BUFFER, VBO_RING_SEGMENT_SIZE * VBO_RING_SEGMENTS, NULL, GL_STREAM_DRAW);
+        offset = 0;
+    }
+
+    vbo_ring_offset = offset + size;
+    return offset;
+}
+
 static void gfx_opengl_draw_triangles(float buf_vbo[], size_t buf_vbo_len, size_t buf_vbo_num_tris) {
     //printf("flushing %d tris\n", buf_vbo_num_tris);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * buf_vbo_len, buf_vbo, GL_STREAM_DRAW);
-    glDrawArrays(GL_TRIANGLES, 0, 3 * buf_vbo_num_tris);
+    size_t size = sizeof(float) * buf_vbo_len;
+    size_t stride = size / (3 * buf_vbo_num_tris);
+    size_t offset = gfx_opengl_vbo_ring_alloc(size, stride);
+
+#ifdef GFX_OPENGL_GLEW
+    if (vbo_ring_mapped != NULL) {
+        memcpy(vbo_ring_mapped + offset, buf_vbo, size);
+    } else
+#endif
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, buf_vbo);
+    }
+
+    glDrawArrays(GL_TRIANGLES, offset / stride, 3 * buf_vbo_num_tris);
 }
 
 static void gfx_opengl_init(void) {
@@ -585,6 +813,19 @@ static void gfx_opengl_init(void) {
     glGenBuffers(1, &opengl_vbo);
     glBindBuffer(GL_ARRAY_BUFFER, opengl_vbo);
 
+#ifdef GFX_OPENGL_GLEW
+    if (GLEW_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, VBO_RING_SEGMENT_SIZE * VBO_RING_SEGMENTS, NULL, flags);
+        vbo_ring_mapped = (uint8_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, VBO_RING_SEGMENT_SIZE * VBO_RING_SEGMENTS, flags);
+    }
+
+    if (vbo_ring_mapped == NULL)
+#endif
+    {
+        glBufferData(GL_ARRAY_BUFFER, VBO_RING_SEGMENT_SIZE * VBO_RING_SEGMENTS, NULL, GL_STREAM_DRAW);
+    }
+
     glDepthFunc(GL_LEQUAL);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -601,6 +842,10 @@ static void gfx_opengl_init(void) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     pixel_depth_rb_size = 1;
+
+#ifdef GFX_OPENGL_GLEW
+    gfx_opengl_open_program_binaries();
+#endif
 }
 
 static void gfx_opengl_on_resize(void) {
@@ -608,9 +853,31 @@ static void gfx_opengl_on_resize(void) {
 
 static void gfx_opengl_start_frame(void) {
     frame_count++;
+
+#ifdef GFX_OPENGL_GLEW
+    if (vbo_ring_mapped != NULL) {
+        // Wait for the GPU to be done with the frame that last wrote to this segment, it is two frames old by now so this rarely blocks.
+        vbo_ring_segment = (vbo_ring_segment + 1) % VBO_RING_SEGMENTS;
+        vbo_ring_offset = vbo_ring_segment * VBO_RING_SEGMENT_SIZE;
+
+        GLsync fence = vbo_ring_fences[vbo_ring_segment];
+        if (fence != NULL) {
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {
+            }
+            glDeleteSync(fence);
+            vbo_ring_fences[vbo_ring_segment] = NULL;
+        }
+    }
+#endif
 }
 
 static void gfx_opengl_end_frame(void) {
+#ifdef GFX_OPENGL_GLEW
+    if (vbo_ring_mapped != NULL) {
+        vbo_ring_fences[vbo_ring_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+#endif
+
     glFlush();
 }
 
@@ -723,7 +990,7 @@ void gfx_opengl_resolve_msaa_color_buffer(int fb_id_target, int fb_id_source) {
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fb_dst.fbo);
     glBindFramebuffer(GL_READ_FRAMEBUFFER, fb_src.fbo);
     glBlitFramebuffer(0, 0, fb_src.width, fb_src.height, 0, 0, fb_dst.width, fb_dst.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, current_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[current_framebuffer].fbo);
 }
 
 void *gfx_opengl_get_framebuffer_texture_id(int fb_id) {
@@ -736,6 +1003,35 @@ void gfx_opengl_select_texture_fb(int fb_id) {
     glBindTexture(GL_TEXTURE_2D, framebuffers[fb_id].clrbuf);
 }
 
+// Copies the depth/stencil value at each coordinate into a row of pixel_depth_rb and leaves pixel_depth_fb bound for reading.
+static void gfx_opengl_copy_pixel_depth(Framebuffer& fb, const std::set<std::pair<float, float>>& coordinates) {
+    if (pixel_depth_rb_size < coordinates.size()) {
+        glBindRenderbuffer(GL_RENDERBUFFER, pixel_depth_rb);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, coordinates.size(), 1);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        pixel_depth_rb_size = coordinates.size();
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, pixel_depth_fb);
+
+    glDisable(GL_SCISSOR_TEST); // needed for the blit operation
+
+    size_t i = 0;
+    for (const auto& coord : coordinates) {
+        int x = coord.first;
+        int y = coord.second;
+        if (fb.invert_y) {
+            y = fb.height - y;
+        }
+        glBlitFramebuffer(x, y, x + 1, y + 1, i, 0, i + 1, 1, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+        ++i;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, pixel_depth_fb);
+}
+
 static std::map<std::pair<float, float>, uint16_t> gfx_opengl_get_pixel_depth(int fb_id, const std::set<std::pair<float, float>>& coordinates) {
     std::map<std::pair<float, float>, uint16_t> res;
 
@@ -749,33 +1045,8 @@ static std::map<std::pair<float, float>, uint16_t> gfx_opengl_get_pixel_depth(in
         glReadPixels(x, fb.invert_y ? fb.height - y : y, 1, 1, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, &depth_stencil_value);
         res.emplace(*coordinates.begin(), (depth_stencil_value >> 18) << 2);
     } else {
-        if (pixel_depth_rb_size < coordinates.size()) {
-            glBindRenderbuffer(GL_RENDERBUFFER, pixel_depth_rb);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, coordinates.size(), 1);
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-            pixel_depth_rb_size = coordinates.size();
-        }
-
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.fbo);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, pixel_depth_fb);
-
-        glDisable(GL_SCISSOR_TEST); // needed for the blit operation
+        gfx_opengl_copy_pixel_depth(fb, coordinates);
 
-        {
-            size_t i = 0;
-            for (const auto& coord : coordinates) {
-                int x = coord.first;
-                int y = coord.second;
-                if (fb.invert_y) {
-                    y = fb.height - y;
-                }
-                glBlitFramebuffer(x, y, x + 1, y + 1, i, 0, i + 1, 1, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
-                ++i;
-            }
-        }
-
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, pixel_depth_fb);
         vector<uint32_t> depth_stencil_values(coordinates.size());
         glReadPixels(0, 0, coordinates.size(), 1, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, depth_stencil_values.data());
 
@@ -787,10 +1058,78 @@ static std::map<std::pair<float, float>, uint16_t> gfx_opengl_get_pixel_depth(in
         }
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, current_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[current_framebuffer].fbo);
     return res;
 }
 
+#ifdef GFX_OPENGL_GLEW
+static void gfx_opengl_queue_pixel_depth(int fb_id, const std::set<std::pair<float, float>>& coordinates) {
+    if (coordinates.empty()) {
+        return;
+    }
+
+    PixelDepthReadback& readback = pixel_depth_readbacks[pixel_depth_readback_index];
+    pixel_depth_readback_index = (pixel_depth_readback_index + 1) % PIXEL_DEPTH_READBACKS;
+
+    // A read from two frames ago that nobody collected is stale by now
+    if (readback.fence != NULL) {
+        glDeleteSync(readback.fence);
+        readback.fence = NULL;
+    }
+
+    gfx_opengl_copy_pixel_depth(framebuffers[fb_id], coordinates);
+
+    if (readback.pbo == 0) {
+        glGenBuffers(1, &readback.pbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    if (readback.pbo_size < coordinates.size() * sizeof(uint32_t)) {
+        readback.pbo_size = coordinates.size() * sizeof(uint32_t);
+        glBufferData(GL_PIXEL_PACK_BUFFER, readback.pbo_size, NULL, GL_STREAM_READ);
+    }
+    glReadPixels(0, 0, coordinates.size(), 1, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.coordinates.assign(coordinates.begin(), coordinates.end());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[current_framebuffer].fbo);
+}
+
+static bool gfx_opengl_collect_pixel_depth(std::map<std::pair<float, float>, uint16_t>& results) {
+    bool collected = false;
+
+    // Oldest first, so the newest finished read wins
+    for (size_t n = 0; n < PIXEL_DEPTH_READBACKS; n++) {
+        PixelDepthReadback& readback = pixel_depth_readbacks[(pixel_depth_readback_index + n) % PIXEL_DEPTH_READBACKS];
+        if (readback.fence == NULL) {
+            continue;
+        }
+
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            continue;
+        }
+        glDeleteSync(readback.fence);
+        readback.fence = NULL;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        const uint32_t* depth_stencil_values = (const uint32_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.coordinates.size() * sizeof(uint32_t), GL_MAP_READ_BIT);
+        if (depth_stencil_values != NULL) {
+            results.clear();
+            for (size_t i = 0; i < readback.coordinates.size(); i++) {
+                results.emplace(readback.coordinates[i], (depth_stencil_values[i] >> 18) << 2);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            collected = true;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    return collected;
+}
+#endif
+
 struct GfxRenderingAPI gfx_opengl_api = {
     gfx_opengl_get_clip_parameters,
     gfx_opengl_unload_shader,
@@ -821,7 +1160,14 @@ struct GfxRenderingAPI gfx_opengl_api = {
     gfx_opengl_get_pixel_depth,
     gfx_opengl_get_framebuffer_texture_id,
     gfx_opengl_select_texture_fb,
-    gfx_opengl_delete_texture
+    gfx_opengl_delete_texture,
+#ifdef GFX_OPENGL_GLEW
+    gfx_opengl_queue_pixel_depth,
+    gfx_opengl_collect_pixel_depth
+#else
+    NULL,
+    NULL
+#endif
 };
 
 #endif
@@ -6,7 +6,13 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -20,6 +26,8 @@
 #include <iostream>
 
 #include "gfx_pc.h"
+#include "gfx_texture_decode.h"
+#include "gfx_capture.h"
 #include "gfx_cc.h"
 #include "gfx_window_manager_api.h"
 #include "gfx_rendering_api.h"
@@ -38,7 +46,7 @@ extern "C" {
     Vtx* ResourceMgr_LoadVtxByCRC(uint64_t crc);
     Gfx* ResourceMgr_LoadGfxByCRC(uint64_t crc);
     char* ResourceMgr_LoadTexByCRC(uint64_t crc);
-    void ResourceMgr_RegisterResourcePatch(uint64_t hash, uint32_t instrIndex, uintptr_t origData);
+    void ResourceMgr_RegisterResourcePatch(uint64_t hash, uint32_t instrIndex, uint64_t origData, uint64_t targetHash);
     char* ResourceMgr_LoadTexByName(char* texPath);
     int ResourceMgr_OTRSigCheck(char* imgData);
 }
@@ -63,7 +71,8 @@ using namespace std;
 #define RATIO_X (gfx_current_dimensions.width / (2.0f * HALF_SCREEN_WIDTH))
 #define RATIO_Y (gfx_current_dimensions.height / (2.0f * HALF_SCREEN_HEIGHT))
 
-#define MAX_BUFFERED 256
+// Queued draws are submitted early once their vertices take this many floats
+#define MAX_QUEUED_FLOATS (16 * GFX_MAX_DRAW_TRIANGLES * 32 * 3)
 //#define MAX_LIGHTS 2
 #define MAX_LIGHTS 32
 #define MAX_VERTICES 64
@@ -81,10 +90,26 @@ struct LoadedVertex {
     uint8_t clip_rej;
 };
 
+// Sampler state and accounting of one GPU texture. With deduplication several cache entries can share a texture.
+struct TextureCacheTexture {
+    uint32_t refs;
+    uint32_t size_bytes;
+    uint64_t content_hash; // 0 if the texture is not deduplicated
+    uint8_t sampler; // Packed as in DrawState, as last set on the texture
+};
+
 static struct {
     TextureCacheMap map;
     list<TextureCacheMap::iterator> lru;
     vector<uint32_t> free_texture_ids;
+    vector<uint32_t> retired_texture_ids; // Released while queued draws may still sample them, freed by the next flush
+    vector<TextureCacheTexture> textures; // Indexed by texture id
+    unordered_map<uint64_t, uint32_t> by_content; // Content hash to texture id
+    size_t bytes;
+    size_t budget; // 0 falls back to evicting by entry count
+    bool dedup;
+    uint32_t last_upload_bytes;
+    struct GfxTextureCacheStats stats;
 } gfx_texture_cache;
 
 struct ColorCombiner {
@@ -164,15 +189,37 @@ static struct RDP {
     void *color_image_address;
 } rdp;
 
-static struct RenderingState {
+#define DRAW_NO_TEXTURE 0xFFFFFFFF
+#define DRAW_FRAMEBUFFER_TEXTURE 0x80000000 // Or'ed with the framebuffer id
+#define DRAW_UNKNOWN_SAMPLER 0xFF
+
+// Everything the rendering API is told between draws. Triangles are queued in batches of equal state and only submitted by
+// gfx_flush, so the backend gets these values when a batch is drawn rather than when its triangles are generated.
+struct DrawState {
+    struct ShaderProgram *shader_program;
+    uint32_t texture_ids[2];
+    struct XYWidthHeight viewport, scissor;
+    uint8_t samplers[2]; // linear filter | cms << 1 | cmt << 3
     uint8_t depth_test_and_mask; // 1: depth test, 2: depth mask
     bool decal_mode;
     bool alpha_blend;
-    struct XYWidthHeight viewport, scissor;
-    struct ShaderProgram *shader_program;
+};
+
+struct DrawBatch {
+    struct DrawState state;
+    size_t vbo_start, vbo_len;
+    size_t num_tris;
+};
+
+static struct RenderingState {
+    struct DrawState draw;
     TextureCacheNode *textures[2];
+    uint32_t framebuffer_texture; // Bound to texture 0 by G_SETTIMG_FB until the next import
 } rendering_state;
 
+// What the rendering API currently has
+static struct DrawState applied_state;
+
 struct GfxDimensions gfx_current_window_dimensions;
 struct GfxDimensions gfx_current_dimensions;
 static struct GfxDimensions gfx_prev_dimensions;
@@ -186,9 +233,14 @@ uint32_t gfx_msaa_level = 1;
 
 static bool dropped_frame;
 
-static float buf_vbo[MAX_BUFFERED * (32 * 3)]; // 3 vertices in a triangle and 32 floats per vtx
+static vector<float> buf_vbo; // 3 vertices in a triangle and up to 32 floats per vtx, for every queued batch
 static size_t buf_vbo_len;
-static size_t buf_vbo_num_tris;
+static size_t buf_vbo_num_tris; // Of the batch still being filled
+static size_t buf_vbo_batch_start;
+static vector<DrawBatch> draw_batches;
+static vector<size_t> draw_order;
+static vector<float> draw_merge_buf;
+static struct GfxDrawStats draw_stats;
 
 static struct GfxWindowManagerAPI *gfx_wapi;
 static struct GfxRenderingAPI *gfx_rapi;
@@ -207,6 +259,14 @@ static map<int, FBInfo> framebuffers;
 
 static set<pair<float, float>> get_pixel_depth_pending;
 static map<pair<float, float>, uint16_t> get_pixel_depth_cached;
+// Coordinates asked for this frame are read back asynchronously at the end of the frame, if the rendering API supports it.
+// Later frames answer from those results as long as a coordinate was read close enough to the one asked for.
+static set<pair<float, float>> get_pixel_depth_requested;
+static map<pair<float, float>, uint16_t> get_pixel_depth_async;
+static bool get_pixel_depth_collected;
+// When deferred the game asks from another thread while a frame is drawn, it only ever gets answers from earlier frames.
+static bool get_pixel_depth_deferred;
+static std::mutex get_pixel_depth_mutex;
 
 #ifdef _MSC_VER
 // TODO: Properly implement for MSVC
@@ -224,36 +284,220 @@ static unsigned long get_time(void) {
 }
 #endif
 
-static void gfx_flush(void) {
-    if (buf_vbo_len > 0) {
-        int num = buf_vbo_num_tris;
-        unsigned long t0 = get_time();
+// Orders states so that equal ones end up next to each other, grouped by program first as that is the costliest switch.
+static int gfx_draw_state_compare(const DrawState& a, const DrawState& b) {
+    if (a.shader_program != b.shader_program) {
+        return (uintptr_t)a.shader_program < (uintptr_t)b.shader_program ? -1 : 1;
+    }
+    // The fields from texture_ids to alpha_blend have no padding between them
+    return memcmp(a.texture_ids, b.texture_ids, offsetof(DrawState, alpha_blend) + sizeof(bool) - offsetof(DrawState, texture_ids));
+}
 
-        if (markerOn)
-        {
-            int bp = 0;
+// Opaque triangles that test and write depth end up the same whichever order they are drawn in, except for coplanar ones.
+static bool gfx_draw_state_reorderable(const DrawState& state) {
+    return state.depth_test_and_mask == 3 && !state.decal_mode && !state.alpha_blend;
+}
+
+static void gfx_apply_draw_state(const DrawState& state) {
+    if (state.depth_test_and_mask != applied_state.depth_test_and_mask) {
+        gfx_rapi->set_depth_test_and_mask((state.depth_test_and_mask & 1) != 0, (state.depth_test_and_mask & 2) != 0);
+        applied_state.depth_test_and_mask = state.depth_test_and_mask;
+    }
+    if (state.decal_mode != applied_state.decal_mode) {
+        gfx_rapi->set_zmode_decal(state.decal_mode);
+        applied_state.decal_mode = state.decal_mode;
+    }
+    if (memcmp(&state.viewport, &applied_state.viewport, sizeof(state.viewport)) != 0) {
+        gfx_rapi->set_viewport(state.viewport.x, state.viewport.y, state.viewport.width, state.viewport.height);
+        applied_state.viewport = state.viewport;
+    }
+    if (memcmp(&state.scissor, &applied_state.scissor, sizeof(state.scissor)) != 0) {
+        gfx_rapi->set_scissor(state.scissor.x, state.scissor.y, state.scissor.width, state.scissor.height);
+        applied_state.scissor = state.scissor;
+    }
+    if (state.shader_program != applied_state.shader_program) {
+        gfx_rapi->unload_shader(applied_state.shader_program);
+        gfx_rapi->load_shader(state.shader_program);
+        applied_state.shader_program = state.shader_program;
+    }
+    if (state.alpha_blend != applied_state.alpha_blend) {
+        gfx_rapi->set_use_alpha(state.alpha_blend);
+        applied_state.alpha_blend = state.alpha_blend;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        uint32_t texture_id = state.texture_ids[i];
+        if (texture_id == DRAW_NO_TEXTURE) {
+            continue;
+        }
+
+        if (texture_id != applied_state.texture_ids[i]) {
+            if (texture_id & DRAW_FRAMEBUFFER_TEXTURE) {
+                gfx_rapi->select_texture_fb(texture_id & ~DRAW_FRAMEBUFFER_TEXTURE);
+                applied_state.samplers[i] = DRAW_UNKNOWN_SAMPLER;
+            } else {
+                gfx_rapi->select_texture(i, texture_id);
+                applied_state.samplers[i] = gfx_texture_cache.textures[texture_id].sampler;
+            }
+            applied_state.texture_ids[i] = texture_id;
+        }
+
+        // Sampler state lives with the GPU texture, which may be shared by several cache entries or bound to both slots
+        uint8_t sampler = state.samplers[i];
+        if (sampler != applied_state.samplers[i]) {
+            gfx_rapi->set_sampler_parameters(i, (sampler & 1) != 0, (sampler >> 1) & 3, (sampler >> 3) & 3);
+            applied_state.samplers[i] = sampler;
+            if (!(texture_id & DRAW_FRAMEBUFFER_TEXTURE)) {
+                gfx_texture_cache.textures[texture_id].sampler = sampler;
+                if (applied_state.texture_ids[i ^ 1] == texture_id) {
+                    applied_state.samplers[i ^ 1] = sampler;
+                }
+            }
         }
+    }
+}
+
+static void gfx_draw(const DrawState& state, float buf[], size_t len, size_t num_tris) {
+    if (markerOn)
+    {
+        int bp = 0;
+    }
+
+    gfx_apply_draw_state(state);
+    gfx_rapi->draw_triangles(buf, len, num_tris);
+    draw_stats.flushes++;
+    draw_stats.triangles += num_tris;
+}
 
-        gfx_rapi->draw_triangles(buf_vbo, buf_vbo_len, buf_vbo_num_tris);
-        buf_vbo_len = 0;
+// Queues the triangles generated since the last state change as one batch
+static void gfx_end_batch(void) {
+    if (buf_vbo_num_tris > 0) {
+        draw_batches.push_back({ rendering_state.draw, buf_vbo_batch_start, buf_vbo_len - buf_vbo_batch_start, buf_vbo_num_tris });
+        buf_vbo_batch_start = buf_vbo_len;
         buf_vbo_num_tris = 0;
-        unsigned long t1 = get_time();
-        /*if (t1 - t0 > 1000) {
-            printf("f: %d %d\n", num, (int)(t1 - t0));
-        }*/
     }
 }
 
+// Submits every queued batch. Runs of reorderable batches are sorted by state and equal neighbours merged into one draw,
+// every other batch is drawn where it was queued so blending and decals still see what was drawn before them.
+static void gfx_flush(void) {
+    gfx_end_batch();
+
+    for (size_t first = 0; first < draw_batches.size();) {
+        size_t last = first + 1;
+        if (gfx_draw_state_reorderable(draw_batches[first].state)) {
+            while (last < draw_batches.size() && gfx_draw_state_reorderable(draw_batches[last].state)) {
+                last++;
+            }
+        }
+
+        draw_order.clear();
+        for (size_t i = first; i < last; i++) {
+            draw_order.push_back(i);
+        }
+        std::stable_sort(draw_order.begin(), draw_order.end(), [](size_t a, size_t b) {
+            return gfx_draw_state_compare(draw_batches[a].state, draw_batches[b].state) < 0;
+        });
+
+        for (size_t i = 0; i < draw_order.size();) {
+            const DrawBatch& batch = draw_batches[draw_order[i]];
+            size_t num_tris = batch.num_tris;
+            bool contiguous = true;
+            size_t j = i + 1;
+
+            for (; j < draw_order.size(); j++) {
+                const DrawBatch& prev = draw_batches[draw_order[j - 1]];
+                const DrawBatch& next = draw_batches[draw_order[j]];
+                if (num_tris + next.num_tris > GFX_MAX_DRAW_TRIANGLES || gfx_draw_state_compare(next.state, batch.state) != 0) {
+                    break;
+                }
+                contiguous = contiguous && next.vbo_start == prev.vbo_start + prev.vbo_len;
+                num_tris += next.num_tris;
+            }
+
+            if (contiguous) {
+                const DrawBatch& end = draw_batches[draw_order[j - 1]];
+                gfx_draw(batch.state, &buf_vbo[batch.vbo_start], end.vbo_start + end.vbo_len - batch.vbo_start, num_tris);
+            } else {
+                draw_merge_buf.clear();
+                for (size_t k = i; k < j; k++) {
+                    const DrawBatch& merged = draw_batches[draw_order[k]];
+                    draw_merge_buf.insert(draw_merge_buf.end(), buf_vbo.begin() + merged.vbo_start, buf_vbo.begin() + merged.vbo_start + merged.vbo_len);
+                }
+                gfx_draw(batch.state, draw_merge_buf.data(), draw_merge_buf.size(), num_tris);
+            }
+
+            i = j;
+        }
+
+        first = last;
+    }
+
+    draw_batches.clear();
+    buf_vbo_len = 0;
+    buf_vbo_batch_start = 0;
+
+    gfx_texture_cache.free_texture_ids.insert(gfx_texture_cache.free_texture_ids.end(), gfx_texture_cache.retired_texture_ids.begin(),
+                                              gfx_texture_cache.retired_texture_ids.end());
+    gfx_texture_cache.retired_texture_ids.clear();
+}
+
+struct GfxDrawStats gfx_get_draw_stats(void) {
+    return draw_stats;
+}
+
+#define SHADER_CACHE_PATH "shaders.cache"
+#define SHADER_CACHE_VERSION "v1"
+
+static FILE* shader_cache_file;
+
 static struct ShaderProgram *gfx_lookup_or_create_shader_program(uint64_t shader_id0, uint32_t shader_id1) {
     struct ShaderProgram *prg = gfx_rapi->lookup_shader(shader_id0, shader_id1);
     if (prg == NULL) {
-        gfx_rapi->unload_shader(rendering_state.shader_program);
+        gfx_rapi->unload_shader(applied_state.shader_program);
         prg = gfx_rapi->create_and_load_new_shader(shader_id0, shader_id1);
-        rendering_state.shader_program = prg;
+        applied_state.shader_program = prg;
+
+        // Remember the combination so the next session builds it during gfx_init instead of mid-frame.
+        if (shader_cache_file != NULL) {
+            fprintf(shader_cache_file, "%016llx %08x\n", (unsigned long long)shader_id0, shader_id1);
+            fflush(shader_cache_file);
+        }
     }
     return prg;
 }
 
+static void gfx_warm_up_shader_cache(void) {
+    vector<pair<uint64_t, uint32_t>> shader_ids;
+    FILE* file = fopen(SHADER_CACHE_PATH, "r");
+
+    if (file != NULL) {
+        char version[16] = {};
+        unsigned long long shader_id0;
+        unsigned int shader_id1;
+
+        // Ids written by another version of the combiner code may mean something else, so those lists are dropped.
+        if (fscanf(file, "%15s", version) == 1 && strcmp(version, SHADER_CACHE_VERSION) == 0) {
+            while (fscanf(file, "%llx %x", &shader_id0, &shader_id1) == 2) {
+                shader_ids.push_back(make_pair(shader_id0, shader_id1));
+            }
+        }
+
+        fclose(file);
+    }
+
+    // The list is written again as the programs get created, which also drops duplicates and anything unreadable.
+    shader_cache_file = fopen(SHADER_CACHE_PATH, "w");
+
+    if (shader_cache_file != NULL) {
+        fprintf(shader_cache_file, "%s\n", SHADER_CACHE_VERSION);
+    }
+
+    for (const auto& ids : shader_ids) {
+        gfx_lookup_or_create_shader_program(ids.first, ids.second);
+    }
+}
+
 static const char* ccmux_to_string(uint32_t ccmux) {
         static const char* const tbl[] = {
             "G_CCMUX_COMBINED",
@@ -492,13 +736,135 @@ static struct ColorCombiner *gfx_lookup_or_create_color_combiner(uint64_t cc_id)
     return &prev_combiner->second;
 }
 
+static TextureCacheTexture& gfx_texture_cache_texture(uint32_t texture_id) {
+    if (texture_id >= gfx_texture_cache.textures.size()) {
+        gfx_texture_cache.textures.resize(texture_id + 1, TextureCacheTexture());
+    }
+    return gfx_texture_cache.textures[texture_id];
+}
+
+static void gfx_texture_cache_release(TextureCacheMap::iterator it) {
+    uint32_t texture_id = it->second.texture_id;
+    TextureCacheTexture& texture = gfx_texture_cache_texture(texture_id);
+
+    for (int i = 0; i < 2; i++) {
+        if (&*it == rendering_state.textures[i]) {
+            rendering_state.textures[i] = nullptr;
+            rdp.textures_changed[i] = true;
+        }
+    }
+
+    gfx_texture_cache.lru.erase(*(list<TextureCacheMap::iterator>::iterator*)&it->second.lru_location);
+    gfx_texture_cache.map.erase(it);
+
+    if (--texture.refs == 0) {
+        gfx_texture_cache.bytes -= texture.size_bytes;
+        if (texture.content_hash != 0) {
+            gfx_texture_cache.by_content.erase(texture.content_hash);
+        }
+        // The record keeps the sampler state until the id is handed out again, queued draws may still use the texture
+        texture.size_bytes = 0;
+        texture.content_hash = 0;
+        gfx_texture_cache.retired_texture_ids.push_back(texture_id);
+        gfx_texture_cache.stats.textures--;
+    }
+}
+
 void gfx_texture_cache_clear()
 {
     for (const auto& entry : gfx_texture_cache.map) {
-        gfx_texture_cache.free_texture_ids.push_back(entry.second.texture_id);
+        TextureCacheTexture& texture = gfx_texture_cache_texture(entry.second.texture_id);
+        if (texture.refs != 0) {
+            texture.refs = 0;
+            texture.size_bytes = 0;
+            texture.content_hash = 0;
+            gfx_texture_cache.retired_texture_ids.push_back(entry.second.texture_id);
+        }
     }
     gfx_texture_cache.map.clear();
     gfx_texture_cache.lru.clear();
+    gfx_texture_cache.by_content.clear();
+    gfx_texture_cache.bytes = 0;
+    gfx_texture_cache.stats.textures = 0;
+
+    for (int i = 0; i < 2; i++) {
+        rendering_state.textures[i] = nullptr;
+        rdp.textures_changed[i] = true;
+    }
+}
+
+void gfx_texture_cache_configure(size_t budget_bytes, bool dedup) {
+    gfx_texture_cache_clear();
+    gfx_texture_cache.budget = budget_bytes;
+    gfx_texture_cache.dedup = dedup;
+}
+
+struct GfxTextureCacheStats gfx_texture_cache_get_stats(void) {
+    struct GfxTextureCacheStats stats = gfx_texture_cache.stats;
+    stats.entries = gfx_texture_cache.map.size();
+    stats.bytes = gfx_texture_cache.bytes;
+    stats.budget = gfx_texture_cache.budget;
+    return stats;
+}
+
+static uint64_t gfx_texture_hash_bytes(uint64_t h, const uint8_t* data, size_t size) {
+    const uint64_t k = 0x9E3779B97F4A7C15ULL;
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        h = (h ^ word) * k;
+        h ^= h >> 29;
+    }
+    for (; i < size; i++) {
+        h = (h ^ data[i]) * k;
+    }
+
+    return h ^ (h >> 32);
+}
+
+// Hash of everything the imported texture depends on: the texels as laid out in RAM, the TLUT and the tile dimensions.
+static uint64_t gfx_texture_content_hash(int tile) {
+    uint8_t fmt = rdp.texture_tile[tile].fmt;
+    uint8_t siz = rdp.texture_tile[tile].siz;
+    uint32_t tmem_index = rdp.texture_tile[tile].tmem_index;
+    uint32_t size_bytes = rdp.loaded_texture[tmem_index].size_bytes;
+    uint32_t full_image_line_size_bytes = rdp.loaded_texture[tmem_index].full_image_line_size_bytes;
+    uint32_t line_size_bytes = rdp.loaded_texture[tmem_index].line_size_bytes;
+
+    uint32_t header[4] = { (uint32_t)fmt | ((uint32_t)siz << 8), size_bytes, rdp.texture_tile[tile].line_size_bytes, line_size_bytes };
+    uint64_t h = gfx_texture_hash_bytes(0, (const uint8_t*)header, sizeof(header));
+
+    // CI8 is the only importer that follows the source line stride
+    size_t span = size_bytes;
+    if (fmt == G_IM_FMT_CI && siz == G_IM_SIZ_8b && line_size_bytes != 0 && full_image_line_size_bytes != line_size_bytes) {
+        uint32_t lines = (size_bytes + line_size_bytes - 1) / line_size_bytes;
+        span = (size_t)(lines - 1) * full_image_line_size_bytes + line_size_bytes;
+    }
+    h = gfx_texture_hash_bytes(h, rdp.loaded_texture[tmem_index].addr, span);
+
+    if (fmt == G_IM_FMT_CI) {
+        if (siz == G_IM_SIZ_4b) {
+            uint32_t pal_idx = rdp.texture_tile[tile].palette;
+            h = gfx_texture_hash_bytes(h, rdp.palettes[pal_idx / 8] + (pal_idx % 8) * 16 * 2, 16 * 2);
+        } else {
+            h = gfx_texture_hash_bytes(h, rdp.palettes[0], 128 * 2);
+            h = gfx_texture_hash_bytes(h, rdp.palettes[1], 128 * 2);
+        }
+    }
+
+    return h != 0 ? h : 1;
+}
+
+// Binds the texture right away, as the upload that may follow goes to the bound texture
+static void gfx_texture_cache_select(int i, uint32_t texture_id) {
+    gfx_rapi->select_texture(i, texture_id);
+    applied_state.texture_ids[i] = texture_id;
+    applied_state.samplers[i] = gfx_texture_cache.textures[texture_id].sampler;
+    if (applied_state.texture_ids[i ^ 1] == texture_id) {
+        applied_state.samplers[i ^ 1] = applied_state.samplers[i];
+    }
 }
 
 static bool gfx_texture_cache_lookup(int i, int tile) {
@@ -520,84 +886,118 @@ static bool gfx_texture_cache_lookup(int i, int tile) {
     auto it = gfx_texture_cache.map.find(key);
 
     if (it != gfx_texture_cache.map.end()) {
-        gfx_rapi->select_texture(i, it->second.texture_id);
+        gfx_texture_cache_select(i, it->second.texture_id);
         *n = &*it;
         gfx_texture_cache.lru.splice(gfx_texture_cache.lru.end(), gfx_texture_cache.lru, *(list<TextureCacheMap::iterator>::iterator*)&it->second.lru_location); // move to back
+        gfx_texture_cache.stats.hits++;
         return true;
     }
 
-    if (gfx_texture_cache.map.size() >= TEXTURE_CACHE_MAX_SIZE) {
-        // Remove the texture that was least recently used
-        it = gfx_texture_cache.lru.front();
-        gfx_texture_cache.free_texture_ids.push_back(it->second.texture_id);
-        gfx_texture_cache.map.erase(it);
-        gfx_texture_cache.lru.pop_front();
-    }
+    gfx_texture_cache.stats.misses++;
 
+    // The same texels reached through another address or palette pointer can reuse the texture that is already uploaded
+    uint64_t content_hash = 0;
     uint32_t texture_id;
-    if (!gfx_texture_cache.free_texture_ids.empty()) {
-        texture_id = gfx_texture_cache.free_texture_ids.back();
-        gfx_texture_cache.free_texture_ids.pop_back();
-    } else {
-        texture_id = gfx_rapi->new_texture();
+    bool shared = false;
+    if (gfx_texture_cache.dedup) {
+        content_hash = gfx_texture_content_hash(tile);
+        auto content = gfx_texture_cache.by_content.find(content_hash);
+        if (content != gfx_texture_cache.by_content.end()) {
+            texture_id = content->second;
+            shared = true;
+            gfx_texture_cache.stats.dedup_hits++;
+        }
     }
 
+    if (!shared) {
+        if (!gfx_texture_cache.free_texture_ids.empty()) {
+            texture_id = gfx_texture_cache.free_texture_ids.back();
+            gfx_texture_cache.free_texture_ids.pop_back();
+        } else {
+            texture_id = gfx_rapi->new_texture();
+        }
+        TextureCacheTexture& texture = gfx_texture_cache_texture(texture_id);
+        texture = TextureCacheTexture();
+        texture.content_hash = content_hash;
+        if (content_hash != 0) {
+            gfx_texture_cache.by_content[content_hash] = texture_id;
+        }
+        gfx_texture_cache.stats.textures++;
+    }
+    gfx_texture_cache_texture(texture_id).refs++;
+
     it = gfx_texture_cache.map.insert(make_pair(key, TextureCacheValue())).first;
     TextureCacheNode* node = &*it;
     node->second.texture_id = texture_id;
     *(list<TextureCacheMap::iterator>::iterator*)&node->second.lru_location = gfx_texture_cache.lru.insert(gfx_texture_cache.lru.end(), it);
 
-    gfx_rapi->select_texture(i, texture_id);
-    gfx_rapi->set_sampler_parameters(i, false, 0, 0);
+    gfx_texture_cache_select(i, texture_id);
+    if (!shared) {
+        gfx_rapi->set_sampler_parameters(i, false, 0, 0);
+    }
     *n = node;
-    return false;
+    return shared;
+}
+
+// Evicts least recently used entries until the cache is back within its budget. Entries bound to a texture slot stay, since
+// rendering_state points at them.
+static void gfx_texture_cache_trim(void) {
+    auto over_budget = []() {
+        if (gfx_texture_cache.budget == 0) {
+            return gfx_texture_cache.map.size() > TEXTURE_CACHE_MAX_SIZE;
+        }
+        return gfx_texture_cache.bytes > gfx_texture_cache.budget;
+    };
+
+    for (auto lru_it = gfx_texture_cache.lru.begin(); lru_it != gfx_texture_cache.lru.end() && over_budget();) {
+        TextureCacheMap::iterator it = *lru_it++;
+        if (&*it == rendering_state.textures[0] || &*it == rendering_state.textures[1]) {
+            continue;
+        }
+        gfx_texture_cache_release(it);
+        gfx_texture_cache.stats.evictions++;
+    }
 }
 
 static void gfx_texture_cache_delete(const uint8_t* orig_addr)
 {
-    while (gfx_texture_cache.map.bucket_count() > 0) {
-        TextureCacheKey key = { orig_addr, 0, 0, 0 }; // bucket index only depends on the address
-        size_t bucket = gfx_texture_cache.map.bucket(key);
-        bool again = false;
-        for (auto it = gfx_texture_cache.map.begin(bucket); it != gfx_texture_cache.map.end(bucket); ++it) {
-            if (it->first.texture_addr == orig_addr) {
-                gfx_texture_cache.lru.erase(*(list<TextureCacheMap::iterator>::iterator*)&it->second.lru_location);
-                gfx_texture_cache.free_texture_ids.push_back(it->second.texture_id);
-                gfx_texture_cache.map.erase(it);
-                again = true;
-                break;
-            }
-        }
-        if (!again) {
-            break;
+    if (gfx_texture_cache.map.bucket_count() == 0) {
+        return;
+    }
+
+    TextureCacheKey key = { orig_addr, 0, 0, 0 }; // bucket index only depends on the address
+    size_t bucket = gfx_texture_cache.map.bucket(key);
+    vector<TextureCacheMap::iterator> matches;
+    for (auto it = gfx_texture_cache.map.begin(bucket); it != gfx_texture_cache.map.end(bucket); ++it) {
+        if (it->first.texture_addr == orig_addr) {
+            matches.push_back(gfx_texture_cache.map.find(it->first));
         }
     }
+
+    for (TextureCacheMap::iterator it : matches) {
+        gfx_texture_cache_release(it);
+    }
+}
+
+static void gfx_upload_texture(const uint8_t* rgba32_buf, uint32_t width, uint32_t height) {
+    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_texture_cache.last_upload_bytes = width * height * 4;
 }
 
 static void import_texture_rgba16(int tile) {
-    uint8_t rgba32_buf[480 * 240 * 4];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
     uint32_t line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes;
     //SUPPORT_CHECK(full_image_line_size_bytes == line_size_bytes);
 
-    for (uint32_t i = 0; i < size_bytes / 2; i++) {
-        uint16_t col16 = (addr[2 * i] << 8) | addr[2 * i + 1];
-        uint8_t a = col16 & 1;
-        uint8_t r = col16 >> 11;
-        uint8_t g = (col16 >> 6) & 0x1f;
-        uint8_t b = (col16 >> 1) & 0x1f;
-        rgba32_buf[4*i + 0] = SCALE_5_8(r);
-        rgba32_buf[4*i + 1] = SCALE_5_8(g);
-        rgba32_buf[4*i + 2] = SCALE_5_8(b);
-        rgba32_buf[4*i + 3] = a ? 255 : 0;
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes / 2 * 4);
+    gfx_decode_rgba16(addr, size_bytes / 2, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes / 2;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
@@ -610,152 +1010,97 @@ static void import_texture_rgba32(int tile) {
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes / 2;
     uint32_t height = (size_bytes / 2) / rdp.texture_tile[tile].line_size_bytes;
-    gfx_rapi->upload_texture(addr, width, height);
+    gfx_upload_texture(addr, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, addr, width, height);
 }
 
 static void import_texture_ia4(int tile) {
-    uint8_t rgba32_buf[32768];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
     uint32_t line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes;
     SUPPORT_CHECK(full_image_line_size_bytes == line_size_bytes);
 
-    for (uint32_t i = 0; i < size_bytes * 2; i++) {
-        uint8_t byte = addr[i / 2];
-        uint8_t part = (byte >> (4 - (i % 2) * 4)) & 0xf;
-        uint8_t intensity = part >> 1;
-        uint8_t alpha = part & 1;
-        uint8_t r = intensity;
-        uint8_t g = intensity;
-        uint8_t b = intensity;
-        rgba32_buf[4*i + 0] = SCALE_3_8(r);
-        rgba32_buf[4*i + 1] = SCALE_3_8(g);
-        rgba32_buf[4*i + 2] = SCALE_3_8(b);
-        rgba32_buf[4*i + 3] = alpha ? 255 : 0;
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes * 2 * 4);
+    gfx_decode_ia4(addr, size_bytes * 2, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes * 2;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
 static void import_texture_ia8(int tile) {
-    uint8_t rgba32_buf[16384];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
     uint32_t line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes;
     SUPPORT_CHECK(full_image_line_size_bytes == line_size_bytes);
 
-    for (uint32_t i = 0; i < size_bytes; i++) {
-        uint8_t intensity = addr[i] >> 4;
-        uint8_t alpha = addr[i] & 0xf;
-        uint8_t r = intensity;
-        uint8_t g = intensity;
-        uint8_t b = intensity;
-        rgba32_buf[4*i + 0] = SCALE_4_8(r);
-        rgba32_buf[4*i + 1] = SCALE_4_8(g);
-        rgba32_buf[4*i + 2] = SCALE_4_8(b);
-        rgba32_buf[4*i + 3] = SCALE_4_8(alpha);
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes * 4);
+    gfx_decode_ia8(addr, size_bytes, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
 static void import_texture_ia16(int tile) {
-    uint8_t rgba32_buf[8192];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
     uint32_t line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes;
     SUPPORT_CHECK(full_image_line_size_bytes == line_size_bytes);
 
-    for (uint32_t i = 0; i < size_bytes / 2; i++) {
-        uint8_t intensity = addr[2 * i];
-        uint8_t alpha = addr[2 * i + 1];
-        uint8_t r = intensity;
-        uint8_t g = intensity;
-        uint8_t b = intensity;
-        rgba32_buf[4*i + 0] = r;
-        rgba32_buf[4*i + 1] = g;
-        rgba32_buf[4*i + 2] = b;
-        rgba32_buf[4*i + 3] = alpha;
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes / 2 * 4);
+    gfx_decode_ia16(addr, size_bytes / 2, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes / 2;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
 static void import_texture_i4(int tile) {
-    uint8_t rgba32_buf[32768];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
     uint32_t line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes;
     //SUPPORT_CHECK(full_image_line_size_bytes == line_size_bytes);
 
-    for (uint32_t i = 0; i < size_bytes * 2; i++) {
-        uint8_t byte = addr[i / 2];
-        uint8_t part = (byte >> (4 - (i % 2) * 4)) & 0xf;
-        uint8_t intensity = part;
-        uint8_t r = intensity;
-        uint8_t g = intensity;
-        uint8_t b = intensity;
-        uint8_t a = intensity;
-        rgba32_buf[4*i + 0] = SCALE_4_8(r);
-        rgba32_buf[4*i + 1] = SCALE_4_8(g);
-        rgba32_buf[4*i + 2] = SCALE_4_8(b);
-        rgba32_buf[4 * i + 3] = SCALE_4_8(a);
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes * 2 * 4);
+    gfx_decode_i4(addr, size_bytes * 2, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes * 2;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
 static void import_texture_i8(int tile) {
-    uint8_t rgba32_buf[16384];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
     uint32_t line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes;
     //SUPPORT_CHECK(full_image_line_size_bytes == line_size_bytes);
 
-    for (uint32_t i = 0; i < size_bytes; i++) {
-        uint8_t intensity = addr[i];
-        uint8_t r = intensity;
-        uint8_t g = intensity;
-        uint8_t b = intensity;
-        uint8_t a = intensity;
-        rgba32_buf[4*i + 0] = r;
-        rgba32_buf[4*i + 1] = g;
-        rgba32_buf[4*i + 2] = b;
-        rgba32_buf[4 * i + 3] = a;
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes * 4);
+    gfx_decode_i8(addr, size_bytes, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
 
 static void import_texture_ci4(int tile) {
-    uint8_t rgba32_buf[32768];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
@@ -764,59 +1109,30 @@ static void import_texture_ci4(int tile) {
     const uint8_t *palette = rdp.palettes[pal_idx / 8] + (pal_idx % 8) * 16 * 2; // 16 pixel entries, 16 bits each
     SUPPORT_CHECK(full_image_line_size_bytes == line_size_bytes);
 
-    for (uint32_t i = 0; i < size_bytes * 2; i++) {
-        uint8_t byte = addr[i / 2];
-        uint8_t idx = (byte >> (4 - (i % 2) * 4)) & 0xf;
-        uint16_t col16 = (palette[idx * 2] << 8) | palette[idx * 2 + 1]; // Big endian load
-        uint8_t a = col16 & 1;
-        uint8_t r = col16 >> 11;
-        uint8_t g = (col16 >> 6) & 0x1f;
-        uint8_t b = (col16 >> 1) & 0x1f;
-        rgba32_buf[4*i + 0] = SCALE_5_8(r);
-        rgba32_buf[4*i + 1] = SCALE_5_8(g);
-        rgba32_buf[4*i + 2] = SCALE_5_8(b);
-        rgba32_buf[4*i + 3] = a ? 255 : 0;
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes * 2 * 4);
+    gfx_decode_ci4(addr, size_bytes * 2, palette, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes * 2;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
 static void import_texture_ci8(int tile) {
-    uint8_t rgba32_buf[16384];
     const uint8_t* addr = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].addr;
     uint32_t size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes;
     uint32_t full_image_line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes;
     uint32_t line_size_bytes = rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes;
+    const uint8_t* palettes[2] = { rdp.palettes[0], rdp.palettes[1] };
 
-    for (uint32_t i = 0, j = 0; i < size_bytes; j += full_image_line_size_bytes - line_size_bytes)
-    {
-        for (uint32_t k = 0; k < line_size_bytes; i++, k++, j++) {
-            uint8_t idx = addr[j];
-            uint16_t col16 = (rdp.palettes[idx / 128][(idx % 128) * 2] << 8) | rdp.palettes[idx / 128][(idx % 128) * 2 + 1]; // Big endian load
-            uint8_t a = col16 & 1;
-            uint8_t r = col16 >> 11;
-            uint8_t g = (col16 >> 6) & 0x1f;
-            uint8_t b = (col16 >> 1) & 0x1f;
-            rgba32_buf[4 * i + 0] = SCALE_5_8(r);
-            rgba32_buf[4 * i + 1] = SCALE_5_8(g);
-            rgba32_buf[4 * i + 2] = SCALE_5_8(b);
-            rgba32_buf[4 * i + 3] = a ? 255 : 0;
-        }
-    }
+    uint8_t* rgba32_buf = gfx_texture_decode_buffer(size_bytes * 4);
+    gfx_decode_ci8(addr, size_bytes, line_size_bytes, full_image_line_size_bytes, palettes, rgba32_buf);
 
     uint32_t width = rdp.texture_tile[tile].line_size_bytes;
     uint32_t height = size_bytes / rdp.texture_tile[tile].line_size_bytes;
 
-    if (size_bytes > 15000)
-    {
-        int bp = 0;
-    }
-
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(rgba32_buf, width, height);
     // DumpTexture(rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].otr_path, rgba32_buf, width, height);
 }
 
@@ -846,6 +1162,8 @@ static void import_texture(int i, int tile) {
         return;
     }
 
+    gfx_texture_cache.last_upload_bytes = 0;
+
     int t0 = get_time();
     if (fmt == G_IM_FMT_RGBA) {
         if (siz == G_IM_SIZ_16b) {
@@ -886,6 +1204,13 @@ static void import_texture(int i, int tile) {
     }
     int t1 = get_time();
     //printf("Time diff: %d\n", t1 - t0);
+
+    TextureCacheTexture& texture = gfx_texture_cache_texture(rendering_state.textures[i]->second.texture_id);
+    gfx_texture_cache.bytes += gfx_texture_cache.last_upload_bytes - texture.size_bytes;
+    texture.size_bytes = gfx_texture_cache.last_upload_bytes;
+    gfx_texture_cache.stats.uploads++;
+    gfx_texture_cache.stats.upload_bytes += texture.size_bytes;
+    gfx_texture_cache_trim();
 }
 
 static void gfx_normalize_vector(float v[3]) {
@@ -925,6 +1250,10 @@ static void gfx_matrix_mul(float res[4][4], const float a[4][4], const float b[4
 }
 
 static void gfx_sp_matrix(uint8_t parameters, const int32_t *addr) {
+    if (gfx_capture_active) {
+        gfx_capture_matrix(parameters, addr);
+    }
+
     float matrix[4][4];
 #ifndef GBI_FLOATS
     // Original GBI where fixed point matrices are used
@@ -992,150 +1321,399 @@ static void gfx_adjust_width_height_for_scale(uint32_t& width, uint32_t& height)
     }
 }
 
-static void gfx_sp_vertex(size_t n_vertices, size_t dest_index, const Vtx *vertices) {
-    for (size_t i = 0; i < n_vertices; i++, dest_index++) {
-        const Vtx_t *v = &vertices[i].v;
-        const Vtx_tn *vn = &vertices[i].n;
-        struct LoadedVertex *d = &rsp.loaded_vertices[dest_index];
+static void gfx_sp_vertex_update_lights(void) {
+    if (rsp.lights_changed) {
+        for (int i = 0; i < rsp.current_num_lights - 1; i++) {
+            calculate_normal_dir(&rsp.current_lights[i], rsp.current_lights_coeffs[i]);
+        }
+        /*static const Light_t lookat_x = {{0, 0, 0}, 0, {0, 0, 0}, 0, {127, 0, 0}, 0};
+        static const Light_t lookat_y = {{0, 0, 0}, 0, {0, 0, 0}, 0, {0, 127, 0}, 0};*/
+        calculate_normal_dir(&rsp.lookat[0], rsp.current_lookat_coeffs[0]);
+        calculate_normal_dir(&rsp.lookat[1], rsp.current_lookat_coeffs[1]);
+        rsp.lights_changed = false;
+    }
+}
 
-        if (markerOn)
-        {
-            int bp = 0;
+static void gfx_sp_vertex_texture_gen(const Vtx_tn *vn, short *U, short *V) {
+    float dotx = 0, doty = 0;
+    dotx += vn->n[0] * rsp.current_lookat_coeffs[0][0];
+    dotx += vn->n[1] * rsp.current_lookat_coeffs[0][1];
+    dotx += vn->n[2] * rsp.current_lookat_coeffs[0][2];
+    doty += vn->n[0] * rsp.current_lookat_coeffs[1][0];
+    doty += vn->n[1] * rsp.current_lookat_coeffs[1][1];
+    doty += vn->n[2] * rsp.current_lookat_coeffs[1][2];
+
+
+    dotx /= 127.0f;
+    doty /= 127.0f;
+
+    if (dotx < -1.0f) dotx = -1.0f;
+    if (dotx > 1.0f) dotx = 1.0f;
+    if (doty < -1.0f) doty = -1.0f;
+    if (doty > 1.0f) doty = 1.0f;
+
+    if (rsp.geometry_mode & G_TEXTURE_GEN_LINEAR) {
+                        // Not sure exactly what formula we should use to get accurate values
+                        /*dotx = (2.906921f * dotx * dotx + 1.36114f) * dotx;
+                        doty = (2.906921f * doty * doty + 1.36114f) * doty;
+                        dotx = (dotx + 1.0f) / 4.0f;
+                        doty = (doty + 1.0f) / 4.0f;*/
+    dotx = acosf(-dotx) /*/ (3.14159265f)*/ / 4.0f;
+    doty = acosf(-doty) /*/ (3.14159265f)*/ / 4.0f;
+    }
+    else {
+        dotx = (dotx + 1.0f) / 4.0f;
+        doty = (doty + 1.0f) / 4.0f;
+    }
+
+    *U = (int32_t)(dotx * rsp.texture_scaling_factor.s);
+    *V = (int32_t)(doty * rsp.texture_scaling_factor.t);
+}
+
+static void gfx_sp_vertex_one(const Vtx *vertex, struct LoadedVertex *d) {
+    const Vtx_t *v = &vertex->v;
+    const Vtx_tn *vn = &vertex->n;
+
+    float x = v->ob[0] * rsp.MP_matrix[0][0] + v->ob[1] * rsp.MP_matrix[1][0] + v->ob[2] * rsp.MP_matrix[2][0] + rsp.MP_matrix[3][0];
+    float y = v->ob[0] * rsp.MP_matrix[0][1] + v->ob[1] * rsp.MP_matrix[1][1] + v->ob[2] * rsp.MP_matrix[2][1] + rsp.MP_matrix[3][1];
+    float z = v->ob[0] * rsp.MP_matrix[0][2] + v->ob[1] * rsp.MP_matrix[1][2] + v->ob[2] * rsp.MP_matrix[2][2] + rsp.MP_matrix[3][2];
+    float w = v->ob[0] * rsp.MP_matrix[0][3] + v->ob[1] * rsp.MP_matrix[1][3] + v->ob[2] * rsp.MP_matrix[2][3] + rsp.MP_matrix[3][3];
+
+    x = gfx_adjust_x_for_aspect_ratio(x);
+
+    short U = v->tc[0] * rsp.texture_scaling_factor.s >> 16;
+    short V = v->tc[1] * rsp.texture_scaling_factor.t >> 16;
+
+    if (rsp.geometry_mode & G_LIGHTING) {
+        int r = rsp.current_lights[rsp.current_num_lights - 1].col[0];
+        int g = rsp.current_lights[rsp.current_num_lights - 1].col[1];
+        int b = rsp.current_lights[rsp.current_num_lights - 1].col[2];
+
+        for (int i = 0; i < rsp.current_num_lights - 1; i++) {
+            float intensity = 0;
+            intensity += vn->n[0] * rsp.current_lights_coeffs[i][0];
+            intensity += vn->n[1] * rsp.current_lights_coeffs[i][1];
+            intensity += vn->n[2] * rsp.current_lights_coeffs[i][2];
+            intensity /= 127.0f;
+            if (intensity > 0.0f) {
+                r += intensity * rsp.current_lights[i].col[0];
+                g += intensity * rsp.current_lights[i].col[1];
+                b += intensity * rsp.current_lights[i].col[2];
+            }
         }
 
-        if ((uintptr_t)vertices == 0x14913ec0)
-        {
-            int bp = 0;
+        d->color.r = r > 255 ? 255 : r;
+        d->color.g = g > 255 ? 255 : g;
+        d->color.b = b > 255 ? 255 : b;
+
+        if (rsp.geometry_mode & G_TEXTURE_GEN) {
+            gfx_sp_vertex_texture_gen(vn, &U, &V);
+        }
+    } else {
+        d->color.r = v->cn[0];
+        d->color.g = v->cn[1];
+        d->color.b = v->cn[2];
+    }
+
+    d->u = U;
+    d->v = V;
+
+    // trivial clip rejection
+    d->clip_rej = 0;
+    if (x < -w) d->clip_rej |= 1;
+    if (x > w) d->clip_rej |= 2;
+    if (y < -w) d->clip_rej |= 4;
+    if (y > w) d->clip_rej |= 8;
+    //if (z < -w) d->clip_rej |= 16;
+    if (z > w) d->clip_rej |= 32;
+
+    d->x = x;
+    d->y = y;
+    d->z = z;
+    d->w = w;
+
+    if (rsp.geometry_mode & G_FOG) {
+        if (fabsf(w) < 0.001f) {
+            // To avoid division by zero
+            w = 0.001f;
         }
 
-        if (v == NULL)
-            return;
+        float winv = 1.0f / w;
+        if (winv < 0.0f) {
+            winv = 32767.0f;
+        }
 
-        float x = v->ob[0] * rsp.MP_matrix[0][0] + v->ob[1] * rsp.MP_matrix[1][0] + v->ob[2] * rsp.MP_matrix[2][0] + rsp.MP_matrix[3][0];
-        float y = v->ob[0] * rsp.MP_matrix[0][1] + v->ob[1] * rsp.MP_matrix[1][1] + v->ob[2] * rsp.MP_matrix[2][1] + rsp.MP_matrix[3][1];
-        float z = v->ob[0] * rsp.MP_matrix[0][2] + v->ob[1] * rsp.MP_matrix[1][2] + v->ob[2] * rsp.MP_matrix[2][2] + rsp.MP_matrix[3][2];
-        float w = v->ob[0] * rsp.MP_matrix[0][3] + v->ob[1] * rsp.MP_matrix[1][3] + v->ob[2] * rsp.MP_matrix[2][3] + rsp.MP_matrix[3][3];
+        float fog_z = z * winv * rsp.fog_mul + rsp.fog_offset;
+        if (fog_z < 0) fog_z = 0;
+        if (fog_z > 255) fog_z = 255;
+        d->color.a = fog_z; // Use alpha variable to store fog factor
+    } else {
+        d->color.a = v->cn[3];
+    }
+}
 
-        if (markerOn)
-        {
-            int bp = 0;
+#ifdef GFX_SSE2
+static inline __m128 gfx_sse_select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128i gfx_sse_select_epi32(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Four vertices at a time in SoA form. Every value goes through the same float operations, in the same order, as in gfx_sp_vertex_one,
+// so the results are bit identical. Only texture generation, which needs acosf, stays per vertex.
+static void gfx_sp_vertex_x4(const Vtx *vertices, struct LoadedVertex *d) {
+    const __m128 ob_x = _mm_setr_ps(vertices[0].v.ob[0], vertices[1].v.ob[0], vertices[2].v.ob[0], vertices[3].v.ob[0]);
+    const __m128 ob_y = _mm_setr_ps(vertices[0].v.ob[1], vertices[1].v.ob[1], vertices[2].v.ob[1], vertices[3].v.ob[1]);
+    const __m128 ob_z = _mm_setr_ps(vertices[0].v.ob[2], vertices[1].v.ob[2], vertices[2].v.ob[2], vertices[3].v.ob[2]);
+    __m128 pos[4];
+
+    for (int c = 0; c < 4; c++) {
+        pos[c] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ob_x, _mm_set1_ps(rsp.MP_matrix[0][c])), _mm_mul_ps(ob_y, _mm_set1_ps(rsp.MP_matrix[1][c]))),
+                                       _mm_mul_ps(ob_z, _mm_set1_ps(rsp.MP_matrix[2][c]))),
+                            _mm_set1_ps(rsp.MP_matrix[3][c]));
+    }
+
+    __m128 x = pos[0], y = pos[1], z = pos[2], w = pos[3];
+
+    if (!fbActive) {
+        x = _mm_div_ps(_mm_mul_ps(x, _mm_set1_ps(4.0f / 3.0f)), _mm_set1_ps((float)gfx_current_dimensions.width / (float)gfx_current_dimensions.height));
+    }
+
+    const __m128 neg_w = _mm_xor_ps(w, _mm_set1_ps(-0.0f));
+    const int clip_left = _mm_movemask_ps(_mm_cmplt_ps(x, neg_w));
+    const int clip_right = _mm_movemask_ps(_mm_cmpgt_ps(x, w));
+    const int clip_bottom = _mm_movemask_ps(_mm_cmplt_ps(y, neg_w));
+    const int clip_top = _mm_movemask_ps(_mm_cmpgt_ps(y, w));
+    const int clip_far = _mm_movemask_ps(_mm_cmpgt_ps(z, w));
+
+    float xs[4], ys[4], zs[4], ws[4];
+    _mm_storeu_ps(xs, x);
+    _mm_storeu_ps(ys, y);
+    _mm_storeu_ps(zs, z);
+    _mm_storeu_ps(ws, w);
+
+    int32_t fog[4];
+    if (rsp.geometry_mode & G_FOG) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 tiny = _mm_set1_ps(0.001f);
+        __m128 fog_w = gfx_sse_select(_mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), w), tiny), tiny, w);
+        __m128 winv = _mm_div_ps(_mm_set1_ps(1.0f), fog_w);
+        winv = gfx_sse_select(_mm_cmplt_ps(winv, zero), _mm_set1_ps(32767.0f), winv);
+
+        __m128 fog_z = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(z, winv), _mm_set1_ps(rsp.fog_mul)), _mm_set1_ps(rsp.fog_offset));
+        fog_z = gfx_sse_select(_mm_cmplt_ps(fog_z, zero), zero, fog_z);
+        fog_z = gfx_sse_select(_mm_cmpgt_ps(fog_z, _mm_set1_ps(255.0f)), _mm_set1_ps(255.0f), fog_z);
+        _mm_storeu_si128((__m128i*)fog, _mm_cvttps_epi32(fog_z));
+    }
+
+    int32_t rgb[3][4];
+    if (rsp.geometry_mode & G_LIGHTING) {
+        const __m128 n_x = _mm_setr_ps(vertices[0].n.n[0], vertices[1].n.n[0], vertices[2].n.n[0], vertices[3].n.n[0]);
+        const __m128 n_y = _mm_setr_ps(vertices[0].n.n[1], vertices[1].n.n[1], vertices[2].n.n[1], vertices[3].n.n[1]);
+        const __m128 n_z = _mm_setr_ps(vertices[0].n.n[2], vertices[1].n.n[2], vertices[2].n.n[2], vertices[3].n.n[2]);
+        const Light_t *ambient = &rsp.current_lights[rsp.current_num_lights - 1];
+        __m128i col[3];
+
+        for (int c = 0; c < 3; c++) {
+            col[c] = _mm_set1_epi32(ambient->col[c]);
+        }
+
+        for (int i = 0; i < rsp.current_num_lights - 1; i++) {
+            __m128 intensity = _mm_setzero_ps();
+            intensity = _mm_add_ps(intensity, _mm_mul_ps(n_x, _mm_set1_ps(rsp.current_lights_coeffs[i][0])));
+            intensity = _mm_add_ps(intensity, _mm_mul_ps(n_y, _mm_set1_ps(rsp.current_lights_coeffs[i][1])));
+            intensity = _mm_add_ps(intensity, _mm_mul_ps(n_z, _mm_set1_ps(rsp.current_lights_coeffs[i][2])));
+            intensity = _mm_div_ps(intensity, _mm_set1_ps(127.0f));
+
+            const __m128i lit = _mm_castps_si128(_mm_cmpgt_ps(intensity, _mm_setzero_ps()));
+
+            // The scalar path accumulates into an int, so every light truncates the sum again.
+            for (int c = 0; c < 3; c++) {
+                __m128 sum = _mm_add_ps(_mm_cvtepi32_ps(col[c]), _mm_mul_ps(intensity, _mm_set1_ps(rsp.current_lights[i].col[c])));
+                col[c] = gfx_sse_select_epi32(lit, _mm_cvttps_epi32(sum), col[c]);
+            }
+        }
+
+        for (int c = 0; c < 3; c++) {
+            const __m128i max = _mm_set1_epi32(255);
+            col[c] = gfx_sse_select_epi32(_mm_cmpgt_epi32(col[c], max), max, col[c]);
+            _mm_storeu_si128((__m128i*)rgb[c], col[c]);
         }
+    }
 
-        x = gfx_adjust_x_for_aspect_ratio(x);
+    for (int k = 0; k < 4; k++) {
+        const Vtx_t *v = &vertices[k].v;
 
         short U = v->tc[0] * rsp.texture_scaling_factor.s >> 16;
         short V = v->tc[1] * rsp.texture_scaling_factor.t >> 16;
 
         if (rsp.geometry_mode & G_LIGHTING) {
-            if (rsp.lights_changed) {
-                for (int i = 0; i < rsp.current_num_lights - 1; i++) {
-                    calculate_normal_dir(&rsp.current_lights[i], rsp.current_lights_coeffs[i]);
-                }
-                /*static const Light_t lookat_x = {{0, 0, 0}, 0, {0, 0, 0}, 0, {127, 0, 0}, 0};
-                static const Light_t lookat_y = {{0, 0, 0}, 0, {0, 0, 0}, 0, {0, 127, 0}, 0};*/
-                calculate_normal_dir(&rsp.lookat[0], rsp.current_lookat_coeffs[0]);
-                calculate_normal_dir(&rsp.lookat[1], rsp.current_lookat_coeffs[1]);
-                rsp.lights_changed = false;
+            d[k].color.r = rgb[0][k];
+            d[k].color.g = rgb[1][k];
+            d[k].color.b = rgb[2][k];
+
+            if (rsp.geometry_mode & G_TEXTURE_GEN) {
+                gfx_sp_vertex_texture_gen(&vertices[k].n, &U, &V);
             }
+        } else {
+            d[k].color.r = v->cn[0];
+            d[k].color.g = v->cn[1];
+            d[k].color.b = v->cn[2];
+        }
+
+        d[k].u = U;
+        d[k].v = V;
+
+        d[k].clip_rej = ((clip_left >> k) & 1) | (((clip_right >> k) & 1) << 1) | (((clip_bottom >> k) & 1) << 2) |
+                        (((clip_top >> k) & 1) << 3) | (((clip_far >> k) & 1) << 5);
 
-            int r = rsp.current_lights[rsp.current_num_lights - 1].col[0];
-            int g = rsp.current_lights[rsp.current_num_lights - 1].col[1];
-            int b = rsp.current_lights[rsp.current_num_lights - 1].col[2];
-
-            for (int i = 0; i < rsp.current_num_lights - 1; i++) {
-                float intensity = 0;
-                intensity += vn->n[0] * rsp.current_lights_coeffs[i][0];
-                intensity += vn->n[1] * rsp.current_lights_coeffs[i][1];
-                intensity += vn->n[2] * rsp.current_lights_coeffs[i][2];
-                intensity /= 127.0f;
-                if (intensity > 0.0f) {
-                    r += intensity * rsp.current_lights[i].col[0];
-                    g += intensity * rsp.current_lights[i].col[1];
-                    b += intensity * rsp.current_lights[i].col[2];
+        d[k].x = xs[k];
+        d[k].y = ys[k];
+        d[k].z = zs[k];
+        d[k].w = ws[k];
+
+        d[k].color.a = (rsp.geometry_mode & G_FOG) ? fog[k] : v->cn[3];
+    }
+}
+#endif
+
+static std::atomic<bool> vertex_check_live;
+static std::atomic<uint32_t> vertex_check_live_vertices;
+static std::atomic<uint32_t> vertex_check_live_mismatches;
+
+#ifdef GFX_SSE2
+// Padding is left out, LoadedVertex copies are never zeroed.
+static bool gfx_loaded_vertex_equal(const struct LoadedVertex *a, const struct LoadedVertex *b) {
+    return memcmp(&a->x, &b->x, sizeof(float) * 6) == 0 && memcmp(&a->color, &b->color, sizeof(a->color)) == 0 && a->clip_rej == b->clip_rej;
+}
+#endif
+
+static void gfx_sp_vertex(size_t n_vertices, size_t dest_index, const Vtx *vertices) {
+    if (vertices == NULL)
+        return;
+
+    if (gfx_capture_active) {
+        gfx_capture_vertex(n_vertices, dest_index, vertices);
+    }
+
+    if (rsp.geometry_mode & G_LIGHTING) {
+        gfx_sp_vertex_update_lights();
+    }
+
+    size_t i = 0;
+
+#ifdef GFX_SSE2
+    for (; i + 4 <= n_vertices; i += 4) {
+        gfx_sp_vertex_x4(&vertices[i], &rsp.loaded_vertices[dest_index + i]);
+
+        if (vertex_check_live.load(std::memory_order_relaxed)) {
+            for (size_t k = 0; k < 4; k++) {
+                struct LoadedVertex expected;
+                gfx_sp_vertex_one(&vertices[i + k], &expected);
+                vertex_check_live_vertices.fetch_add(1, std::memory_order_relaxed);
+                if (!gfx_loaded_vertex_equal(&expected, &rsp.loaded_vertices[dest_index + i + k])) {
+                    vertex_check_live_mismatches.fetch_add(1, std::memory_order_relaxed);
                 }
             }
+        }
+    }
+#endif
 
-            d->color.r = r > 255 ? 255 : r;
-            d->color.g = g > 255 ? 255 : g;
-            d->color.b = b > 255 ? 255 : b;
+    for (; i < n_vertices; i++) {
+        gfx_sp_vertex_one(&vertices[i], &rsp.loaded_vertices[dest_index + i]);
+    }
+}
 
-            if (rsp.geometry_mode & G_TEXTURE_GEN) {
-                float dotx = 0, doty = 0;
-                dotx += vn->n[0] * rsp.current_lookat_coeffs[0][0];
-                dotx += vn->n[1] * rsp.current_lookat_coeffs[0][1];
-                dotx += vn->n[2] * rsp.current_lookat_coeffs[0][2];
-                doty += vn->n[0] * rsp.current_lookat_coeffs[1][0];
-                doty += vn->n[1] * rsp.current_lookat_coeffs[1][1];
-                doty += vn->n[2] * rsp.current_lookat_coeffs[1][2];
-
-
-                dotx /= 127.0f;
-                doty /= 127.0f;
-
-                if (dotx < -1.0f) dotx = -1.0f;
-                if (dotx > 1.0f) dotx = 1.0f;
-                if (doty < -1.0f) doty = -1.0f;
-                if (doty > 1.0f) doty = 1.0f;
-
-                if (rsp.geometry_mode & G_TEXTURE_GEN_LINEAR) {
-                                    // Not sure exactly what formula we should use to get accurate values
-                                    /*dotx = (2.906921f * dotx * dotx + 1.36114f) * dotx;
-                                    doty = (2.906921f * doty * doty + 1.36114f) * doty;
-                                    dotx = (dotx + 1.0f) / 4.0f;
-                                    doty = (doty + 1.0f) / 4.0f;*/
-                dotx = acosf(-dotx) /*/ (3.14159265f)*/ / 4.0f;
-                doty = acosf(-doty) /*/ (3.14159265f)*/ / 4.0f;
-                }
-                else {
-                    dotx = (dotx + 1.0f) / 4.0f;
-                    doty = (doty + 1.0f) / 4.0f;
-                }
+struct GfxVertexCheckResult gfx_vertex_check_random(uint32_t vertices) {
+    struct GfxVertexCheckResult result = {};
+#ifdef GFX_SSE2
+    static const uint32_t modes[] = { 0, G_FOG, G_LIGHTING, G_LIGHTING | G_FOG, G_LIGHTING | G_TEXTURE_GEN,
+                                     G_LIGHTING | G_TEXTURE_GEN | G_TEXTURE_GEN_LINEAR, G_LIGHTING | G_TEXTURE_GEN | G_FOG };
+    std::vector<Vtx> input((vertices + 3) & ~3u);
+    std::vector<struct LoadedVertex> expected(input.size());
+    std::vector<struct LoadedVertex> actual(input.size());
+    std::mt19937 rng(12345);
 
-                U = (int32_t)(dotx * rsp.texture_scaling_factor.s);
-                V = (int32_t)(doty * rsp.texture_scaling_factor.t);
-            }
-        } else {
-            d->color.r = v->cn[0];
-            d->color.g = v->cn[1];
-            d->color.b = v->cn[2];
-        }
-
-        d->u = U;
-        d->v = V;
-
-        // trivial clip rejection
-        d->clip_rej = 0;
-        if (x < -w) d->clip_rej |= 1;
-        if (x > w) d->clip_rej |= 2;
-        if (y < -w) d->clip_rej |= 4;
-        if (y > w) d->clip_rej |= 8;
-        //if (z < -w) d->clip_rej |= 16;
-        if (z > w) d->clip_rej |= 32;
-
-        d->x = x;
-        d->y = y;
-        d->z = z;
-        d->w = w;
-
-        if (rsp.geometry_mode & G_FOG) {
-            if (fabsf(w) < 0.001f) {
-                // To avoid division by zero
-                w = 0.001f;
-            }
+    // This runs between frames on the thread that runs gfx_run, so borrowing the RSP state is safe as long as it is put back.
+    auto saved = std::make_unique<struct RSP>(rsp);
+
+    for (auto& vtx : input) {
+        for (size_t b = 0; b < sizeof(vtx); b++) {
+            ((uint8_t*)&vtx)[b] = (uint8_t)rng();
+        }
+    }
+
+    std::uniform_real_distribution<float> element(-2.0f, 2.0f);
 
-            float winv = 1.0f / w;
-            if (winv < 0.0f) {
-                winv = 32767.0f;
+    for (uint32_t mode : modes) {
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) {
+                rsp.MP_matrix[r][c] = element(rng);
+                rsp.modelview_matrix_stack[0][r][c] = element(rng);
             }
+        }
 
-            float fog_z = z * winv * rsp.fog_mul + rsp.fog_offset;
-            if (fog_z < 0) fog_z = 0;
-            if (fog_z > 255) fog_z = 255;
-            d->color.a = fog_z; // Use alpha variable to store fog factor
-        } else {
-            d->color.a = v->cn[3];
+        rsp.modelview_matrix_stack_size = 1;
+        rsp.geometry_mode = mode;
+        rsp.fog_mul = (int16_t)rng();
+        rsp.fog_offset = (int16_t)rng();
+        rsp.texture_scaling_factor.s = (uint16_t)rng();
+        rsp.texture_scaling_factor.t = (uint16_t)rng();
+        rsp.current_num_lights = 1 + rng() % (MAX_LIGHTS + 1);
+
+        for (size_t b = 0; b < sizeof(rsp.current_lights); b++) {
+            ((uint8_t*)rsp.current_lights)[b] = (uint8_t)rng();
+        }
+        for (size_t b = 0; b < sizeof(rsp.lookat); b++) {
+            ((uint8_t*)rsp.lookat)[b] = (uint8_t)rng();
+        }
+
+        rsp.lights_changed = true;
+        gfx_sp_vertex_update_lights();
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < input.size(); i++) {
+            gfx_sp_vertex_one(&input[i], &expected[i]);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < input.size(); i += 4) {
+            gfx_sp_vertex_x4(&input[i], &actual[i]);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        result.scalar_ms += std::chrono::duration<double, std::milli>(middle - start).count();
+        result.simd_ms += std::chrono::duration<double, std::milli>(end - middle).count();
+
+        for (size_t i = 0; i < input.size(); i++) {
+            result.vertices++;
+            if (!gfx_loaded_vertex_equal(&expected[i], &actual[i])) {
+                result.mismatches++;
+            }
         }
     }
+
+    rsp = *saved;
+    result.simd = true;
+#endif
+    return result;
+}
+
+void gfx_vertex_check_live(bool enabled) {
+    vertex_check_live_vertices = 0;
+    vertex_check_live_mismatches = 0;
+    vertex_check_live = enabled;
+}
+
+struct GfxVertexCheckResult gfx_vertex_check_live_results(void) {
+    struct GfxVertexCheckResult result = {};
+#ifdef GFX_SSE2
+    result.vertices = vertex_check_live_vertices;
+    result.mismatches = vertex_check_live_mismatches;
+    result.simd = true;
+#endif
+    return result;
 }
 
 static void gfx_sp_modify_vertex(uint16_t vtx_idx, uint8_t where, uint32_t val) {
@@ -1191,29 +1769,25 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx, bo
     bool depth_test = (rsp.geometry_mode & G_ZBUFFER) == G_ZBUFFER;
     bool depth_mask = (rdp.other_mode_l & Z_UPD) == Z_UPD;
     uint8_t depth_test_and_mask = (depth_test ? 1 : 0) | (depth_mask ? 2 : 0);
-    if (depth_test_and_mask != rendering_state.depth_test_and_mask) {
-        gfx_flush();
-        gfx_rapi->set_depth_test_and_mask(depth_test, depth_mask);
-        rendering_state.depth_test_and_mask = depth_test_and_mask;
+    if (depth_test_and_mask != rendering_state.draw.depth_test_and_mask) {
+        gfx_end_batch();
+        rendering_state.draw.depth_test_and_mask = depth_test_and_mask;
     }
 
     bool zmode_decal = (rdp.other_mode_l & ZMODE_DEC) == ZMODE_DEC;
-    if (zmode_decal != rendering_state.decal_mode) {
-        gfx_flush();
-        gfx_rapi->set_zmode_decal(zmode_decal);
-        rendering_state.decal_mode = zmode_decal;
+    if (zmode_decal != rendering_state.draw.decal_mode) {
+        gfx_end_batch();
+        rendering_state.draw.decal_mode = zmode_decal;
     }
 
     if (rdp.viewport_or_scissor_changed) {
-        if (memcmp(&rdp.viewport, &rendering_state.viewport, sizeof(rdp.viewport)) != 0) {
-            gfx_flush();
-            gfx_rapi->set_viewport(rdp.viewport.x, rdp.viewport.y, rdp.viewport.width, rdp.viewport.height);
-            rendering_state.viewport = rdp.viewport;
+        if (memcmp(&rdp.viewport, &rendering_state.draw.viewport, sizeof(rdp.viewport)) != 0) {
+            gfx_end_batch();
+            rendering_state.draw.viewport = rdp.viewport;
         }
-        if (memcmp(&rdp.scissor, &rendering_state.scissor, sizeof(rdp.scissor)) != 0) {
-            gfx_flush();
-            gfx_rapi->set_scissor(rdp.scissor.x, rdp.scissor.y, rdp.scissor.width, rdp.scissor.height);
-            rendering_state.scissor = rdp.scissor;
+        if (memcmp(&rdp.scissor, &rendering_state.draw.scissor, sizeof(rdp.scissor)) != 0) {
+            gfx_end_batch();
+            rendering_state.draw.scissor = rdp.scissor;
         }
         rdp.viewport_or_scissor_changed = false;
     }
@@ -1254,9 +1828,11 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx, bo
         uint32_t tile = rdp.first_tile_index + i;
         if (comb->used_textures[i]) {
             if (rdp.textures_changed[i]) {
-                gfx_flush();
                 import_texture(i, tile);
                 rdp.textures_changed[i] = false;
+                if (i == 0) {
+                    rendering_state.framebuffer_texture = DRAW_NO_TEXTURE;
+                }
             }
 
             uint8_t cms = rdp.texture_tile[tile].cms;
@@ -1301,13 +1877,22 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx, bo
             }
 
             bool linear_filter = (rdp.other_mode_h & (3U << G_MDSFT_TEXTFILT)) != G_TF_POINT;
-            if (linear_filter != rendering_state.textures[i]->second.linear_filter || cms != rendering_state.textures[i]->second.cms || cmt != rendering_state.textures[i]->second.cmt) {
-                gfx_flush();
-                gfx_rapi->set_sampler_parameters(i, linear_filter, cms, cmt);
-                rendering_state.textures[i]->second.linear_filter = linear_filter;
-                rendering_state.textures[i]->second.cms = cms;
-                rendering_state.textures[i]->second.cmt = cmt;
+            uint8_t sampler = (linear_filter ? 1 : 0) | (cms << 1) | (cmt << 3);
+            uint32_t texture_id = DRAW_NO_TEXTURE;
+            if (i == 0 && rendering_state.framebuffer_texture != DRAW_NO_TEXTURE) {
+                texture_id = rendering_state.framebuffer_texture;
+            } else if (rendering_state.textures[i] != nullptr) {
+                texture_id = rendering_state.textures[i]->second.texture_id;
+            }
+            if (texture_id != rendering_state.draw.texture_ids[i] || sampler != rendering_state.draw.samplers[i]) {
+                gfx_end_batch();
+                rendering_state.draw.texture_ids[i] = texture_id;
+                rendering_state.draw.samplers[i] = sampler;
             }
+        } else if (rendering_state.draw.texture_ids[i] != DRAW_NO_TEXTURE) {
+            gfx_end_batch();
+            rendering_state.draw.texture_ids[i] = DRAW_NO_TEXTURE;
+            rendering_state.draw.samplers[i] = 0;
         }
     }
 
@@ -1315,16 +1900,13 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx, bo
     if (prg == NULL) {
         comb->prg[tm] = prg = gfx_lookup_or_create_shader_program(comb->shader_id0, comb->shader_id1 | (tm * SHADER_OPT_TEXEL0_CLAMP_S));
     }
-    if (prg != rendering_state.shader_program) {
-        gfx_flush();
-        gfx_rapi->unload_shader(rendering_state.shader_program);
-        gfx_rapi->load_shader(prg);
-        rendering_state.shader_program = prg;
+    if (prg != rendering_state.draw.shader_program) {
+        gfx_end_batch();
+        rendering_state.draw.shader_program = prg;
     }
-    if (use_alpha != rendering_state.alpha_blend) {
-        gfx_flush();
-        gfx_rapi->set_use_alpha(use_alpha);
-        rendering_state.alpha_blend = use_alpha;
+    if (use_alpha != rendering_state.draw.alpha_blend) {
+        gfx_end_batch();
+        rendering_state.draw.alpha_blend = use_alpha;
     }
     uint8_t num_inputs;
     bool used_textures[2];
@@ -1338,6 +1920,10 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx, bo
 
     struct GfxClipParameters clip_parameters = gfx_rapi->get_clip_parameters();
 
+    if (buf_vbo.size() < buf_vbo_len + 3 * 32) {
+        buf_vbo.resize(buf_vbo_len + 3 * 32);
+    }
+
     for (int i = 0; i < 3; i++) {
         float z = v_arr[i]->z, w = v_arr[i]->w;
         if (clip_parameters.z_is_from_0_to_1) {
@@ -1486,12 +2072,10 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx, bo
         //buf_vbo[buf_vbo_len++] = color->a / 255.0f;
     }
 
-    if (++buf_vbo_num_tris == MAX_BUFFERED) {
-        //if (++buf_vbo_num_tris == 1) {
-        if (markerOn)
-        {
-            int bp = 0;
-        }
+    if (++buf_vbo_num_tris == GFX_MAX_DRAW_TRIANGLES) {
+        gfx_end_batch();
+    }
+    if (buf_vbo_len >= MAX_QUEUED_FLOATS) {
         gfx_flush();
     }
 }
@@ -1540,6 +2124,10 @@ static void gfx_calc_and_set_viewport(const Vp_t *viewport) {
 }
 
 static void gfx_sp_movemem(uint8_t index, uint8_t offset, const void* data) {
+    if (gfx_capture_active) {
+        gfx_capture_movemem(index, offset, data);
+    }
+
     switch (index) {
         case G_MV_VIEWPORT:
             gfx_calc_and_set_viewport((const Vp_t *) data);
@@ -1624,6 +2212,10 @@ static void gfx_dp_set_scissor(uint32_t mode, uint32_t ulx, uint32_t uly, uint32
 }
 
 static void gfx_dp_set_texture_image(uint32_t format, uint32_t size, uint32_t width, const void* addr, char* otr_path) {
+    if (gfx_capture_active) {
+        gfx_capture_texture_image(format, size, width, addr);
+    }
+
     rdp.texture_to_load.addr = (const uint8_t*)addr;
     rdp.texture_to_load.siz = size;
     rdp.texture_to_load.width = width;
@@ -1678,6 +2270,10 @@ static void gfx_dp_load_tlut(uint8_t tile, uint32_t high_index) {
 
     SUPPORT_CHECK((rdp.texture_tile[tile].tmem == 256 && (high_index <= 127 || high_index == 255)) || (rdp.texture_tile[tile].tmem == 384 && high_index == 127));
 
+    if (gfx_capture_active) {
+        gfx_capture_texture_load((high_index + 1) * 2);
+    }
+
     if (rdp.texture_tile[tile].tmem == 256) {
         rdp.palettes[0] = rdp.texture_to_load.addr;
         if (high_index == 255) {
@@ -1715,6 +2311,9 @@ static void gfx_dp_load_block(uint8_t tile, uint32_t uls, uint32_t ult, uint32_t
             break;
     }
     uint32_t size_bytes = (lrs + 1) << word_size_shift;
+    if (gfx_capture_active) {
+        gfx_capture_texture_load(size_bytes);
+    }
     rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes = size_bytes;
     rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes = size_bytes;
     rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes = size_bytes;
@@ -1747,6 +2346,9 @@ static void gfx_dp_load_tile(uint8_t tile, uint32_t uls, uint32_t ult, uint32_t
     uint32_t full_image_line_size_bytes = (rdp.texture_to_load.width + 1) << word_size_shift;
     uint32_t line_size_bytes = (((lrs - uls) >> G_TEXTURE_IMAGE_FRAC) + 1) << word_size_shift;
     uint32_t start_offset = full_image_line_size_bytes * (ult >> G_TEXTURE_IMAGE_FRAC) + ((uls >> G_TEXTURE_IMAGE_FRAC) << word_size_shift);
+    if (gfx_capture_active) {
+        gfx_capture_texture_load(start_offset + full_image_line_size_bytes * ((lrt - ult) >> G_TEXTURE_IMAGE_FRAC) + line_size_bytes);
+    }
     rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].size_bytes = size_bytes;
     rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].full_image_line_size_bytes = full_image_line_size_bytes;
     rdp.loaded_texture[rdp.texture_tile[tile].tmem_index].line_size_bytes = line_size_bytes;
@@ -2091,6 +2693,39 @@ extern "C"
     uintptr_t jsjutanShadowTex = 0;
 };
 
+// Rewrites an instruction of the display list dListHash, the Resource targetHash puts it back when it is evicted or replaced.
+// Display lists that weren't entered through a G_MARKER can't be restored, so they are left alone.
+static bool gfx_patch_instruction(Gfx* instr, const Gfx* dListStart, uint64_t dListHash, uint64_t targetHash, Gfx patched) {
+    if (dListHash == (uint64_t)-1) {
+        return false;
+    }
+
+    uint64_t origData;
+    memcpy(&origData, instr, sizeof(origData));
+    ResourceMgr_RegisterResourcePatch(dListHash, instr - dListStart, origData, targetHash);
+    *instr = patched;
+    return true;
+}
+
+// Turns a 128-bit OTR command into its resolved form, the second word then holds addr instead of the hash.
+static void gfx_resolve_otr(Gfx* cmd, const Gfx* dListStart, uint64_t dListHash, uint64_t hash, uint8_t resolvedOpcode, const void* addr) {
+    Gfx second = cmd[1];
+    memcpy(&second, &addr, sizeof(addr));
+
+    Gfx first = cmd[0];
+    first.words.w0 = (first.words.w0 & 0x00FFFFFF) | ((uint32_t)resolvedOpcode << 24);
+
+    if (gfx_patch_instruction(&cmd[1], dListStart, dListHash, hash, second)) {
+        gfx_patch_instruction(&cmd[0], dListStart, dListHash, hash, first);
+    }
+}
+
+static void* gfx_resolved_addr(const Gfx* cmd) {
+    void* addr;
+    memcpy(&addr, &cmd[1], sizeof(addr));
+    return addr;
+}
+
 static void gfx_run_dl(Gfx* cmd) {
     //puts("dl");
     int dummy = 0;
@@ -2101,6 +2736,7 @@ static void gfx_run_dl(Gfx* cmd) {
     uint64_t ourHash = -1;
 
     for (;;) {
+        Gfx* cmdStart = cmd;
         uint32_t opcode = cmd->words.w0 >> 24;
         //uint32_t opcode = cmd->words.w0 & 0xFF;
 
@@ -2112,6 +2748,8 @@ static void gfx_run_dl(Gfx* cmd) {
             // RSP commands:
         case G_MARKER:
         {
+            // Patch indices are relative to the marker, which also starts a list reached through a branch.
+            dListStart = cmd;
             cmd++;
 
             ourHash = ((uint64_t)cmd->words.w0 << 32) + cmd->words.w1;
@@ -2177,6 +2815,7 @@ static void gfx_run_dl(Gfx* cmd) {
                 if (mtx != NULL)
                 {
                     cmd--;
+                    gfx_resolve_otr(cmd, dListStart, ourHash, hash, G_MTX_OTR_RESOLVED, mtx);
                     gfx_sp_matrix(C0(0, 8) ^ G_MTX_PUSH, mtx);
                     cmd++;
                 }
@@ -2185,6 +2824,12 @@ static void gfx_run_dl(Gfx* cmd) {
 #endif
                 break;
             }
+#ifdef F3DEX_GBI_2
+            case G_MTX_OTR_RESOLVED:
+                gfx_sp_matrix(C0(0, 8) ^ G_MTX_PUSH, (const int32_t*)gfx_resolved_addr(cmd));
+                cmd++;
+                break;
+#endif
             case (uint8_t)G_POPMTX:
 #ifdef F3DEX_GBI_2
                 gfx_sp_pop_matrix(cmd->words.w1 / 64);
@@ -2250,10 +2895,9 @@ static void gfx_run_dl(Gfx* cmd) {
 
                         cmd--;
 
-                        if (ourHash != -1)
-                            ResourceMgr_RegisterResourcePatch(ourHash, cmd - dListStart, cmd->words.w1);
-
-                        cmd->words.w1 = (uintptr_t)vtx;
+                        Gfx patched = *cmd;
+                        patched.words.w1 = (uintptr_t)vtx;
+                        gfx_patch_instruction(cmd, dListStart, ourHash, hash, patched);
 
                         gfx_sp_vertex(C0(12, 8), C0(1, 7) - C0(12, 8), vtx);
                         cmd++;
@@ -2276,6 +2920,7 @@ static void gfx_run_dl(Gfx* cmd) {
                 } else {
                     cmd = (Gfx *)seg_addr(cmd->words.w1);
                     --cmd; // increase after break
+                    ourHash = -1;
                 }
                 break;
             case G_DL_OTR:
@@ -2297,14 +2942,23 @@ static void gfx_run_dl(Gfx* cmd) {
                     Gfx* gfx = ResourceMgr_LoadGfxByCRC(hash);
 
                     if (gfx != 0)
+                    {
+                        gfx_resolve_otr(cmd - 1, dListStart, ourHash, hash, G_DL_OTR_RESOLVED, gfx);
                         gfx_run_dl(gfx);
+                    }
                 }
                 else {
                     cmd = (Gfx*)seg_addr(cmd->words.w1);
                     cmd++;
                     --cmd; // increase after break
+                    ourHash = -1;
                 }
                 break;
+            case G_DL_OTR_RESOLVED:
+                // Only the push form is resolved
+                gfx_run_dl((Gfx*)gfx_resolved_addr(cmd));
+                cmd++;
+                break;
             case G_BRANCH_Z_OTR:
             {
                 // Push return address
@@ -2330,12 +2984,29 @@ static void gfx_run_dl(Gfx* cmd) {
 
                     if (gfx != 0)
                     {
+                        gfx_resolve_otr(cmd - 1, dListStart, ourHash, hash, G_BRANCH_Z_OTR_RESOLVED, gfx);
                         cmd = gfx;
                         --cmd; // increase after break
                     }
                 }
             }
                 break;
+            case G_BRANCH_Z_OTR_RESOLVED:
+            {
+                uint8_t vbidx = cmd->words.w0 & 0x00000FFF;
+                uint32_t zval = cmd->words.w1;
+
+                if (rsp.loaded_vertices[vbidx].z <= zval)
+                {
+                    cmd = (Gfx*)gfx_resolved_addr(cmd);
+                    --cmd; // increase after break
+                }
+                else
+                {
+                    cmd++;
+                }
+            }
+                break;
             case (uint8_t)G_ENDDL:
 
                 //if (markerOn)
@@ -2398,9 +3069,13 @@ static void gfx_run_dl(Gfx* cmd) {
 
                 char* imgData = (char*)i;
 
+                // Paths are looked up by their CRC64 so a resident texture is found without going through the path keyed cache.
                 if ((i & 0xF0000000) != 0xF0000000)
                     if (ResourceMgr_OTRSigCheck(imgData) == 1)
-                        i = (uintptr_t)ResourceMgr_LoadTexByName(imgData);
+                    {
+                        char* tex = ResourceMgr_LoadTexByCRC(CRC64(imgData + 7));
+                        i = tex != nullptr ? (uintptr_t)tex : (uintptr_t)ResourceMgr_LoadTexByName(imgData);
+                    }
 
                     gfx_dp_set_texture_image(C0(21, 3), C0(19, 2), C0(0, 10), (void*) i, imgData);
                 break;
@@ -2410,7 +3085,8 @@ static void gfx_run_dl(Gfx* cmd) {
                 uintptr_t addr = cmd->words.w1;
                 cmd++;
                 uint64_t hash = ((uint64_t)cmd->words.w0 << 32) + (uint64_t)cmd->words.w1;
-                ResourceMgr_GetNameByCRC(hash, fileName);
+                // The path only feeds the texture dump, so only the first execution pays for looking it up
+                char* texName = nullptr;
 
 
 #if _DEBUG && 0
@@ -2431,13 +3107,12 @@ static void gfx_run_dl(Gfx* cmd) {
 
                     if (tex != nullptr)
                     {
-                        cmd--;
-                        uintptr_t oldData = cmd->words.w1;
-                        cmd->words.w1 = (uintptr_t)tex;
-
-                        if (ourHash  != -1)
-                            ResourceMgr_RegisterResourcePatch(ourHash, cmd - dListStart, oldData);
+                        texName = ResourceMgr_GetNameByCRC(hash, fileName);
 
+                        cmd--;
+                        Gfx patched = *cmd;
+                        patched.words.w1 = (uintptr_t)tex;
+                        gfx_patch_instruction(cmd, dListStart, ourHash, hash, patched);
                         cmd++;
                     }
                 }
@@ -2450,7 +3125,7 @@ static void gfx_run_dl(Gfx* cmd) {
                 uint32_t width = C0(0, 10);
 
                 if (tex != NULL)
-                    gfx_dp_set_texture_image(fmt, size, width, tex, fileName);
+                    gfx_dp_set_texture_image(fmt, size, width, tex, texName);
 
                 cmd++;
             }
@@ -2475,7 +3150,7 @@ static void gfx_run_dl(Gfx* cmd) {
             case G_SETTIMG_FB:
             {
                 gfx_flush();
-                gfx_rapi->select_texture_fb(cmd->words.w1);
+                rendering_state.framebuffer_texture = DRAW_FRAMEBUFFER_TEXTURE | (uint32_t)cmd->words.w1;
                 rdp.textures_changed[0] = false;
                 rdp.textures_changed[1] = false;
 
@@ -2616,6 +3291,11 @@ static void gfx_run_dl(Gfx* cmd) {
 
                 break;
         }
+
+        if (gfx_capture_active) {
+            gfx_capture_command(cmdStart, cmd);
+        }
+
         ++cmd;
     }
 }
@@ -2645,38 +3325,14 @@ void gfx_init(struct GfxWindowManagerAPI *wapi, struct GfxRenderingAPI *rapi, co
     for (int i = 0; i < 16; i++)
         segmentPointers[i] = NULL;
 
-    // Used in the 120 star TAS
-    static uint32_t precomp_shaders[] = {
-        0x01200200,
-        0x00000045,
-        0x00000200,
-        0x01200a00,
-        0x00000a00,
-        0x01a00045,
-        0x00000551,
-        0x01045045,
-        0x05a00a00,
-        0x01200045,
-        0x05045045,
-        0x01045a00,
-        0x01a00a00,
-        0x0000038d,
-        0x01081081,
-        0x0120038d,
-        0x03200045,
-        0x03200a00,
-        0x01a00a6f,
-        0x01141045,
-        0x07a00a00,
-        0x05200200,
-        0x03200200,
-        0x09200200,
-        0x0920038d,
-        0x09200045
-    };
-    for (size_t i = 0; i < sizeof(precomp_shaders) / sizeof(uint32_t); i++) {
-        //gfx_lookup_or_create_shader_program(precomp_shaders[i]);
+    for (int i = 0; i < 2; i++) {
+        rendering_state.draw.texture_ids[i] = DRAW_NO_TEXTURE;
+        applied_state.texture_ids[i] = DRAW_NO_TEXTURE;
+        applied_state.samplers[i] = DRAW_UNKNOWN_SAMPLER;
     }
+    rendering_state.framebuffer_texture = DRAW_NO_TEXTURE;
+
+    gfx_warm_up_shader_cache();
 
     ModInternal::bindHook(GFX_INIT);
     ModInternal::initBindHook(0);
@@ -2733,8 +3389,17 @@ void gfx_run(Gfx *commands) {
     gfx_sp_reset();
 
     //puts("New frame");
-    get_pixel_depth_pending.clear();
-    get_pixel_depth_cached.clear();
+    {
+        std::lock_guard<std::mutex> lock(get_pixel_depth_mutex);
+        get_pixel_depth_pending.clear();
+        get_pixel_depth_cached.clear();
+        get_pixel_depth_collected = false;
+
+        if (get_pixel_depth_deferred && gfx_rapi->collect_pixel_depth != NULL) {
+            gfx_rapi->collect_pixel_depth(get_pixel_depth_async);
+            get_pixel_depth_collected = true;
+        }
+    }
 
     if (!gfx_wapi->start_frame()) {
         dropped_frame = true;
@@ -2749,8 +3414,19 @@ void gfx_run(Gfx *commands) {
     gfx_rapi->start_frame();
     gfx_rapi->start_draw_to_framebuffer(game_renders_to_framebuffer ? game_framebuffer : 0, (float)gfx_current_dimensions.height / SCREEN_HEIGHT);
     gfx_rapi->clear_framebuffer();
+    gfx_capture_begin_frame();
     gfx_run_dl(commands);
+    gfx_capture_end_frame();
     gfx_flush();
+    {
+        std::lock_guard<std::mutex> lock(get_pixel_depth_mutex);
+        if (gfx_rapi->queue_pixel_depth != NULL) {
+            gfx_rapi->queue_pixel_depth(game_renders_to_framebuffer ? game_framebuffer : 0, get_pixel_depth_requested);
+        } else if (get_pixel_depth_deferred && !get_pixel_depth_requested.empty()) {
+            get_pixel_depth_async = gfx_rapi->get_pixel_depth(game_renders_to_framebuffer ? game_framebuffer : 0, get_pixel_depth_requested);
+        }
+        get_pixel_depth_requested.clear();
+    }
     SohUtils::saveEnvironmentVar("framebuffer", string());
     if (game_renders_to_framebuffer) {
         gfx_rapi->start_draw_to_framebuffer(0, 1);
@@ -2815,18 +3491,70 @@ static void adjust_pixel_depth_coordinates(float& x, float& y) {
     }
 }
 
+static bool gfx_get_pixel_depth_async(float x, float y, uint16_t& depth) {
+    if (!get_pixel_depth_deferred) {
+        if (gfx_rapi->collect_pixel_depth == NULL) {
+            return false;
+        }
+
+        if (!get_pixel_depth_collected) {
+            gfx_rapi->collect_pixel_depth(get_pixel_depth_async);
+            get_pixel_depth_collected = true;
+        }
+    }
+
+    // Points move a little between frames, accept anything within two N64 pixels
+    float max_distance = 2.0f * RATIO_Y;
+    float best_distance = max_distance * max_distance;
+    bool found = false;
+    for (const auto& [coord, value] : get_pixel_depth_async) {
+        float dx = coord.first - x;
+        float dy = coord.second - y;
+        float distance = dx * dx + dy * dy;
+        if (distance <= best_distance) {
+            best_distance = distance;
+            depth = value;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void gfx_set_pixel_depth_deferred(bool deferred) {
+    std::lock_guard<std::mutex> lock(get_pixel_depth_mutex);
+    get_pixel_depth_deferred = deferred;
+}
+
 void gfx_get_pixel_depth_prepare(float x, float y) {
+    std::lock_guard<std::mutex> lock(get_pixel_depth_mutex);
     adjust_pixel_depth_coordinates(x, y);
-    get_pixel_depth_pending.emplace(x, y);
+    if (!get_pixel_depth_deferred) {
+        get_pixel_depth_pending.emplace(x, y);
+    }
+    get_pixel_depth_requested.emplace(x, y);
 }
 
 uint16_t gfx_get_pixel_depth(float x, float y) {
+    std::lock_guard<std::mutex> lock(get_pixel_depth_mutex);
     adjust_pixel_depth_coordinates(x, y);
+    get_pixel_depth_requested.emplace(x, y);
+
+    if (get_pixel_depth_deferred) {
+        // Nothing was read back near this point yet, report it as covered, which hides a glow for a frame instead of waiting on the renderer
+        uint16_t depth = 0;
+        gfx_get_pixel_depth_async(x, y, depth);
+        return depth;
+    }
 
     if (auto it = get_pixel_depth_cached.find(make_pair(x, y)); it != get_pixel_depth_cached.end()) {
         return it->second;
     }
 
+    if (uint16_t depth; gfx_get_pixel_depth_async(x, y, depth)) {
+        return depth;
+    }
+
     get_pixel_depth_pending.emplace(x, y);
 
     map<pair<float, float>, uint16_t> res = gfx_rapi->get_pixel_depth(game_renders_to_framebuffer ? game_framebuffer : 0, get_pixel_depth_pending);
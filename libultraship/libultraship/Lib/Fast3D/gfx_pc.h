@@ -2,7 +2,9 @@
 #define GFX_PC_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <list>
 #include <unordered_map>
 
 struct GfxRenderingAPI;
@@ -39,8 +41,6 @@ typedef std::pair<const TextureCacheKey, struct TextureCacheValue> TextureCacheN
 
 struct TextureCacheValue {
     uint32_t texture_id;
-    uint8_t cms, cmt;
-    bool linear_filter;
 
     // Old versions of libstdc++ fail to compile this
 #ifdef _MSC_VER
@@ -50,6 +50,33 @@ struct TextureCacheValue {
 #endif
 };
 
+struct GfxTextureCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t dedup_hits; // Misses that found the same texels already uploaded
+    uint64_t uploads;
+    uint64_t upload_bytes;
+    uint64_t evictions;
+    size_t entries;
+    size_t textures;
+    size_t bytes;
+    size_t budget;
+};
+
+// Running totals since startup, a flush is one draw_triangles call on the backend.
+struct GfxDrawStats {
+    uint64_t flushes;
+    uint64_t triangles;
+};
+
+struct GfxVertexCheckResult {
+    bool simd; // False if this build has no vector vertex path, nothing was compared then
+    uint32_t vertices;
+    uint32_t mismatches;
+    double scalar_ms;
+    double simd_ms;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -65,7 +92,18 @@ void gfx_run(Gfx* commands);
 void gfx_end_frame(void);
 void gfx_set_framedivisor(int);
 void gfx_texture_cache_clear();
+void gfx_texture_cache_configure(size_t budget_bytes, bool dedup);
+struct GfxTextureCacheStats gfx_texture_cache_get_stats(void);
+struct GfxDrawStats gfx_get_draw_stats(void);
+// Runs random vertices through the vector and the scalar vertex transform under every lighting and fog mode. Must be called
+// between frames on the thread that runs gfx_run.
+struct GfxVertexCheckResult gfx_vertex_check_random(uint32_t vertices);
+// While enabled, every vertex batch the game loads is also run through the scalar transform and compared. Enabling resets the counts.
+void gfx_vertex_check_live(bool enabled);
+struct GfxVertexCheckResult gfx_vertex_check_live_results(void);
 int gfx_create_framebuffer(uint32_t width, uint32_t height);
+// While deferred, pixel depth may be asked for from another thread than the one running gfx_run, see gfx_pc.cpp.
+void gfx_set_pixel_depth_deferred(bool deferred);
 void gfx_get_pixel_depth_prepare(float x, float y);
 uint16_t gfx_get_pixel_depth(float x, float y);
 
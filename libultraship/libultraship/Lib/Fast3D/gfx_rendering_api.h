@@ -10,6 +10,9 @@
 
 struct ShaderProgram;
 
+// Most triangles gfx_pc passes to one draw_triangles call, backends with a fixed size vertex buffer size it for this many
+#define GFX_MAX_DRAW_TRIANGLES 1024
+
 struct GfxClipParameters {
     bool z_is_from_0_to_1;
     bool invert_y;
@@ -46,6 +49,10 @@ struct GfxRenderingAPI {
     void *(*get_framebuffer_texture_id)(int fb_id);
     void (*select_texture_fb)(int fb_id);
     void (*delete_texture)(uint32_t texID);
+    // Optional asynchronous depth reads. Reads queued at the end of a frame are returned by a later collect call once the GPU
+    // has finished them, collect leaves results untouched and returns false while nothing new is ready.
+    void (*queue_pixel_depth)(int fb_id, const std::set<std::pair<float, float>>& coordinates);
+    bool (*collect_pixel_depth)(std::map<std::pair<float, float>, uint16_t>& results);
 };
 
 #endif
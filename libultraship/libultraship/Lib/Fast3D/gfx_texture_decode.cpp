@@ -0,0 +1,366 @@
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include "gfx_texture_decode.h"
+
+// Every converter writes RGBA bytes, which on the little endian targets we run on is r | g << 8 | b << 16 | a << 24.
+static inline uint32_t pack_rgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+static inline uint32_t rgba16_to_rgba32(uint16_t col16) {
+    uint8_t a = col16 & 1;
+    uint8_t r = col16 >> 11;
+    uint8_t g = (col16 >> 6) & 0x1f;
+    uint8_t b = (col16 >> 1) & 0x1f;
+    return pack_rgba((r * 0xFF) / 0x1F, (g * 0xFF) / 0x1F, (b * 0xFF) / 0x1F, a ? 255 : 0);
+}
+
+static inline uint8_t texel4(const uint8_t* src, uint32_t i) {
+    return (src[i / 2] >> (4 - (i % 2) * 4)) & 0xf;
+}
+
+static void gfx_decode_rgba16_scalar(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint32_t c = rgba16_to_rgba32((src[2 * i] << 8) | src[2 * i + 1]);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+static void gfx_decode_ia4_scalar(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint8_t part = texel4(src, i);
+        uint8_t intensity = (part >> 1) * 0x24;
+        uint32_t c = pack_rgba(intensity, intensity, intensity, (part & 1) ? 255 : 0);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+static void gfx_decode_ia8_scalar(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint8_t intensity = (src[i] >> 4) * 0x11;
+        uint32_t c = pack_rgba(intensity, intensity, intensity, (src[i] & 0xf) * 0x11);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+static void gfx_decode_ia16_scalar(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint8_t intensity = src[2 * i];
+        uint32_t c = pack_rgba(intensity, intensity, intensity, src[2 * i + 1]);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+static void gfx_decode_i4_scalar(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint8_t intensity = texel4(src, i) * 0x11;
+        uint32_t c = pack_rgba(intensity, intensity, intensity, intensity);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+static void gfx_decode_i8_scalar(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint32_t c = pack_rgba(src[i], src[i], src[i], src[i]);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+static void gfx_decode_ci4_scalar(const uint8_t* src, uint32_t texels, const uint8_t* palette, uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint8_t idx = texel4(src, i);
+        uint32_t c = rgba16_to_rgba32((palette[idx * 2] << 8) | palette[idx * 2 + 1]);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+static void gfx_decode_ci8_scalar(const uint8_t* src, uint32_t texels, const uint8_t* const palettes[2], uint8_t* dst) {
+    for (uint32_t i = 0; i < texels; i++) {
+        uint8_t idx = src[i];
+        const uint8_t* entry = palettes[idx / 128] + (idx % 128) * 2;
+        uint32_t c = rgba16_to_rgba32((entry[0] << 8) | entry[1]);
+        memcpy(dst + 4 * i, &c, 4);
+    }
+}
+
+#ifdef GFX_SSE2
+// Exact (x * 255) / 31 for 5 bit lanes, done as a multiply by the reciprocal.
+static inline __m128i scale_5_8_epi16(__m128i x) {
+    return _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(x, _mm_set1_epi16(0xFF)), _mm_set1_epi16(8457)), 2);
+}
+
+// Splits 16 packed bytes into 32 nibbles, high nibble first like the RDP reads them. Every byte of the result is below 16.
+static inline void unpack_nibbles(__m128i bytes, __m128i* lo, __m128i* hi) {
+    const __m128i mask = _mm_set1_epi8(0xf);
+    __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+    __m128i low = _mm_and_si128(bytes, mask);
+    *lo = _mm_unpacklo_epi8(high, low);
+    *hi = _mm_unpackhi_epi8(high, low);
+}
+
+// Writes 16 texels given per lane 8 bit intensity and alpha.
+static inline void store_ia(uint8_t* dst, __m128i intensity, __m128i alpha) {
+    __m128i ii_lo = _mm_unpacklo_epi8(intensity, intensity);
+    __m128i ii_hi = _mm_unpackhi_epi8(intensity, intensity);
+    __m128i ia_lo = _mm_unpacklo_epi8(intensity, alpha);
+    __m128i ia_hi = _mm_unpackhi_epi8(intensity, alpha);
+    _mm_storeu_si128((__m128i*)(dst + 0), _mm_unpacklo_epi16(ii_lo, ia_lo));
+    _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(ii_lo, ia_lo));
+    _mm_storeu_si128((__m128i*)(dst + 32), _mm_unpacklo_epi16(ii_hi, ia_hi));
+    _mm_storeu_si128((__m128i*)(dst + 48), _mm_unpackhi_epi16(ii_hi, ia_hi));
+}
+
+// Shifts within 16 bit lanes are safe below because every byte is small enough not to carry into its neighbour.
+static inline __m128i scale_4_8_epi8(__m128i x) {
+    return _mm_or_si128(_mm_slli_epi16(x, 4), x);
+}
+
+static inline __m128i scale_3_8_epi8(__m128i x) {
+    return _mm_add_epi8(_mm_slli_epi16(x, 5), _mm_slli_epi16(x, 2));
+}
+
+void gfx_decode_rgba16(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    const __m128i mask5 = _mm_set1_epi16(0x1f);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i low_byte = _mm_set1_epi16(0xff);
+    uint32_t i = 0;
+
+    for (; i + 8 <= texels; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + 2 * i));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+
+        __m128i r = scale_5_8_epi16(_mm_srli_epi16(v, 11));
+        __m128i g = scale_5_8_epi16(_mm_and_si128(_mm_srli_epi16(v, 6), mask5));
+        __m128i b = scale_5_8_epi16(_mm_and_si128(_mm_srli_epi16(v, 1), mask5));
+        __m128i a = _mm_and_si128(_mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(v, one)), low_byte);
+
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+        _mm_storeu_si128((__m128i*)(dst + 4 * i), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i*)(dst + 4 * i + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+
+    gfx_decode_rgba16_scalar(src + 2 * i, texels - i, dst + 4 * i);
+}
+
+void gfx_decode_ia4(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    const __m128i one = _mm_set1_epi8(1);
+    uint32_t i = 0;
+
+    for (; i + 32 <= texels; i += 32) {
+        __m128i parts[2];
+        unpack_nibbles(_mm_loadu_si128((const __m128i*)(src + i / 2)), &parts[0], &parts[1]);
+
+        for (int k = 0; k < 2; k++) {
+            __m128i intensity = scale_3_8_epi8(_mm_and_si128(_mm_srli_epi16(parts[k], 1), _mm_set1_epi8(7)));
+            __m128i alpha = _mm_cmpeq_epi8(_mm_and_si128(parts[k], one), one);
+            store_ia(dst + 4 * (i + 16 * k), intensity, alpha);
+        }
+    }
+
+    gfx_decode_ia4_scalar(src + i / 2, texels - i, dst + 4 * i);
+}
+
+void gfx_decode_ia8(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    const __m128i mask = _mm_set1_epi8(0xf);
+    uint32_t i = 0;
+
+    for (; i + 16 <= texels; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i intensity = scale_4_8_epi8(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i alpha = scale_4_8_epi8(_mm_and_si128(v, mask));
+        store_ia(dst + 4 * i, intensity, alpha);
+    }
+
+    gfx_decode_ia8_scalar(src + i, texels - i, dst + 4 * i);
+}
+
+void gfx_decode_ia16(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    const __m128i low_byte = _mm_set1_epi16(0xff);
+    uint32_t i = 0;
+
+    for (; i + 8 <= texels; i += 8) {
+        // Each 16 bit lane already holds intensity | alpha << 8, which is the upper half of the output texel.
+        __m128i ia = _mm_loadu_si128((const __m128i*)(src + 2 * i));
+        __m128i intensity = _mm_and_si128(ia, low_byte);
+        __m128i ii = _mm_or_si128(intensity, _mm_slli_epi16(intensity, 8));
+        _mm_storeu_si128((__m128i*)(dst + 4 * i), _mm_unpacklo_epi16(ii, ia));
+        _mm_storeu_si128((__m128i*)(dst + 4 * i + 16), _mm_unpackhi_epi16(ii, ia));
+    }
+
+    gfx_decode_ia16_scalar(src + 2 * i, texels - i, dst + 4 * i);
+}
+
+void gfx_decode_i4(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    uint32_t i = 0;
+
+    for (; i + 32 <= texels; i += 32) {
+        __m128i parts[2];
+        unpack_nibbles(_mm_loadu_si128((const __m128i*)(src + i / 2)), &parts[0], &parts[1]);
+
+        for (int k = 0; k < 2; k++) {
+            __m128i intensity = scale_4_8_epi8(parts[k]);
+            store_ia(dst + 4 * (i + 16 * k), intensity, intensity);
+        }
+    }
+
+    gfx_decode_i4_scalar(src + i / 2, texels - i, dst + 4 * i);
+}
+
+void gfx_decode_i8(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    uint32_t i = 0;
+
+    for (; i + 16 <= texels; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        store_ia(dst + 4 * i, v, v);
+    }
+
+    gfx_decode_i8_scalar(src + i, texels - i, dst + 4 * i);
+}
+#else
+void gfx_decode_rgba16(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    gfx_decode_rgba16_scalar(src, texels, dst);
+}
+
+void gfx_decode_ia4(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    gfx_decode_ia4_scalar(src, texels, dst);
+}
+
+void gfx_decode_ia8(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    gfx_decode_ia8_scalar(src, texels, dst);
+}
+
+void gfx_decode_ia16(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    gfx_decode_ia16_scalar(src, texels, dst);
+}
+
+void gfx_decode_i4(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    gfx_decode_i4_scalar(src, texels, dst);
+}
+
+void gfx_decode_i8(const uint8_t* src, uint32_t texels, uint8_t* dst) {
+    gfx_decode_i8_scalar(src, texels, dst);
+}
+#endif
+
+// SSE2 has no gather, so the palette formats expand the TLUT to RGBA32 once and then copy whole texels out of it.
+void gfx_decode_ci4(const uint8_t* src, uint32_t texels, const uint8_t* palette, uint8_t* dst) {
+    uint32_t lut[16];
+
+    gfx_decode_rgba16((const uint8_t*)palette, 16, (uint8_t*)lut);
+
+    for (uint32_t i = 0; i + 2 <= texels; i += 2) {
+        uint8_t byte = src[i / 2];
+        memcpy(dst + 4 * i, &lut[byte >> 4], 4);
+        memcpy(dst + 4 * i + 4, &lut[byte & 0xf], 4);
+    }
+
+    if (texels % 2 != 0) {
+        memcpy(dst + 4 * (texels - 1), &lut[src[(texels - 1) / 2] >> 4], 4);
+    }
+}
+
+void gfx_decode_ci8(const uint8_t* src, uint32_t texels, uint32_t line_texels, uint32_t src_line_stride,
+                    const uint8_t* const palettes[2], uint8_t* dst) {
+    uint32_t lut[256];
+
+    // Building the full table costs 256 conversions, so tiny textures are cheaper to convert directly.
+    if (texels < 256) {
+        for (uint32_t i = 0; i < texels; i += line_texels, src += src_line_stride) {
+            gfx_decode_ci8_scalar(src, std::min(line_texels, texels - i), palettes, dst + 4 * i);
+        }
+        return;
+    }
+
+    gfx_decode_rgba16(palettes[0], 128, (uint8_t*)lut);
+    gfx_decode_rgba16(palettes[1], 128, (uint8_t*)(lut + 128));
+
+    for (uint32_t i = 0; i < texels; i += line_texels, src += src_line_stride) {
+        uint32_t count = std::min(line_texels, texels - i);
+        uint8_t* out = dst + 4 * i;
+        for (uint32_t k = 0; k < count; k++) {
+            memcpy(out + 4 * k, &lut[src[k]], 4);
+        }
+    }
+}
+
+uint8_t* gfx_texture_decode_buffer(size_t size) {
+    struct alignas(16) Block {
+        uint8_t bytes[16];
+    };
+    static std::vector<Block> buffer;
+
+    size_t blocks = (size + sizeof(Block) - 1) / sizeof(Block);
+    if (buffer.size() < blocks) {
+        buffer.resize(blocks);
+    }
+
+    return buffer.empty() ? nullptr : buffer[0].bytes;
+}
+
+template <typename Decode>
+static double time_decode(uint32_t iterations, Decode decode) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        decode();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::vector<GfxTextureDecodeTiming> gfx_texture_decode_benchmark(uint32_t texels, uint32_t iterations) {
+    std::vector<GfxTextureDecodeTiming> results;
+    std::vector<uint8_t> src(texels * 2 + 512);
+    std::vector<uint8_t> expected(texels * 4);
+    std::vector<uint8_t> actual(texels * 4);
+    std::mt19937 rng(12345);
+
+    for (uint8_t& b : src) {
+        b = (uint8_t)rng();
+    }
+
+    const uint8_t* in = src.data() + 512;
+    const uint8_t* palettes[2] = { src.data(), src.data() + 256 };
+
+    typedef void (*Decoder)(const uint8_t*, uint32_t, uint8_t*);
+    struct {
+        const char* format;
+        Decoder scalar;
+        Decoder simd;
+    } plain[] = {
+        { "RGBA16", gfx_decode_rgba16_scalar, gfx_decode_rgba16 },
+        { "IA4", gfx_decode_ia4_scalar, gfx_decode_ia4 },
+        { "IA8", gfx_decode_ia8_scalar, gfx_decode_ia8 },
+        { "IA16", gfx_decode_ia16_scalar, gfx_decode_ia16 },
+        { "I4", gfx_decode_i4_scalar, gfx_decode_i4 },
+        { "I8", gfx_decode_i8_scalar, gfx_decode_i8 },
+    };
+
+    for (const auto& format : plain) {
+        GfxTextureDecodeTiming timing;
+        timing.format = format.format;
+        timing.scalar_ms = time_decode(iterations, [&] { format.scalar(in, texels, expected.data()); });
+        timing.simd_ms = time_decode(iterations, [&] { format.simd(in, texels, actual.data()); });
+        timing.matches = memcmp(expected.data(), actual.data(), expected.size()) == 0;
+        results.push_back(timing);
+    }
+
+    GfxTextureDecodeTiming ci4;
+    ci4.format = "CI4";
+    ci4.scalar_ms = time_decode(iterations, [&] { gfx_decode_ci4_scalar(in, texels, palettes[0], expected.data()); });
+    ci4.simd_ms = time_decode(iterations, [&] { gfx_decode_ci4(in, texels, palettes[0], actual.data()); });
+    ci4.matches = memcmp(expected.data(), actual.data(), expected.size()) == 0;
+    results.push_back(ci4);
+
+    GfxTextureDecodeTiming ci8;
+    ci8.format = "CI8";
+    ci8.scalar_ms = time_decode(iterations, [&] { gfx_decode_ci8_scalar(in, texels, palettes, expected.data()); });
+    ci8.simd_ms = time_decode(iterations, [&] { gfx_decode_ci8(in, texels, texels, texels, palettes, actual.data()); });
+    ci8.matches = memcmp(expected.data(), actual.data(), expected.size()) == 0;
+    results.push_back(ci8);
+
+    return results;
+}
@@ -0,0 +1,42 @@
+#ifndef GFX_TEXTURE_DECODE_H
+#define GFX_TEXTURE_DECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// SSE2 is part of every x64 target, so the vector paths need no runtime dispatch.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GFX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Converters from the N64 texel formats to RGBA32. Sources are big endian as stored in TMEM,
+// texel counts are in output texels and dst must hold 4 bytes per texel.
+void gfx_decode_rgba16(const uint8_t* src, uint32_t texels, uint8_t* dst);
+void gfx_decode_ia4(const uint8_t* src, uint32_t texels, uint8_t* dst);
+void gfx_decode_ia8(const uint8_t* src, uint32_t texels, uint8_t* dst);
+void gfx_decode_ia16(const uint8_t* src, uint32_t texels, uint8_t* dst);
+void gfx_decode_i4(const uint8_t* src, uint32_t texels, uint8_t* dst);
+void gfx_decode_i8(const uint8_t* src, uint32_t texels, uint8_t* dst);
+
+// palette is the 16 entry TLUT selected by the tile.
+void gfx_decode_ci4(const uint8_t* src, uint32_t texels, const uint8_t* palette, uint8_t* dst);
+// palettes are the two 128 entry halves of the 256 entry TLUT. Source lines of line_texels texels start src_line_stride bytes apart.
+void gfx_decode_ci8(const uint8_t* src, uint32_t texels, uint32_t line_texels, uint32_t src_line_stride,
+                    const uint8_t* const palettes[2], uint8_t* dst);
+
+// Scratch space shared by the texture importers, grown on demand and never shrunk. Only valid until the next call.
+uint8_t* gfx_texture_decode_buffer(size_t size);
+
+struct GfxTextureDecodeTiming {
+    const char* format;
+    double scalar_ms;
+    double simd_ms;
+    bool matches;
+};
+
+// Decodes random data of the given size with both the scalar and the vector converters.
+std::vector<GfxTextureDecodeTiming> gfx_texture_decode_benchmark(uint32_t texels, uint32_t iterations);
+
+#endif
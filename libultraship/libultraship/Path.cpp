@@ -30,4 +30,16 @@ namespace Ship
 			path->paths.push_back(nodes);
 		}
 	}
+
+	size_t Path::GetMemorySize()
+	{
+		size_t size = sizeof(Path) + paths.capacity() * sizeof(std::vector<Vec3s>);
+
+		for (const auto& nodes : paths)
+		{
+			size += nodes.capacity() * sizeof(Vec3s);
+		}
+
+		return size;
+	}
 }
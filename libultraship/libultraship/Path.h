@@ -19,5 +19,7 @@ namespace Ship
 	{
 	public:
 		std::vector<std::vector<Vec3s>> paths;
+
+		size_t GetMemorySize() override;
 	};
 }
\ No newline at end of file
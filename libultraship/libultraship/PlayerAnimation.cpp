@@ -16,4 +16,9 @@ namespace Ship
 			anim->limbRotData.push_back(reader->ReadInt16());
 
 	}
+
+	size_t PlayerAnimation::GetMemorySize()
+	{
+		return sizeof(PlayerAnimation) + limbRotData.capacity() * sizeof(int16_t);
+	}
 }
\ No newline at end of file
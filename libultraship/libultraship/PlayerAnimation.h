@@ -19,5 +19,7 @@ namespace Ship
     {
     public:
 		std::vector<int16_t> limbRotData;
+
+		size_t GetMemorySize() override;
     };
 }
\ No newline at end of file
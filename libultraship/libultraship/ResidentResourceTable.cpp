@@ -0,0 +1,81 @@
+#include "ResidentResourceTable.h"
+
+namespace Ship
+{
+	ResidentResourceTable::ResidentResourceTable(size_t Capacity)
+	{
+		size_t Size = 1;
+
+		while (Size < Capacity) {
+			Size <<= 1;
+		}
+
+		Slots = std::make_unique<Slot[]>(Size);
+		Mask = Size - 1;
+
+		for (size_t i = 0; i < Size; i++) {
+			Slots[i].Hash.store(0, std::memory_order_relaxed);
+			Slots[i].Res.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	Resource* ResidentResourceTable::Find(uint64_t Hash) const
+	{
+		if (Hash == 0) {
+			return nullptr;
+		}
+
+		for (size_t i = IndexOf(Hash), Probes = 0; Probes <= Mask; i = (i + 1) & Mask, Probes++) {
+			const uint64_t SlotHash = Slots[i].Hash.load(std::memory_order_acquire);
+
+			if (SlotHash == Hash) {
+				return Slots[i].Res.load(std::memory_order_acquire);
+			}
+
+			if (SlotHash == 0) {
+				break;
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool ResidentResourceTable::Insert(uint64_t Hash, Resource* Res)
+	{
+		// 0 marks an empty slot, such a hash just never gets the fast path.
+		if (Hash == 0) {
+			return false;
+		}
+
+		for (size_t i = IndexOf(Hash), Probes = 0; Probes <= Mask; i = (i + 1) & Mask, Probes++) {
+			uint64_t SlotHash = Slots[i].Hash.load(std::memory_order_acquire);
+
+			if (SlotHash == 0 && Slots[i].Hash.compare_exchange_strong(SlotHash, Hash, std::memory_order_acq_rel)) {
+				SlotHash = Hash;
+			}
+
+			if (SlotHash == Hash) {
+				Slots[i].Res.store(Res, std::memory_order_release);
+				return true;
+			}
+		}
+
+		// Full, callers keep using the slow path.
+		return false;
+	}
+
+	void ResidentResourceTable::Remove(Resource* Res)
+	{
+		for (size_t i = 0; i <= Mask; i++) {
+			Resource* Expected = Res;
+			Slots[i].Res.compare_exchange_strong(Expected, nullptr, std::memory_order_acq_rel);
+		}
+	}
+
+	void ResidentResourceTable::Clear()
+	{
+		for (size_t i = 0; i <= Mask; i++) {
+			Slots[i].Res.store(nullptr, std::memory_order_release);
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+namespace Ship
+{
+	class Resource;
+
+	// Open addressing table from the CRC64 of a resource path to the resident Resource.
+	// Lookups and inserts never lock, so the renderer can resolve OTR references in display lists without touching ResourceMgr's maps.
+	// Keys are never removed, a cleared slot keeps its key with a null value so probe chains stay intact.
+	// The table does not own anything, the Resources stay owned by the ResourceMgr cache.
+	class ResidentResourceTable
+	{
+	public:
+		// Capacity is rounded up to a power of two.
+		ResidentResourceTable(size_t Capacity);
+
+		Resource* Find(uint64_t Hash) const;
+		bool Insert(uint64_t Hash, Resource* Res);
+		void Remove(Resource* Res);
+		void Clear();
+
+	private:
+		struct Slot
+		{
+			std::atomic<uint64_t> Hash;
+			std::atomic<Resource*> Res;
+		};
+
+		std::unique_ptr<Slot[]> Slots;
+		size_t Mask;
+
+		size_t IndexOf(uint64_t Hash) const { return (size_t)(Hash ^ (Hash >> 32)) & Mask; }
+	};
+}
@@ -45,9 +45,9 @@ namespace Ship
             if (resShared != nullptr)
             {
                 auto res = (Ship::DisplayList*)resShared.get();
-                
-                Gfx* gfx = (Gfx*)&res->instructions[patches[i].index];
-                gfx->words.w1 = patches[i].origData;
+
+                if (patches[i].index < res->instructions.size())
+                    res->instructions[patches[i].index] = patches[i].origData;
             }
         }
 
@@ -58,4 +58,9 @@ namespace Ship
             printf("Deconstructor called on file %s\n", file->path.c_str());
 #endif
     }
+
+    size_t Resource::GetMemorySize()
+    {
+        return 0;
+    }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include "Utils/BinaryReader.h"
 #include "Utils/BinaryWriter.h"
 #include "GlobalCtx2.h"
@@ -64,11 +65,12 @@ namespace Ship
         // ...
     };
 
+    // A display list instruction that was rewritten to point into this Resource. It is put back when this Resource goes away.
     struct Patch
     {
-        uint64_t crc;
+        uint64_t crc; // Display list that holds the instruction
         uint32_t index;
-        uintptr_t origData;
+        uint64_t origData; // The whole 64-bit instruction before it was rewritten
     };
 
     class Resource
@@ -78,10 +80,16 @@ namespace Ship
         uint64_t id; // Unique Resource ID
         ResourceType resType;
         bool isDirty = false;
+        size_t cacheSize = 0; // Bytes accounted against the ResourceMgr cache budget, GetMemorySize() once parsed
+        std::atomic<bool> isReferenced = true; // Set on every cache hit, cleared by the eviction sweep
         void* cachedGameAsset = 0; // Conversion to OoT friendly struct cached...
+        size_t cachedGameAssetSize = 0; // Bytes allocated for cachedGameAsset, counted against the cache budget as well
+        std::vector<std::shared_ptr<Resource>> assetDependencies; // Resources that cachedGameAsset points into
         std::shared_ptr<File> file;
         std::vector<Patch> patches;
         virtual ~Resource();
+        // Bytes held by the parsed Resource, not counting cachedGameAsset. 0 if the type doesn't know, its File size is used instead.
+        virtual size_t GetMemorySize();
     };
 
     class ResourceFile
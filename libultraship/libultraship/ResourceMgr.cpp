@@ -6,14 +6,22 @@
 #include "GameVersions.h"
 #include <Utils/StringHelper.h>
 #include "Lib/StormLib/StormLib.h"
+#include <algorithm>
+#include <unordered_set>
 
 namespace Ship {
 
-	ResourceMgr::ResourceMgr(std::shared_ptr<GlobalCtx2> Context, std::string MainPath, std::string PatchesPath) : Context(Context), bIsRunning(false), FileLoadThread(nullptr) {
+	ResourceMgr::ResourceMgr(std::shared_ptr<GlobalCtx2> Context, std::string MainPath, std::string PatchesPath, uint32_t LoadThreadCount) : Context(Context), ResidentResources(1 << 16), CacheBudget(0), CachedBytes(0), bDeferReplacedRelease(false), bPatchRescanRequested(false), LoadThreadCount(LoadThreadCount), bIsRunning(false) {
 		OTR = std::make_shared<Archive>(MainPath, PatchesPath, false);
 
 		gameVersion = OOT_UNKNOWN;
 
+		if (this->LoadThreadCount == 0) {
+			this->LoadThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		OTR->SetReaderCount(this->LoadThreadCount);
+
 		if (OTR->IsMainMPQValid())
 			Start();
 	}
@@ -31,8 +39,13 @@ namespace Ship {
 		const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
 		if (!IsRunning()) {
 			bIsRunning = true;
-			FileLoadThread = std::make_shared<std::thread>(&ResourceMgr::LoadFileThread, this);
-			ResourceLoadThread = std::make_shared<std::thread>(&ResourceMgr::LoadResourceThread, this);
+
+			for (uint32_t i = 0; i < LoadThreadCount; i++) {
+				FileLoadThreads.push_back(std::make_shared<std::thread>(&ResourceMgr::LoadFileThread, this));
+				ResourceLoadThreads.push_back(std::make_shared<std::thread>(&ResourceMgr::LoadResourceThread, this));
+			}
+
+			SPDLOG_INFO("Resource Manager started with {} load threads", LoadThreadCount);
 		}
 	}
 
@@ -46,21 +59,30 @@ namespace Ship {
 			
 			FileLoadNotifier.notify_all();
 			ResourceLoadNotifier.notify_all();
-			FileLoadThread->join();
-			ResourceLoadThread->join();
+
+			for (auto& Thread : FileLoadThreads) {
+				Thread->join();
+			}
+
+			for (auto& Thread : ResourceLoadThreads) {
+				Thread->join();
+			}
+
+			FileLoadThreads.clear();
+			ResourceLoadThreads.clear();
 
 			if (!FileLoadQueue.empty()) {
 				SPDLOG_INFO("Resource manager stopped, but has {} Files left to load.", FileLoadQueue.size());
 			}
 
 			if (!ResourceLoadQueue.empty()) {
-				SPDLOG_INFO("Resource manager stopped, but has {} Resources left to load.", FileLoadQueue.size());
+				SPDLOG_INFO("Resource manager stopped, but has {} Resources left to load.", ResourceLoadQueue.size());
 			}
 		}
 	}
 
 	bool ResourceMgr::IsRunning() {
-		return bIsRunning && FileLoadThread != nullptr;
+		return bIsRunning && !FileLoadThreads.empty();
 	}
 
 	bool ResourceMgr::DidLoadSuccessfully()
@@ -82,18 +104,23 @@ namespace Ship {
 				break;
 			}
 
-			//Lock.lock();
 			std::shared_ptr<File> ToLoad = FileLoadQueue.front();
 			FileLoadQueue.pop();
-			//Lock.unlock();
 
+			// The archive hands every worker its own reader, so the queue is free for the other workers while we decompress.
+			Lock.unlock();
 			OTR->LoadFile(ToLoad->path, true, ToLoad);
-			//Lock.lock();
-			
-			if (!ToLoad->bHasLoadError)
-				FileCache[ToLoad->path] = ToLoad->bIsLoaded && !ToLoad->bHasLoadError ? ToLoad : nullptr;
+			Lock.lock();
+
+			// The File was put in the cache when it was queued so duplicate requests could wait on it, drop it if it failed.
+			if (ToLoad->bHasLoadError) {
+				auto fileCacheFind = FileCache.find(ToLoad->path);
+				if (fileCacheFind != FileCache.end() && fileCacheFind->second == ToLoad) {
+					FileCache.erase(fileCacheFind);
+				}
+			}
 
-			//Lock.unlock();
+			Lock.unlock();
 
 			SPDLOG_DEBUG("Loaded File {} on ResourceMgr thread", ToLoad->path);
 
@@ -116,11 +143,11 @@ namespace Ship {
 				break;
 			}
 
-			std::shared_ptr<ResourcePromise> ToLoad = nullptr;
-			//ResLock.lock();
-			ToLoad = ResourceLoadQueue.front();
+			std::shared_ptr<ResourcePromise> ToLoad = ResourceLoadQueue.front();
 			ResourceLoadQueue.pop();
-			//ResLock.unlock();
+
+			// Parsing runs without the queue lock so promises get completed in whatever order the workers finish.
+			ResLock.unlock();
 
 			// Wait for the underlying File to complete loading
 			{
@@ -130,6 +157,10 @@ namespace Ship {
 				}
 			}
 
+			std::shared_ptr<Resource> Res = nullptr;
+			// Keeps a replaced dirty Resource alive until ResLock is released, its destructor calls GetCachedFile.
+			std::shared_ptr<Resource> Replaced = nullptr;
+
 			if (!ToLoad->File->bHasLoadError)
 			{
 				auto UnmanagedRes = ResourceLoader::LoadResource(ToLoad->File);
@@ -137,37 +168,57 @@ namespace Ship {
 				if (UnmanagedRes != nullptr)
 				{
 					UnmanagedRes->resMgr = this;
-					auto Res = std::shared_ptr<Resource>(UnmanagedRes);
+					// Types that can't tell how much memory they hold are counted by the size of their File.
+					UnmanagedRes->cacheSize = UnmanagedRes->GetMemorySize();
+
+					if (UnmanagedRes->cacheSize == 0) {
+						UnmanagedRes->cacheSize = ToLoad->File->dwBufferSize;
+					}
 
-					if (Res != nullptr) {
-						std::unique_lock<std::mutex> Lock(ToLoad->ResourceLoadMutex);
+					Res = std::shared_ptr<Resource>(UnmanagedRes);
 
-						ToLoad->bHasResourceLoaded = true;
-						ToLoad->Resource = Res;
-						ResourceCache[Res->file->path] = Res;
+					ResLock.lock();
+					Replaced = ResourceCache[Res->file->path];
+					ResourceCache[Res->file->path] = Res;
+					CachedBytes += Res->cacheSize;
+					FinishPending(ToLoad);
 
-						SPDLOG_DEBUG("Loaded Resource {} on ResourceMgr thread", ToLoad->File->path);
+					if (Replaced != nullptr) {
+						CachedBytes -= Replaced->cacheSize;
 
-						// Disabled for now because it can cause random crashes
-						//FileCache[Res->File->path] = nullptr;
-						//FileCache.erase(FileCache.find(Res->File->path));
-						Res->file = nullptr;
+						if (bDeferReplacedRelease) {
+							ReplacedResources.push_back(Replaced);
+						}
 					}
-					else {
-						ToLoad->bHasResourceLoaded = false;
-						ToLoad->Resource = nullptr;
 
-						SPDLOG_ERROR("Resource load FAILED {} on ResourceMgr thread", ToLoad->File->path);
+					ResLock.unlock();
+
+					if (Replaced != nullptr) {
+						ResidentResources.Remove(Replaced.get());
 					}
 
-					//ResLock.lock();
-					//ResLock.unlock();
+					SPDLOG_DEBUG("Loaded Resource {} on ResourceMgr thread", ToLoad->File->path);
+
+					// The raw File isn't needed anymore once parsed, it goes away with the promise unless LoadFile cached it.
+					Res->file = nullptr;
+				}
+				else
+				{
+					SPDLOG_ERROR("Resource load FAILED {} on ResourceMgr thread", ToLoad->File->path);
 				}
 			}
-			else
+
+			if (Res == nullptr) {
+				ResLock.lock();
+				FinishPending(ToLoad);
+				ResLock.unlock();
+			}
+
+			// A failed load still completes the promise, with a null Resource, so nobody waits on it forever.
 			{
-				ToLoad->bHasResourceLoaded = false;
-				ToLoad->Resource = nullptr;
+				std::unique_lock<std::mutex> Lock(ToLoad->ResourceLoadMutex);
+				ToLoad->bHasResourceLoaded = true;
+				ToLoad->Resource = Res;
 			}
 
 			ToLoad->ResourceLoadNotifier.notify_all();
@@ -176,6 +227,14 @@ namespace Ship {
 		SPDLOG_INFO("Resource Manager LoadResourceThread ended");
 	}
 
+	void ResourceMgr::FinishPending(const std::shared_ptr<ResourcePromise>& Promise) {
+		auto PendingFind = PendingResources.find(Promise->File->path);
+
+		if (PendingFind != PendingResources.end() && PendingFind->second == Promise) {
+			PendingResources.erase(PendingFind);
+		}
+	}
+
 	uint32_t ResourceMgr::GetGameVersion()
 	{
 		return gameVersion;
@@ -186,7 +245,7 @@ namespace Ship {
 		gameVersion = newGameVersion;
 	}
 
-	std::shared_ptr<File> ResourceMgr::LoadFileAsync(std::string FilePath) {
+	std::shared_ptr<File> ResourceMgr::QueueFileLoad(const std::string& FilePath, bool bCacheFile) {
 		const std::lock_guard<std::mutex> Lock(FileLoadMutex);
 		// File NOT already loaded...?
 		auto fileCacheFind = FileCache.find(FilePath);
@@ -195,8 +254,12 @@ namespace Ship {
 			std::shared_ptr<File> ToLoad = std::make_shared<File>();
 			ToLoad->path = FilePath;
 
+			if (bCacheFile) {
+				FileCache[FilePath] = ToLoad;
+			}
+
 			FileLoadQueue.push(ToLoad);
-			FileLoadNotifier.notify_all();
+			FileLoadNotifier.notify_one();
 
 			return ToLoad;
 		}
@@ -204,6 +267,11 @@ namespace Ship {
 		return fileCacheFind->second;
 	}
 
+	std::shared_ptr<File> ResourceMgr::LoadFileAsync(std::string FilePath) {
+		// Callers get the raw buffer, so these Files are kept for good.
+		return QueueFileLoad(FilePath, true);
+	}
+
 	std::shared_ptr<File> ResourceMgr::LoadFile(std::string FilePath) {
 		auto ToLoad = LoadFileAsync(FilePath);
 		// Wait for the File to actually be loaded if we are told to block.
@@ -216,11 +284,13 @@ namespace Ship {
 	}
 
 	std::shared_ptr<Ship::Resource> ResourceMgr::GetCachedFile(std::string FilePath) {
+		const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
 		auto resCacheFind = ResourceCache.find(FilePath);
 
 		if (resCacheFind != ResourceCache.end() &&
 			resCacheFind->second.use_count() > 0)
 		{
+			resCacheFind->second->isReferenced = true;
 			return resCacheFind->second;
 		}
 		else
@@ -241,35 +311,41 @@ namespace Ship {
 		return Promise->Resource;
 	}
 
-	std::shared_ptr<ResourcePromise> ResourceMgr::LoadResourceAsync(std::string FilePath) {
+	std::string ResourceMgr::NormalizePath(std::string FilePath) {
 		StringHelper::ReplaceOriginal(FilePath, "/", "\\");
 
 		if (StringHelper::StartsWith(FilePath, "__OTR__"))
 			FilePath = StringHelper::Split(FilePath, "__OTR__")[1];
 
+		return FilePath;
+	}
+
+	std::shared_ptr<ResourcePromise> ResourceMgr::LoadResourceAsync(std::string FilePath) {
+		FilePath = NormalizePath(FilePath);
+
 		std::shared_ptr<ResourcePromise> Promise = std::make_shared<ResourcePromise>();
 
 		const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
 		auto resCacheFind = ResourceCache.find(FilePath);
 		if (resCacheFind == ResourceCache.end() || resCacheFind->second->isDirty/* || !FileData->bIsLoaded*/) {
+			// Someone already asked for it, a prefetch for example, so wait on their load instead of parsing the file twice.
+			auto PendingFind = PendingResources.find(FilePath);
+			if (PendingFind != PendingResources.end()) {
+				return PendingFind->second;
+			}
+
 			if (resCacheFind == ResourceCache.end()) {
 				SPDLOG_TRACE("Cache miss on Resource load: {}", FilePath.c_str());
 			}
 
-			std::shared_ptr<File> FileData = LoadFile(FilePath);
-			Promise->File = FileData;
-
-			if (Promise->File->bHasLoadError)
-			{
-				Promise->bHasResourceLoaded = true;
-			}
-			else
-			{
-				Promise->bHasResourceLoaded = false;
-				ResourceLoadQueue.push(Promise);
-				ResourceLoadNotifier.notify_all();
-			}
+			// Don't block on the File here, the resource workers wait for it so several files can be read at once.
+			Promise->File = QueueFileLoad(FilePath, false);
+			Promise->bHasResourceLoaded = false;
+			PendingResources[FilePath] = Promise;
+			ResourceLoadQueue.push(Promise);
+			ResourceLoadNotifier.notify_one();
 		} else {
+			resCacheFind->second->isReferenced = true;
 			Promise->bHasResourceLoaded = true;
 			Promise->Resource = resCacheFind->second;
 		}
@@ -277,6 +353,51 @@ namespace Ship {
 		return Promise;
 	}
 
+	Resource* ResourceMgr::GetResidentResource(uint64_t Hash) {
+		Resource* Res = ResidentResources.Find(Hash);
+
+		// Dirty resources take the slow path so LoadResource reloads them.
+		if (Res == nullptr || Res->isDirty) {
+			return nullptr;
+		}
+
+		Res->isReferenced = true;
+		return Res;
+	}
+
+	Resource* ResourceMgr::LoadResourceByCRC(uint64_t Hash) {
+		Resource* Res = GetResidentResource(Hash);
+
+		if (Res != nullptr) {
+			return Res;
+		}
+
+		const char* FilePath = HashToString(Hash);
+
+		if (FilePath[0] == '\0') {
+			return nullptr;
+		}
+
+		auto Loaded = LoadResource(FilePath);
+
+		if (Loaded == nullptr) {
+			return nullptr;
+		}
+
+		// Only publish the instance that is still cached. A worker reloading a dirty Resource swaps the cache entry under this lock and
+		// only then removes the old instance from the table, so checking under the lock keeps a replaced Resource from being put back.
+		{
+			const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+			auto resCacheFind = ResourceCache.find(NormalizePath(FilePath));
+
+			if (resCacheFind != ResourceCache.end() && resCacheFind->second == Loaded) {
+				ResidentResources.Insert(Hash, Loaded.get());
+			}
+		}
+
+		return Loaded.get();
+	}
+
 	std::shared_ptr<std::vector<std::shared_ptr<ResourcePromise>>> ResourceMgr::CacheDirectoryAsync(std::string SearchMask) {
 		auto loadedList = std::make_shared<std::vector<std::shared_ptr<ResourcePromise>>>();
 		auto fileList = OTR->ListFiles(SearchMask);
@@ -332,10 +453,164 @@ namespace Ship {
 	}
 
 	void ResourceMgr::InvalidateResourceCache() {
-		ResourceCache.clear();
+		std::map<std::string, std::shared_ptr<Resource>> Invalidated;
+
+		{
+			const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+			Invalidated.swap(ResourceCache);
+			CachedBytes = 0;
+			EvictionHand.clear();
+		}
+
+		ResidentResources.Clear();
+
+		// Resources are destroyed here, outside of the lock, because their destructors call GetCachedFile.
+		Invalidated.clear();
+	}
+
+	void ResourceMgr::SetCacheBudget(size_t Bytes) {
+		const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+		CacheBudget = Bytes;
+	}
+
+	size_t ResourceMgr::GetCachedBytes() {
+		const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+		return CachedBytes;
+	}
+
+	void ResourceMgr::SetDeferReplacedRelease(bool bDefer) {
+		const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+		bDeferReplacedRelease = bDefer;
+	}
+
+	std::vector<std::shared_ptr<Resource>> ResourceMgr::TakeReplacedResources() {
+		std::vector<std::shared_ptr<Resource>> Taken;
+
+		const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+		Taken.swap(ReplacedResources);
+
+		return Taken;
+	}
+
+	size_t ResourceMgr::EvictResources() {
+		std::vector<std::shared_ptr<Resource>> Evicted;
+
+		{
+			const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+
+			if (CacheBudget == 0 || ResourceCache.empty()) {
+				return 0;
+			}
+
+			// The game converts Resources into cachedGameAssets long after they were counted, so the total is redone here from scratch.
+			CachedBytes = 0;
+
+			for (const auto& Entry : ResourceCache) {
+				if (Entry.second != nullptr) {
+					CachedBytes += Entry.second->cacheSize + Entry.second->cachedGameAssetSize;
+				}
+			}
+
+			if (CachedBytes <= CacheBudget) {
+				return 0;
+			}
+
+			// CLOCK sweep: a Resource that was hit since the last pass gets a second chance, one that only the cache holds and wasn't hit is dropped.
+			// Two laps are enough for every bit to have been cleared once.
+			auto Hand = ResourceCache.lower_bound(EvictionHand);
+			size_t Visited = 0;
+			const size_t MaxVisits = ResourceCache.size() * 2;
+
+			while (CachedBytes > CacheBudget && Visited < MaxVisits && !ResourceCache.empty()) {
+				if (Hand == ResourceCache.end()) {
+					Hand = ResourceCache.begin();
+				}
+
+				Visited++;
+
+				std::shared_ptr<Resource>& Res = Hand->second;
+
+				if (Res == nullptr || Res.use_count() > 1 || Res->isReferenced.exchange(false)) {
+					Hand++;
+					continue;
+				}
+
+				CachedBytes -= Res->cacheSize + Res->cachedGameAssetSize;
+				Evicted.push_back(Res);
+				Hand = ResourceCache.erase(Hand);
+			}
+
+			EvictionHand = Hand != ResourceCache.end() ? Hand->first : "";
+
+			if (!Evicted.empty()) {
+				// One pass over the table is cheaper than removing each Resource, everything still resident gets re-added on its next lookup.
+				ResidentResources.Clear();
+				SPDLOG_INFO("Evicted {} Resources, {} bytes cached of a {} byte budget", Evicted.size(), CachedBytes, CacheBudget);
+			}
+		}
+
+		// Resources are destroyed here, outside of the lock, because their destructors call GetCachedFile.
+		const size_t EvictedCount = Evicted.size();
+		Evicted.clear();
+
+		return EvictedCount;
+	}
+
+	void ResourceMgr::RequestPatchRescan() {
+		bPatchRescanRequested = true;
+	}
+
+	size_t ResourceMgr::RefreshPatches() {
+		const std::vector<std::string> Changed = OTR->RefreshPatchMPQs(bPatchRescanRequested.exchange(false));
+
+		if (Changed.empty()) {
+			return 0;
+		}
+
+		// The archive reports lookup keys, the caches hold paths the way the game spelled them.
+		const std::unordered_set<std::string> ChangedKeys(Changed.begin(), Changed.end());
+		std::vector<std::shared_ptr<Resource>> Invalidated;
+
+		{
+			const std::lock_guard<std::mutex> FileLock(FileLoadMutex);
+
+			for (auto FileCacheIt = FileCache.begin(); FileCacheIt != FileCache.end();) {
+				if (ChangedKeys.contains(Archive::GetLookupKey(FileCacheIt->first))) {
+					FileCacheIt = FileCache.erase(FileCacheIt);
+				} else {
+					++FileCacheIt;
+				}
+			}
+		}
+
+		{
+			const std::lock_guard<std::mutex> ResLock(ResourceLoadMutex);
+
+			for (auto ResCacheIt = ResourceCache.begin(); ResCacheIt != ResourceCache.end();) {
+				if (!ChangedKeys.contains(Archive::GetLookupKey(ResCacheIt->first))) {
+					++ResCacheIt;
+					continue;
+				}
+
+				if (ResCacheIt->second != nullptr) {
+					CachedBytes -= ResCacheIt->second->cacheSize;
+				}
+
+				Invalidated.push_back(ResCacheIt->second);
+				ResCacheIt = ResourceCache.erase(ResCacheIt);
+			}
+		}
+
+		ResidentResources.Clear();
+		SPDLOG_INFO("Patch archives changed, {} files now resolve elsewhere and {} Resources were invalidated", Changed.size(), Invalidated.size());
+
+		// Resources are destroyed here, outside of the lock, because their destructors call GetCachedFile.
+		Invalidated.clear();
+
+		return Changed.size();
 	}
 
-	std::string ResourceMgr::HashToString(uint64_t Hash) {
+	const char* ResourceMgr::HashToString(uint64_t Hash) {
 		return OTR->HashToString(Hash);
 	}
 }
\ No newline at end of file
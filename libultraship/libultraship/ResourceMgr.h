@@ -4,19 +4,27 @@
 #include <string>
 #include <thread>
 #include <queue>
+#include <vector>
 #include "Resource.h"
 #include "GlobalCtx2.h"
+#include "ResidentResourceTable.h"
 
 namespace Ship
 {
 	class Archive;
 	class File;
 
-	// Resource manager caches any and all files it comes across into memory. This will be unoptimal in the future when modifications have gigabytes of assets.
-	// It works with the original game's assets because the entire ROM is 64MB and fits into RAM of any semi-modern PC.
+	// Resource manager caches any and all files it comes across into memory. With a cache budget set, EvictResources drops the least recently used
+	// Resources nobody else holds until the cache fits again, counting what their parsed data and cachedGameAssets take up.
+	// Only shared_ptr references keep a Resource from being evicted. The C side of the game gets raw pointers into Resources, so EvictResources
+	// must only be called where none of those can be alive, which is between game states: every raw pointer the game asks for lives in the game
+	// state's memory or shorter. Anything that holds on to Resource memory beyond that has to keep a shared_ptr to the Resource, like the message
+	// tables do, and a cachedGameAsset that points into other Resources keeps them in assetDependencies.
+	// Files requested through LoadFile are handed out raw as well and stay cached, the Files read for a Resource are released once it is parsed.
 	class ResourceMgr {
 	public:
-		ResourceMgr(std::shared_ptr<GlobalCtx2> Context, std::string MainPath, std::string PatchesPath);
+		// LoadThreadCount is the number of workers for both the file and resource stages, 0 picks one per hardware thread.
+		ResourceMgr(std::shared_ptr<GlobalCtx2> Context, std::string MainPath, std::string PatchesPath, uint32_t LoadThreadCount = 0);
 		~ResourceMgr();
 
 		bool IsRunning();
@@ -25,9 +33,22 @@ namespace Ship
 		std::shared_ptr<Archive> GetArchive() { return OTR; }
 		std::shared_ptr<GlobalCtx2> GetContext() { return Context.lock(); }
 
-		std::string HashToString(uint64_t Hash);
+		const char* HashToString(uint64_t Hash);
 
 		void InvalidateResourceCache();
+		void SetCacheBudget(size_t Bytes);
+		// Cached bytes as of the last load or eviction, cachedGameAssets made since are only counted by the next EvictResources.
+		size_t GetCachedBytes();
+		size_t EvictResources();
+		// Rescans the patches directory if it changed and drops the cached Files and Resources whose contents now come from another archive.
+		// Like EvictResources, only call it where no raw pointers into Resources are alive.
+		size_t RefreshPatches();
+		// Makes the next RefreshPatches rescan the patches directory even if it looks unchanged, safe to call from any thread.
+		void RequestPatchRescan();
+		// A Resource replaced by reloading a dirty one is normally destroyed right away. With a renderer working on another thread than the game
+		// it may still be reading it, so while deferred replaced Resources are kept until taken. The caller destroys them outside of any lock.
+		void SetDeferReplacedRelease(bool bDefer);
+		std::vector<std::shared_ptr<Resource>> TakeReplacedResources();
 		
 		uint32_t GetGameVersion();
 		void SetGameVersion(uint32_t newGameVersion);
@@ -36,25 +57,41 @@ namespace Ship
 		std::shared_ptr<Ship::Resource> GetCachedFile(std::string FilePath);
 		std::shared_ptr<Resource> LoadResource(std::string FilePath);
 		std::shared_ptr<ResourcePromise> LoadResourceAsync(std::string FilePath);
+		// Lookup by the CRC64 of the path, as embedded in display lists. Does not lock or allocate once the Resource is resident.
+		Resource* GetResidentResource(uint64_t Hash);
+		// Same as above, but loads the Resource through LoadResource when it isn't resident yet.
+		Resource* LoadResourceByCRC(uint64_t Hash);
 		std::shared_ptr<std::vector<std::shared_ptr<Resource>>> CacheDirectory(std::string SearchMask);
 		std::shared_ptr<std::vector<std::shared_ptr<ResourcePromise>>> CacheDirectoryAsync(std::string SearchMask);
 		std::shared_ptr<std::vector<std::shared_ptr<Resource>>> DirtyDirectory(std::string SearchMask);
 
 	protected:
+		std::shared_ptr<File> QueueFileLoad(const std::string& FilePath, bool bCacheFile);
 		void Start();
 		void Stop();
 		void LoadFileThread();
 		void LoadResourceThread();
+		void FinishPending(const std::shared_ptr<ResourcePromise>& Promise);
+		static std::string NormalizePath(std::string FilePath);
 
 	private:
 		std::weak_ptr<GlobalCtx2> Context;
 		std::map<std::string, std::shared_ptr<File>> FileCache;
 		std::map<std::string, std::shared_ptr<Resource>> ResourceCache;
+		std::map<std::string, std::shared_ptr<ResourcePromise>> PendingResources;
+		ResidentResourceTable ResidentResources;
+		size_t CacheBudget;
+		size_t CachedBytes;
+		std::string EvictionHand;
+		bool bDeferReplacedRelease;
+		std::atomic<bool> bPatchRescanRequested;
+		std::vector<std::shared_ptr<Resource>> ReplacedResources;
 		std::queue<std::shared_ptr<File>> FileLoadQueue;
 		std::queue<std::shared_ptr<ResourcePromise>> ResourceLoadQueue;
 		std::shared_ptr<Archive> OTR;
-		std::shared_ptr<std::thread> FileLoadThread;
-		std::shared_ptr<std::thread> ResourceLoadThread;
+		std::vector<std::shared_ptr<std::thread>> FileLoadThreads;
+		std::vector<std::shared_ptr<std::thread>> ResourceLoadThreads;
+		uint32_t LoadThreadCount;
 		std::mutex FileLoadMutex;
 		std::mutex ResourceLoadMutex;
 		std::condition_variable FileLoadNotifier;
@@ -26,4 +26,16 @@ namespace Ship
             skel->limbTable.push_back(limbPath);
         }
     }
+
+    size_t Skeleton::GetMemorySize()
+    {
+        size_t size = sizeof(Skeleton) + limbTable.capacity() * sizeof(std::string);
+
+        for (const auto& limbPath : limbTable)
+        {
+            size += limbPath.capacity();
+        }
+
+        return size;
+    }
 }
\ No newline at end of file
@@ -27,5 +27,7 @@ namespace Ship
 		int dListCount;
 		LimbType limbTableType;
 		std::vector<std::string> limbTable;
+
+		size_t GetMemorySize() override;
 	};
 }
\ No newline at end of file
@@ -78,4 +78,16 @@ namespace Ship
         limb->childIndex = reader->ReadUByte();
         limb->siblingIndex = reader->ReadUByte();
     }
+
+    size_t SkeletonLimb::GetMemorySize()
+    {
+        size_t size = sizeof(SkeletonLimb) + skinData.capacity() * sizeof(Struct_800A598C);
+
+        for (const auto& modif : skinData)
+        {
+            size += modif.unk_8_arr.capacity() * sizeof(Struct_800A57C0) + modif.unk_C_arr.capacity() * sizeof(Struct_800A598C_2);
+        }
+
+        return size;
+    }
 }
\ No newline at end of file
@@ -80,5 +80,6 @@ namespace Ship
 		int16_t transX, transY, transZ;
 		uint8_t childIndex, siblingIndex;
 
+		size_t GetMemorySize() override;
 	};
 }
\ No newline at end of file
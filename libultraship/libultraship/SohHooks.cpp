@@ -6,9 +6,10 @@
 #include <iostream>
 
 std::map<std::string, std::vector<HookFunc>> listeners;
-std::string hookName;
-std::map<std::string, void*> initArgs;
-std::map<std::string, void*> hookArgs;
+// A hook is bound, initialized and called in three steps, so the call being built is kept per thread.
+thread_local std::string hookName;
+thread_local std::map<std::string, void*> initArgs;
+thread_local std::map<std::string, void*> hookArgs;
 
 /*
 #############################
@@ -23,9 +24,13 @@ namespace ModInternal {
     }
 
     bool handleHook(std::shared_ptr<HookCall> call) {
-        std::string hookName = std::string(call->name);
-        for (int l = 0; l < listeners[hookName].size(); l++) {
-            (listeners[hookName][l])(call);
+        auto hookListeners = listeners.find(call->name);
+        if (hookListeners == listeners.end()) {
+            return call->cancelled;
+        }
+
+        for (int l = 0; l < hookListeners->second.size(); l++) {
+            (hookListeners->second[l])(call);
         }
         return call->cancelled;
     }
@@ -65,6 +65,8 @@ namespace SohImGui {
         case Backend::DX11:
             ImGui_ImplWin32_Init(impl.dx11.window);
             break;
+        case Backend::Null:
+            break;
         }
     }
 
@@ -76,6 +78,13 @@ namespace SohImGui {
         case Backend::DX11:
             ImGui_ImplDX11_Init(static_cast<ID3D11Device*>(impl.dx11.device), static_cast<ID3D11DeviceContext*>(impl.dx11.device_context));
             break;
+        case Backend::Null: {
+            // The menus are still built every frame, so the font atlas has to exist even though nothing draws it.
+            unsigned char* pixels;
+            int width, height;
+            io->Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+            break;
+        }
         }
     }
 
@@ -87,6 +96,8 @@ namespace SohImGui {
         case Backend::DX11:
             ImGui_ImplWin32_WndProcHandler(static_cast<HWND>(event.win32.handle), event.win32.msg, event.win32.wparam, event.win32.lparam);
             break;
+        case Backend::Null:
+            break;
         }
     }
 
@@ -98,6 +109,12 @@ namespace SohImGui {
         case Backend::DX11:
             ImGui_ImplWin32_NewFrame();
             break;
+        case Backend::Null: {
+            const std::shared_ptr<Window> wnd = GlobalCtx2::GetInstance()->GetWindow();
+            io->DisplaySize = ImVec2((float)wnd->GetCurrentWidth(), (float)wnd->GetCurrentHeight());
+            io->DeltaTime = 1.0f / 60.0f;
+            break;
+        }
         }
     }
 
@@ -109,6 +126,8 @@ namespace SohImGui {
         case Backend::DX11:
             ImGui_ImplDX11_NewFrame();
             break;
+        case Backend::Null:
+            break;
         }
     }
 
@@ -120,6 +139,8 @@ namespace SohImGui {
         case Backend::DX11:
             ImGui_ImplDX11_RenderDrawData(data);
             break;
+        case Backend::Null:
+            break;
         }
     }
 
@@ -127,6 +148,9 @@ namespace SohImGui {
         switch (impl.backend) {
         case Backend::DX11:
             return true;
+        case Backend::SDL:
+        case Backend::Null:
+            break;
         }
         return false;
     }
@@ -457,6 +481,21 @@ namespace SohImGui {
                     needs_save = true;
                 }
 
+                if (ImGui::Checkbox("Incremental Dynamic Collision", &Game::Settings.debug.incremental_dynapoly)) {
+                    CVar_SetS32("gIncrementalDynaPoly", Game::Settings.debug.incremental_dynapoly);
+                    needs_save = true;
+                }
+
+                if (ImGui::Checkbox("Flattened Static Collision", &Game::Settings.debug.flat_static_collision)) {
+                    CVar_SetS32("gFlatStaticCollision", Game::Settings.debug.flat_static_collision);
+                    needs_save = true;
+                }
+
+                if (ImGui::Checkbox("Collider Broad Phase", &Game::Settings.debug.collision_broad_phase)) {
+                    CVar_SetS32("gCollisionBroadPhase", Game::Settings.debug.collision_broad_phase);
+                    needs_save = true;
+                }
+
                 ImGui::EndMenu();
             }
 
@@ -554,6 +593,14 @@ namespace SohImGui {
 
             ImGui::Text("Platform: Windows");
             ImGui::Text("Status: %.3f ms/frame (%.1f FPS)", 1000.0f / framerate, framerate);
+
+            const GfxTextureCacheStats textures = gfx_texture_cache_get_stats();
+            ImGui::Text("Texture cache: %zu entries, %zu textures, %.1f / %.1f MB", textures.entries, textures.textures,
+                        textures.bytes / (1024.0f * 1024.0f), textures.budget / (1024.0f * 1024.0f));
+            ImGui::Text("Hits: %llu  Misses: %llu  Shared: %llu", (unsigned long long)textures.hits, (unsigned long long)textures.misses,
+                        (unsigned long long)textures.dedup_hits);
+            ImGui::Text("Uploads: %llu (%.1f MB)  Evictions: %llu", (unsigned long long)textures.uploads,
+                        textures.upload_bytes / (1024.0f * 1024.0f), (unsigned long long)textures.evictions);
             ImGui::End();
             ImGui::PopStyleColor();
         }
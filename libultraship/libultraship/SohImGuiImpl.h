@@ -12,7 +12,8 @@ struct GameAsset {
 namespace SohImGui {
     enum class Backend {
         DX11,
-        SDL
+        SDL,
+        Null
     };
 
     enum class Dialogues {
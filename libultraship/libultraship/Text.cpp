@@ -20,3 +20,15 @@ void Ship::TextV0::ParseFileBinary(BinaryReader* reader, Resource* res)
 		txt->messages.push_back(entry);
 	}
 }
+
+size_t Ship::Text::GetMemorySize()
+{
+	size_t size = sizeof(Text) + messages.capacity() * sizeof(MessageEntry);
+
+	for (const auto& entry : messages)
+	{
+		size += entry.msg.capacity();
+	}
+
+	return size;
+}
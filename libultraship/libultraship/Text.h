@@ -23,5 +23,7 @@ namespace Ship
 	{
 	public:
 		std::vector<MessageEntry> messages;
+
+		size_t GetMemorySize() override;
 	};
 }
\ No newline at end of file
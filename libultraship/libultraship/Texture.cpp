@@ -17,7 +17,11 @@ namespace Ship
         tex->imageDataSize = dataSize;
         tex->imageData = new uint8_t[dataSize];
 
-        for (uint32_t i = 0; i < dataSize; i++)
-            tex->imageData[i] = reader->ReadUByte();
+        reader->ReadBytes((char*)tex->imageData, dataSize);
+    }
+
+    size_t Texture::GetMemorySize()
+    {
+        return sizeof(Texture) + imageDataSize;
     }
 }
\ No newline at end of file
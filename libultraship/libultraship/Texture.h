@@ -37,5 +37,7 @@ namespace Ship
 		uint32_t imageDataSize;
 		uint8_t* imageData;
 		uint8_t* paletteData;
+
+		size_t GetMemorySize() override;
 	};
 }
\ No newline at end of file
@@ -81,7 +81,7 @@ namespace Ship {
 		if (!this->TextureCache.contains(path)) this->TextureCache[path].resize(10);
 
 		TextureCacheKey key = { orig_addr, { }, static_cast<uint8_t>(fmt), static_cast<uint8_t>(siz), static_cast<uint8_t>(palette) };
-		TextureCacheValue value = { api->new_texture(), 0, 0, false };
+		TextureCacheValue value = { api->new_texture() };
 		const auto entry = new TextureCacheNode(key, value);
 		api->select_texture(tile, entry->second.texture_id);
 		api->set_sampler_parameters(tile, false, 0, 0);
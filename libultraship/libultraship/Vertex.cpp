@@ -7,21 +7,14 @@ namespace Ship
 		ResourceFile::ParseFileBinary(reader, res);
 
 		uint32_t count = reader->ReadUInt32();
-		vtx->vtxList.reserve(count);
 
-		for (uint32_t i = 0; i < count; i++) {
-			Vtx data;
-			data.x = reader->ReadInt16();
-			data.y = reader->ReadInt16();
-			data.z = reader->ReadInt16();
-			data.flag = reader->ReadUInt16();
-			data.s = reader->ReadInt16();
-			data.t = reader->ReadInt16();
-			data.r = reader->ReadUByte();
-			data.g = reader->ReadUByte();
-			data.b = reader->ReadUByte();
-			data.a = reader->ReadUByte();
-			vtx->vtxList.push_back(data);
-		}
+		// Vtx has the same layout as the exported vertices, so the whole list is read in one go.
+		vtx->vtxList.resize(count);
+		reader->ReadBytes((char*)vtx->vtxList.data(), count * sizeof(Vtx));
+	}
+
+	size_t Vertex::GetMemorySize()
+	{
+		return sizeof(Vertex) + vtxList.capacity() * sizeof(Vtx);
 	}
 }
\ No newline at end of file
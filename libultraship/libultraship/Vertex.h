@@ -13,6 +13,8 @@ namespace Ship
 		uint8_t r, g, b, a;
 	};
 
+	static_assert(sizeof(Vtx) == 16, "Vtx must match the exported vertex layout");
+
 	class VertexV0 : public ResourceFile
 	{
 	public:
@@ -23,5 +25,7 @@ namespace Ship
 	{
 	public:
 		std::vector<Vtx> vtxList;
+
+		size_t GetMemorySize() override;
 	};
 }
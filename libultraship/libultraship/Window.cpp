@@ -15,6 +15,7 @@
 #include "Lib/Fast3D/gfx_pc.h"
 #include "Lib/Fast3D/gfx_sdl.h"
 #include "Lib/Fast3D/gfx_opengl.h"
+#include "Lib/Fast3D/gfx_capture.h"
 #include "stox.h"
 #include <SDL2/SDL.h>
 #include <map>
@@ -117,32 +118,25 @@ extern "C" {
     }
 
     char* ResourceMgr_GetNameByCRC(uint64_t crc, char* alloc) {
-        std::string hashStr = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->HashToString(crc);
-        strcpy(alloc, hashStr.c_str());
-        return (char*)hashStr.c_str();
+        const char* hashStr = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->HashToString(crc);
+        strcpy(alloc, hashStr);
+        return (char*)hashStr;
     }
 
     Vtx* ResourceMgr_LoadVtxByCRC(uint64_t crc) {
-        std::string hashStr = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->HashToString(crc);
+        auto res = (Ship::Array*)Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResourceByCRC(crc);
 
-        if (hashStr != "") {
-            auto res = std::static_pointer_cast<Ship::Array>(Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResource(hashStr));
-
-            //if (res != nullptr)
-                return (Vtx*)res->vertices.data();
-            //else
-                //return (Vtx*)Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadFile(hashStr)->buffer.get();
-        }
-        else {
+        if (res != nullptr) {
+            return (Vtx*)res->vertices.data();
+        } else {
             return nullptr;
         }
     }
 
     int32_t* ResourceMgr_LoadMtxByCRC(uint64_t crc) {
-        std::string hashStr = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->HashToString(crc);
+        auto res = (Ship::Matrix*)Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResourceByCRC(crc);
 
-        if (hashStr != "") {
-            auto res = std::static_pointer_cast<Ship::Matrix>(Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResource(hashStr));
+        if (res != nullptr) {
             return (int32_t*)res->mtx.data();
         } else {
             return nullptr;
@@ -150,10 +144,9 @@ extern "C" {
     }
 
     Gfx* ResourceMgr_LoadGfxByCRC(uint64_t crc) {
-        std::string hashStr = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->HashToString(crc);
+        auto res = (Ship::DisplayList*)Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResourceByCRC(crc);
 
-        if (hashStr != "") {
-            auto res = std::static_pointer_cast<Ship::DisplayList>(Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResource(hashStr));
+        if (res != nullptr) {
             return (Gfx*)&res->instructions[0];
         } else {
             return nullptr;
@@ -161,32 +154,41 @@ extern "C" {
     }
 
     char* ResourceMgr_LoadTexByCRC(uint64_t crc)  {
-        const std::string hashStr = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->HashToString(crc);
+        const auto resMgr = Ship::GlobalCtx2::GetInstance()->GetResourceManager();
+        auto res = static_cast<Ship::Texture*>(resMgr->GetResidentResource(crc));
 
-        if (!hashStr.empty())  {
-            const auto res = static_cast<Ship::Texture*>(Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResource(hashStr).get());
+        // The hook only fires when the texture is first resolved, it edits the resident Texture so later hits see its changes.
+        if (res == nullptr) {
+            const char* hashStr = resMgr->HashToString(crc);
+
+            if (hashStr[0] == '\0') {
+                return nullptr;
+            }
+
+            res = static_cast<Ship::Texture*>(resMgr->LoadResourceByCRC(crc));
+
+            if (res == nullptr) {
+                return nullptr;
+            }
 
             ModInternal::bindHook(LOAD_TEXTURE);
             ModInternal::initBindHook(2,
-                HookParameter({.name = "path", .parameter = (void*)hashStr.c_str() }),
+                HookParameter({.name = "path", .parameter = (void*)hashStr }),
                 HookParameter({.name = "texture", .parameter = static_cast<void*>(&res->imageData) })
             );
             ModInternal::callBindHook(0);
-
-            return reinterpret_cast<char*>(res->imageData);
-        } else {
-            return nullptr;
         }
+
+        return reinterpret_cast<char*>(res->imageData);
     }
 
-    void ResourceMgr_RegisterResourcePatch(uint64_t hash, uint32_t instrIndex, uintptr_t origData)
+    // The patch is kept by the Resource the instruction now points into, so evicting or replacing that Resource restores the display list.
+    void ResourceMgr_RegisterResourcePatch(uint64_t hash, uint32_t instrIndex, uint64_t origData, uint64_t targetHash)
     {
-        std::string hashStr = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->HashToString(hash);
+        auto res = Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResourceByCRC(targetHash);
 
-        if (hashStr != "")
+        if (res != nullptr)
         {
-            auto res = (Ship::Texture*)Ship::GlobalCtx2::GetInstance()->GetResourceManager()->LoadResource(hashStr).get();
-
             Ship::Patch patch;
             patch.crc = hash;
             patch.index = instrIndex;
@@ -248,8 +250,11 @@ namespace Ship {
         WmApi = nullptr;
         RenderingApi = nullptr;
         bIsFullscreen = false;
+        bRenderPipeline = false;
+        dwAudioFramesAhead = 0;
         dwWidth = 320;
         dwHeight = 240;
+        dwReplayFrames = 0;
     }
 
     Window::~Window() {
@@ -267,20 +272,38 @@ namespace Ship {
         dwWidth = Ship::stoi(Conf["WINDOW"]["FULLSCREEN WIDTH"], 1920);
         dwHeight = Ship::stoi(Conf["WINDOW"]["FULLSCREEN HEIGHT"], 1080);
         dwMenubar = Ship::stoi(Conf["WINDOW"]["menubar"], 0);
+        bRenderPipeline = Ship::stob(Conf["WINDOW"]["RENDER PIPELINE"], false);
+        dwAudioFramesAhead = Ship::stoi(Conf["WINDOW"]["AUDIO FRAMES AHEAD"], 2);
+        ReplayPath = Conf["WINDOW"]["GFX REPLAY"];
+        dwReplayFrames = Ship::stoi(Conf["WINDOW"]["GFX REPLAY FRAMES"], 600);
         const std::string& gfx_backend = Conf["WINDOW"]["GFX BACKEND"];
         SetWindowManager(&WmApi, &RenderingApi, gfx_backend);
 
         gfx_init(WmApi, RenderingApi, GetContext()->GetName().c_str(), bIsFullscreen);
+        gfx_texture_cache_configure((size_t)std::max(Ship::stoi(Conf["WINDOW"]["TEXTURE CACHE MB"], 256), 0) * 1024 * 1024,
+                                    Ship::stob(Conf["WINDOW"]["TEXTURE DEDUP"], true));
         WmApi->set_fullscreen_changed_callback(Window::OnFullscreenChanged);
         WmApi->set_keyboard_callbacks(Window::KeyDown, Window::KeyUp, Window::AllKeysUp);
     }
 
     void Window::RunCommands(Gfx* Commands) {
+        StartFrame();
+        RenderFrame(Commands);
+    }
+
+    void Window::StartFrame() {
         gfx_start_frame();
+    }
+
+    void Window::RenderFrame(Gfx* Commands) {
         gfx_run(Commands);
         gfx_end_frame();
     }
 
+    void Window::SetPixelDepthDeferred(bool bDeferred) {
+        gfx_set_pixel_depth_deferred(bDeferred);
+    }
+
     void Window::SetFrameDivisor(int divisor) {
         gfx_set_framedivisor(divisor);
         //gfx_set_framedivisor(0);
@@ -313,8 +336,26 @@ namespace Ship {
     }
 
     void Window::MainLoop(void (*MainFunction)(void)) {
+        if (!ReplayPath.empty()) {
+            RunReplay();
+        }
+
         WmApi->main_loop(MainFunction);
     }
+
+    void Window::RunReplay() {
+        GfxReplayStats stats;
+
+        if (!gfx_replay(ReplayPath, dwReplayFrames, &stats)) {
+            SPDLOG_ERROR("Failed to replay frame capture {}", ReplayPath);
+            exit(EXIT_FAILURE);
+        }
+
+        SPDLOG_INFO("Replayed {} ({} commands) {} times: {:.0f} ns/frame, {:.0f} triangles/s, {} flushes, {} triangles, {} texture imports",
+                    ReplayPath, stats.commands, stats.frames, stats.ns_per_frame, stats.triangles_per_second, stats.flushes,
+                    stats.triangles, stats.texture_imports);
+        exit(EXIT_SUCCESS);
+    }
     bool Window::KeyUp(int32_t dwScancode) {
         std::shared_ptr<ConfigFile> pConf = GlobalCtx2::GetInstance()->GetConfig();
         ConfigFile& Conf = *pConf.get();
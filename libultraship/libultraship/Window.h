@@ -19,6 +19,10 @@ namespace Ship {
 			void MainLoop(void (*MainFunction)(void));
 			void Init();
 			void RunCommands(Gfx* Commands);
+			// RunCommands split in two, for a game that builds its next frame between them. StartFrame handles input and the menus.
+			void StartFrame();
+			void RenderFrame(Gfx* Commands);
+			void SetPixelDepthDeferred(bool bDeferred);
 			void SetFrameDivisor(int divisor);
 			void GetPixelDepthPrepare(float x, float y);
 			uint16_t GetPixelDepth(float x, float y);
@@ -27,6 +31,8 @@ namespace Ship {
 			void ShowCursor(bool hide);
 
 			bool IsFullscreen() { return bIsFullscreen; }
+			bool IsRenderPipelined() { return bRenderPipeline; }
+			uint32_t GetAudioFramesAhead() { return dwAudioFramesAhead; }
 			uint32_t GetCurrentWidth();
 			uint32_t GetCurrentHeight();
 			uint32_t dwMenubar;
@@ -40,6 +46,8 @@ namespace Ship {
 			static void AllKeysUp(void);
 			static void OnFullscreenChanged(bool bIsNowFullscreen);
 			void SetAudioPlayer();
+			// Replays the frame capture set in the config instead of running the game, then exits with the result.
+			void RunReplay();
 
 			std::weak_ptr<GlobalCtx2> Context;
 			std::shared_ptr<AudioPlayer> APlayer;
@@ -47,8 +55,12 @@ namespace Ship {
 			GfxWindowManagerAPI* WmApi;
 			GfxRenderingAPI* RenderingApi;
 			bool bIsFullscreen;
+			bool bRenderPipeline;
+			uint32_t dwAudioFramesAhead;
 			uint32_t dwWidth;
 			uint32_t dwHeight;
+			std::string ReplayPath;
+			uint32_t dwReplayFrames;
 	};
 }
 
@@ -6,6 +6,7 @@
 #include "Lib/Fast3D/gfx_opengl.h"
 #include "Lib/Fast3D/gfx_direct3d11.h"
 #include "Lib/Fast3D/gfx_direct3d12.h"
+#include "Lib/Fast3D/gfx_null.h"
 #include "Lib/Fast3D/gfx_window_manager_api.h"
 
 #include <string>
@@ -56,4 +57,8 @@ void SetWindowManager(struct GfxWindowManagerAPI** WmApi, struct GfxRenderingAPI
     }
 #endif
 #endif
+    if (gfx_backend == "null") {
+        *RenderingApi = &gfx_null_api;
+        *WmApi = &gfx_null_wapi;
+    }
 }
\ No newline at end of file
@@ -1,9 +1,31 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 #include "mixer.h"
 
+// SSE2 is part of every x64 target and AArch64 always has NEON, so the vector kernels are picked at build time.
+// mixer_set_simd switches back to the scalar ones, which stay the reference the vector ones must match bit for bit.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define MIXER_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(MIXER_SSE2) || defined(MIXER_NEON)
+#define MIXER_SIMD 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MIXER_THREAD_LOCAL __declspec(thread)
+#else
+#define MIXER_THREAD_LOCAL _Thread_local
+#endif
+
 #pragma GCC optimize ("unroll-loops")
 
 #define ROUND_UP_64(v) (((v) + 63) & ~63)
@@ -16,7 +38,7 @@
 #define BUF_U8(a) (rspa.buf.as_u8 + ((a) - 0x3C0))
 #define BUF_S16(a) (rspa.buf.as_s16 + ((a) - 0x3C0) / sizeof(int16_t))
 
-static struct {
+static struct RspAudio {
     uint16_t in;
     uint16_t out;
     uint16_t nbytes;
@@ -29,6 +51,10 @@ static struct {
     ADPCM_STATE *adpcm_loop_state;
 
     int16_t adpcm_table[8][2][8];
+#ifdef MIXER_SIMD
+    // Every decoded sample as a sum of 10 columns times the two previous outputs and the 8 new samples, see aADPCMdec_simd
+    int16_t adpcm_columns[8][10][8];
+#endif
 
     uint16_t filter_count;
     int16_t filter[8];
@@ -37,7 +63,11 @@ static struct {
         int16_t as_s16[DMEM_BUF_SIZE / sizeof(int16_t)];
         uint8_t as_u8[DMEM_BUF_SIZE];
     } buf;
-} rspa;
+} rspa_audio;
+
+// mixer_benchmark points its own thread at a private copy, so the audio thread can keep mixing meanwhile
+static MIXER_THREAD_LOCAL struct RspAudio *rspa_current = &rspa_audio;
+#define rspa (*rspa_current)
 
 static int16_t resample_table[64][4] = {
     {0x0c39, 0x66ad, 0x0d46, 0xffdf}, {0x0b39, 0x6696, 0x0e5f, 0xffd8},
@@ -105,8 +135,15 @@ void aSaveBufferImpl(uint16_t source_addr, int16_t *dest_addr, uint16_t nbytes)
     memcpy(dest_addr, BUF_S16(source_addr), ROUND_DOWN_16(nbytes));
 }
 
+#ifdef MIXER_SIMD
+static void aADPCM_build_columns(int entries);
+#endif
+
 void aLoadADPCMImpl(int num_entries_times_16, const int16_t *book_source_addr) {
     memcpy(rspa.adpcm_table, book_source_addr, num_entries_times_16);
+#ifdef MIXER_SIMD
+    aADPCM_build_columns((num_entries_times_16 + sizeof(rspa.adpcm_table[0]) - 1) / sizeof(rspa.adpcm_table[0]));
+#endif
 }
 
 void aSetBufferImpl(uint8_t flags, uint16_t in, uint16_t out, uint16_t nbytes) {
@@ -115,7 +152,7 @@ void aSetBufferImpl(uint8_t flags, uint16_t in, uint16_t out, uint16_t nbytes) {
     rspa.nbytes = nbytes;
 }
 
-void aInterleaveImpl(uint16_t dest, uint16_t left, uint16_t right, uint16_t c) {
+static void aInterleave_scalar(uint16_t dest, uint16_t left, uint16_t right, uint16_t c) {
     int count = ROUND_UP_8(c) / sizeof(int16_t) / 4;
     int16_t *l = BUF_S16(left);
     int16_t *r = BUF_S16(right);
@@ -150,7 +187,7 @@ void aSetLoopImpl(ADPCM_STATE *adpcm_loop_state) {
     rspa.adpcm_loop_state = adpcm_loop_state;
 }
 
-void aADPCMdecImpl(uint8_t flags, ADPCM_STATE state) {
+static void aADPCMdec_scalar(uint8_t flags, ADPCM_STATE state) {
     uint8_t *in = BUF_U8(rspa.in);
     int16_t *out = BUF_S16(rspa.out);
     int nbytes = ROUND_UP_32(rspa.nbytes);
@@ -201,7 +238,7 @@ void aADPCMdecImpl(uint8_t flags, ADPCM_STATE state) {
     memcpy(state, out - 16, 16 * sizeof(int16_t));
 }
 
-void aResampleImpl(uint8_t flags, uint16_t pitch, RESAMPLE_STATE state) {
+static void aResample_scalar(uint8_t flags, uint16_t pitch, RESAMPLE_STATE state) {
     int16_t tmp[16];
     int16_t *in_initial = BUF_S16(rspa.in);
     int16_t *in = in_initial;
@@ -264,7 +301,7 @@ void aEnvSetup2Impl(uint16_t initial_vol_left, uint16_t initial_vol_right) {
     rspa.vol[1] = initial_vol_right;
 }
 
-void aEnvMixerImpl(uint16_t in_addr, uint16_t n_samples, bool swap_reverb,
+static void aEnvMixer_scalar(uint16_t in_addr, uint16_t n_samples, bool swap_reverb,
 				   bool neg_3, bool neg_2,
                    bool neg_left, bool neg_right,
                    int32_t wet_dry_addr, u32 unk)
@@ -300,7 +337,7 @@ void aEnvMixerImpl(uint16_t in_addr, uint16_t n_samples, bool swap_reverb,
     } while (n > 0);
 }
 
-void aMixImpl(uint16_t count, int16_t gain, uint16_t in_addr, uint16_t out_addr) {
+static void aMix_scalar(uint16_t count, int16_t gain, uint16_t in_addr, uint16_t out_addr) {
     int nbytes = ROUND_UP_32(ROUND_DOWN_16(count << 4));
     int16_t *in = BUF_S16(in_addr);
     int16_t *out = BUF_S16(out_addr);
@@ -364,7 +401,7 @@ void aS8DecImpl(uint8_t flags, ADPCM_STATE state) {
     memcpy(state, out - 16, 16 * sizeof(int16_t));
 }
 
-void aAddMixerImpl(uint16_t in_addr, uint16_t out_addr, uint16_t count) {
+static void aAddMixer_scalar(uint16_t in_addr, uint16_t out_addr, uint16_t count) {
     int16_t *in = BUF_S16(in_addr);
     int16_t *out = BUF_S16(out_addr);
     int nbytes = ROUND_UP_64(ROUND_DOWN_16(count));
@@ -516,3 +553,591 @@ void aUnkCmd19Impl(uint8_t f, uint16_t count, uint16_t out_addr, uint16_t in_add
         nbytes -= 32 * sizeof(int16_t);
     } while (nbytes > 0);
 }
+
+#ifdef MIXER_SIMD
+
+// Switched from the console thread while the audio thread dispatches on it.
+#ifdef _MSC_VER
+static volatile long mixer_simd = 1;
+#define MIXER_SIMD_ENABLED() (_InterlockedOr(&mixer_simd, 0) != 0)
+#define MIXER_SIMD_SET(enabled) _InterlockedExchange(&mixer_simd, (enabled) ? 1 : 0)
+#else
+static int mixer_simd = 1;
+#define MIXER_SIMD_ENABLED() (__atomic_load_n(&mixer_simd, __ATOMIC_RELAXED) != 0)
+#define MIXER_SIMD_SET(enabled) __atomic_store_n(&mixer_simd, (enabled) ? 1 : 0, __ATOMIC_RELAXED)
+#endif
+
+// Column c of table entry t holds, for each output j, the factor of the two previous outputs (c 0 and 1) or of new sample
+// c - 2. SSE2 keeps two columns interleaved so _mm_madd_epi16 can apply both with one broadcast pair.
+static void aADPCM_build_columns(int entries) {
+    if (entries > 8) {
+        entries = 8;
+    }
+
+    for (int t = 0; t < entries; t++) {
+        int16_t (*tbl)[8] = rspa.adpcm_table[t];
+        int16_t *columns = rspa.adpcm_columns[t][0];
+
+        for (int c = 0; c < 10; c++) {
+            for (int j = 0; j < 8; j++) {
+                int k = c - 2;
+                int16_t value;
+                if (c < 2) {
+                    value = tbl[c][j];
+                } else {
+                    value = j == k ? 1 << 11 : j > k ? tbl[1][j - k - 1] : 0;
+                }
+#ifdef MIXER_SSE2
+                columns[(c / 2) * 16 + j * 2 + (c & 1)] = value;
+#else
+                columns[c * 8 + j] = value;
+#endif
+            }
+        }
+    }
+}
+
+#ifdef MIXER_SSE2
+// High half of a signed 16-bit times unsigned 16-bit product, which _mm_mulhi_epi16 would read as signed
+static inline __m128i mulhi_s16_u16(__m128i a, uint16_t b) {
+    __m128i hi = _mm_mulhi_epi16(a, _mm_set1_epi16((int16_t)b));
+    return (b & 0x8000) ? _mm_add_epi16(hi, a) : hi;
+}
+
+static inline __m128i set1_pair(int16_t a, int16_t b) {
+    return _mm_set1_epi32((int32_t)((uint16_t)a | ((uint32_t)(uint16_t)b << 16)));
+}
+#else
+static inline int16x8_t mulhi_s16_u16(int16x8_t a, uint16_t b) {
+    int32x4_t lo = vshrq_n_s32(vmulq_n_s32(vmovl_s16(vget_low_s16(a)), b), 16);
+    int32x4_t hi = vshrq_n_s32(vmulq_n_s32(vmovl_high_s16(a), b), 16);
+    return vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+}
+#endif
+
+static void aInterleave_simd(uint16_t dest, uint16_t left, uint16_t right, uint16_t c) {
+    int count = ROUND_UP_8(c) / sizeof(int16_t) / 4;
+    int16_t *l = BUF_S16(left);
+    int16_t *r = BUF_S16(right);
+    int16_t *d = BUF_S16(dest);
+
+    for (; count >= 2; count -= 2) {
+#ifdef MIXER_SSE2
+        __m128i lv = _mm_loadu_si128((const __m128i *)l);
+        __m128i rv = _mm_loadu_si128((const __m128i *)r);
+        _mm_storeu_si128((__m128i *)d, _mm_unpacklo_epi16(lv, rv));
+        _mm_storeu_si128((__m128i *)(d + 8), _mm_unpackhi_epi16(lv, rv));
+#else
+        int16x8x2_t lr = { { vld1q_s16(l), vld1q_s16(r) } };
+        vst2q_s16(d, lr);
+#endif
+        l += 8;
+        r += 8;
+        d += 16;
+    }
+
+    if (count > 0) {
+        for (int i = 0; i < 4; i++) {
+            *d++ = l[i];
+            *d++ = r[i];
+        }
+    }
+}
+
+static void aADPCMdec_simd(uint8_t flags, ADPCM_STATE state) {
+    uint8_t *in = BUF_U8(rspa.in);
+    int16_t *out = BUF_S16(rspa.out);
+    int nbytes = ROUND_UP_32(rspa.nbytes);
+    if (flags & A_INIT) {
+        memset(out, 0, 16 * sizeof(int16_t));
+    } else if (flags & A_LOOP) {
+        memcpy(out, rspa.adpcm_loop_state, 16 * sizeof(int16_t));
+    } else {
+        memcpy(out, state, 16 * sizeof(int16_t));
+    }
+    out += 16;
+
+    while (nbytes > 0) {
+        int shift = *in >> 4;
+        const int16_t *columns = rspa.adpcm_columns[*in++ & 0xf][0];
+        int i;
+
+        for (i = 0; i < 2; i++) {
+            int16_t ins[8];
+            int16_t prev1 = out[-1];
+            int16_t prev2 = out[-2];
+            int j;
+            if (flags & 4) {
+                for (j = 0; j < 2; j++) {
+                    ins[j * 4] = (((*in >> 6) << 30) >> 30) << shift;
+                    ins[j * 4 + 1] = ((((*in >> 4) & 0x3) << 30) >> 30) << shift;
+                    ins[j * 4 + 2] = ((((*in >> 2) & 0x3) << 30) >> 30) << shift;
+                    ins[j * 4 + 3] = (((*in++ & 0x3) << 30) >> 30) << shift;
+                }
+            } else {
+                for (j = 0; j < 4; j++) {
+                    ins[j * 2] = (((*in >> 4) << 28) >> 28) << shift;
+                    ins[j * 2 + 1] = (((*in++ & 0xf) << 28) >> 28) << shift;
+                }
+            }
+
+            // The sums wrap the same way the scalar int accumulator does, so the results match even when they overflow
+#ifdef MIXER_SSE2
+            __m128i pair = set1_pair(prev2, prev1);
+            __m128i lo = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)columns), pair);
+            __m128i hi = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(columns + 8)), pair);
+            for (j = 0; j < 8; j += 2) {
+                pair = set1_pair(ins[j], ins[j + 1]);
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(columns + 16 + j * 8)), pair));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(columns + 24 + j * 8)), pair));
+            }
+            _mm_storeu_si128((__m128i *)out, _mm_packs_epi32(_mm_srai_epi32(lo, 11), _mm_srai_epi32(hi, 11)));
+#else
+            int16x8_t column = vld1q_s16(columns);
+            int32x4_t lo = vmull_n_s16(vget_low_s16(column), prev2);
+            int32x4_t hi = vmull_high_n_s16(column, prev2);
+            column = vld1q_s16(columns + 8);
+            lo = vmlal_n_s16(lo, vget_low_s16(column), prev1);
+            hi = vmlal_high_n_s16(hi, column, prev1);
+            for (j = 0; j < 8; j++) {
+                column = vld1q_s16(columns + 16 + j * 8);
+                lo = vmlal_n_s16(lo, vget_low_s16(column), ins[j]);
+                hi = vmlal_high_n_s16(hi, column, ins[j]);
+            }
+            vst1q_s16(out, vcombine_s16(vqshrn_n_s32(lo, 11), vqshrn_n_s32(hi, 11)));
+#endif
+            out += 8;
+        }
+        nbytes -= 16 * sizeof(int16_t);
+    }
+    memcpy(state, out - 16, 16 * sizeof(int16_t));
+}
+
+static void aResample_simd(uint8_t flags, uint16_t pitch, RESAMPLE_STATE state) {
+    int16_t tmp[16];
+    int16_t *in_initial = BUF_S16(rspa.in);
+    int16_t *in = in_initial;
+    int16_t *out = BUF_S16(rspa.out);
+    int nbytes = ROUND_UP_16(rspa.nbytes);
+    uint32_t pitch_accumulator;
+    int i;
+    int16_t *tbl;
+
+    if (flags & A_INIT) {
+        memset(tmp, 0, 5 * sizeof(int16_t));
+    } else {
+        memcpy(tmp, state, 16 * sizeof(int16_t));
+    }
+    if (flags & 2) {
+        memcpy(in - 8, tmp + 8, 8 * sizeof(int16_t));
+        in -= tmp[5] / sizeof(int16_t);
+    }
+    in -= 4;
+    pitch_accumulator = (uint16_t)tmp[4];
+    memcpy(in, tmp, 4 * sizeof(int16_t));
+
+    // Each tap is rounded on its own before the four are summed, so the products are kept at 32 bits per tap
+    do {
+#ifdef MIXER_SSE2
+        __m128i round = _mm_set1_epi32(0x4000);
+        __m128i taps[8];
+        for (i = 0; i < 8; i++) {
+            tbl = resample_table[pitch_accumulator * 64 >> 16];
+            __m128i samples = _mm_loadl_epi64((const __m128i *)in);
+            __m128i factors = _mm_loadl_epi64((const __m128i *)tbl);
+            __m128i products = _mm_unpacklo_epi16(_mm_mullo_epi16(samples, factors), _mm_mulhi_epi16(samples, factors));
+            taps[i] = _mm_srai_epi32(_mm_add_epi32(products, round), 15);
+
+            pitch_accumulator += (pitch << 1);
+            in += pitch_accumulator >> 16;
+            pitch_accumulator %= 0x10000;
+        }
+
+        __m128i sums[2];
+        for (i = 0; i < 2; i++) {
+            __m128i *t = taps + i * 4;
+            __m128i t01 = _mm_add_epi32(_mm_unpacklo_epi32(t[0], t[1]), _mm_unpackhi_epi32(t[0], t[1]));
+            __m128i t23 = _mm_add_epi32(_mm_unpacklo_epi32(t[2], t[3]), _mm_unpackhi_epi32(t[2], t[3]));
+            sums[i] = _mm_add_epi32(_mm_unpacklo_epi64(t01, t23), _mm_unpackhi_epi64(t01, t23));
+        }
+        _mm_storeu_si128((__m128i *)out, _mm_packs_epi32(sums[0], sums[1]));
+#else
+        int32x4_t taps[8];
+        for (i = 0; i < 8; i++) {
+            tbl = resample_table[pitch_accumulator * 64 >> 16];
+            taps[i] = vrshrq_n_s32(vmull_s16(vld1_s16(in), vld1_s16(tbl)), 15);
+
+            pitch_accumulator += (pitch << 1);
+            in += pitch_accumulator >> 16;
+            pitch_accumulator %= 0x10000;
+        }
+
+        int32x4_t lo = vpaddq_s32(vpaddq_s32(taps[0], taps[1]), vpaddq_s32(taps[2], taps[3]));
+        int32x4_t hi = vpaddq_s32(vpaddq_s32(taps[4], taps[5]), vpaddq_s32(taps[6], taps[7]));
+        vst1q_s16(out, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+#endif
+        out += 8;
+        nbytes -= 8 * sizeof(int16_t);
+    } while (nbytes > 0);
+
+    state[4] = (int16_t)pitch_accumulator;
+    memcpy(state, in, 4 * sizeof(int16_t));
+    i = (in - in_initial + 4) & 7;
+    in -= i;
+    if (i != 0) {
+        i = -8 - i;
+    }
+    state[5] = i;
+    memcpy(state + 8, in, 8 * sizeof(int16_t));
+}
+
+static void aEnvMixer_simd(uint16_t in_addr, uint16_t n_samples, bool swap_reverb,
+                           bool neg_3, bool neg_2,
+                           bool neg_left, bool neg_right,
+                           int32_t wet_dry_addr, u32 unk)
+{
+    int16_t *in = BUF_S16(in_addr);
+    int16_t *dry[2] = {BUF_S16(((wet_dry_addr >> 24) & 0xFF) << 4), BUF_S16(((wet_dry_addr >> 16) & 0xFF) << 4)};
+    int16_t *wet[2] = {BUF_S16(((wet_dry_addr >> 8) & 0xFF) << 4), BUF_S16(((wet_dry_addr) & 0xFF) << 4)};
+    int16_t negs[4] = {neg_left ? -1 : 0, neg_right ? -1 : 0, neg_3 ? -4 : 0, neg_2 ? -2 : 0};
+    int swapped[2] = {swap_reverb ? 1 : 0, swap_reverb ? 0 : 1};
+    int n = ROUND_UP_16(n_samples);
+
+    uint16_t vols[2] = {rspa.vol[0], rspa.vol[1]};
+    uint16_t rates[2] = {rspa.rate[0], rspa.rate[1]};
+    uint16_t vol_wet = rspa.vol_wet;
+    uint16_t rate_wet = rspa.rate_wet;
+
+    // The buffers are 16 byte aligned, so blocks of 8 samples either alias completely or not at all and the per-sample
+    // order of the scalar loop is kept by loading every buffer right before it is updated.
+    do {
+#ifdef MIXER_SSE2
+        __m128i src = _mm_loadu_si128((const __m128i *)in);
+        __m128i samples[2];
+        for (int j = 0; j < 2; j++) {
+            samples[j] = _mm_xor_si128(mulhi_s16_u16(src, vols[j]), _mm_set1_epi16(negs[j]));
+        }
+        for (int j = 0; j < 2; j++) {
+            __m128i d = _mm_adds_epi16(_mm_loadu_si128((const __m128i *)dry[j]), samples[j]);
+            _mm_storeu_si128((__m128i *)dry[j], d);
+            __m128i w = _mm_xor_si128(mulhi_s16_u16(samples[swapped[j]], vol_wet), _mm_set1_epi16(negs[2 + j]));
+            _mm_storeu_si128((__m128i *)wet[j], _mm_adds_epi16(_mm_loadu_si128((const __m128i *)wet[j]), w));
+        }
+#else
+        int16x8_t src = vld1q_s16(in);
+        int16x8_t samples[2];
+        for (int j = 0; j < 2; j++) {
+            samples[j] = veorq_s16(mulhi_s16_u16(src, vols[j]), vdupq_n_s16(negs[j]));
+        }
+        for (int j = 0; j < 2; j++) {
+            vst1q_s16(dry[j], vqaddq_s16(vld1q_s16(dry[j]), samples[j]));
+            int16x8_t w = veorq_s16(mulhi_s16_u16(samples[swapped[j]], vol_wet), vdupq_n_s16(negs[2 + j]));
+            vst1q_s16(wet[j], vqaddq_s16(vld1q_s16(wet[j]), w));
+        }
+#endif
+        in += 8;
+        for (int j = 0; j < 2; j++) {
+            dry[j] += 8;
+            wet[j] += 8;
+        }
+        vols[0] += rates[0];
+        vols[1] += rates[1];
+        vol_wet += rate_wet;
+
+        n -= 8;
+    } while (n > 0);
+}
+
+static void aMix_simd(uint16_t count, int16_t gain, uint16_t in_addr, uint16_t out_addr) {
+    int nbytes = ROUND_UP_32(ROUND_DOWN_16(count << 4));
+    int16_t *in = BUF_S16(in_addr);
+    int16_t *out = BUF_S16(out_addr);
+    int i;
+
+    if (gain == -0x8000) {
+        for (i = 0; i < nbytes / (int)sizeof(int16_t); i += 8) {
+#ifdef MIXER_SSE2
+            __m128i o = _mm_loadu_si128((const __m128i *)(out + i));
+            _mm_storeu_si128((__m128i *)(out + i), _mm_subs_epi16(o, _mm_loadu_si128((const __m128i *)(in + i))));
+#else
+            vst1q_s16(out + i, vqsubq_s16(vld1q_s16(out + i), vld1q_s16(in + i)));
+#endif
+        }
+        return;
+    }
+
+#ifdef MIXER_SSE2
+    __m128i gains = set1_pair(0x7fff, gain);
+    __m128i round = _mm_set1_epi32(0x4000);
+#endif
+    for (i = 0; i < nbytes / (int)sizeof(int16_t); i += 8) {
+#ifdef MIXER_SSE2
+        __m128i o = _mm_loadu_si128((const __m128i *)(out + i));
+        __m128i s = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(o, s), gains);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(o, s), gains);
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 15);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 15);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+#else
+        int16x8_t o = vld1q_s16(out + i);
+        int16x8_t s = vld1q_s16(in + i);
+        int32x4_t lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(o), 0x7fff), vget_low_s16(s), gain);
+        int32x4_t hi = vmlal_high_n_s16(vmull_high_n_s16(o, 0x7fff), s, gain);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vrshrq_n_s32(lo, 15)), vqmovn_s32(vrshrq_n_s32(hi, 15))));
+#endif
+    }
+}
+
+static void aAddMixer_simd(uint16_t in_addr, uint16_t out_addr, uint16_t count) {
+    int16_t *in = BUF_S16(in_addr);
+    int16_t *out = BUF_S16(out_addr);
+    int nbytes = ROUND_UP_64(ROUND_DOWN_16(count));
+
+    do {
+        for (int i = 0; i < 16; i += 8) {
+#ifdef MIXER_SSE2
+            __m128i o = _mm_loadu_si128((const __m128i *)(out + i));
+            _mm_storeu_si128((__m128i *)(out + i), _mm_adds_epi16(o, _mm_loadu_si128((const __m128i *)(in + i))));
+#else
+            vst1q_s16(out + i, vqaddq_s16(vld1q_s16(out + i), vld1q_s16(in + i)));
+#endif
+        }
+        in += 16;
+        out += 16;
+
+        nbytes -= 16 * sizeof(int16_t);
+    } while (nbytes > 0);
+}
+
+#define MIXER_DISPATCH(kernel, ...) \
+    do { \
+        if (MIXER_SIMD_ENABLED()) { \
+            kernel##_simd(__VA_ARGS__); \
+        } else { \
+            kernel##_scalar(__VA_ARGS__); \
+        } \
+    } while (0)
+#else
+#define MIXER_DISPATCH(kernel, ...) kernel##_scalar(__VA_ARGS__)
+#endif
+
+void aInterleaveImpl(uint16_t dest, uint16_t left, uint16_t right, uint16_t c) {
+    MIXER_DISPATCH(aInterleave, dest, left, right, c);
+}
+
+void aADPCMdecImpl(uint8_t flags, ADPCM_STATE state) {
+    MIXER_DISPATCH(aADPCMdec, flags, state);
+}
+
+void aResampleImpl(uint8_t flags, uint16_t pitch, RESAMPLE_STATE state) {
+    MIXER_DISPATCH(aResample, flags, pitch, state);
+}
+
+void aEnvMixerImpl(uint16_t in_addr, uint16_t n_samples, bool swap_reverb,
+				   bool neg_3, bool neg_2,
+                   bool neg_left, bool neg_right,
+                   int32_t wet_dry_addr, u32 unk)
+{
+    MIXER_DISPATCH(aEnvMixer, in_addr, n_samples, swap_reverb, neg_3, neg_2, neg_left, neg_right, wet_dry_addr, unk);
+}
+
+void aMixImpl(uint16_t count, int16_t gain, uint16_t in_addr, uint16_t out_addr) {
+    MIXER_DISPATCH(aMix, count, gain, in_addr, out_addr);
+}
+
+void aAddMixerImpl(uint16_t in_addr, uint16_t out_addr, uint16_t count) {
+    MIXER_DISPATCH(aAddMixer, in_addr, out_addr, count);
+}
+
+bool mixer_simd_available(void) {
+#ifdef MIXER_SIMD
+    return true;
+#else
+    return false;
+#endif
+}
+
+void mixer_set_simd(bool enabled) {
+#ifdef MIXER_SIMD
+    MIXER_SIMD_SET(enabled);
+#endif
+}
+
+#ifdef MIXER_SIMD
+
+struct MixerBenchStates {
+    ADPCM_STATE adpcm;
+    ADPCM_STATE adpcm_loop;
+    RESAMPLE_STATE resample;
+};
+
+static uint32_t bench_rng;
+
+static uint32_t bench_rand(void) {
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 17;
+    bench_rng ^= bench_rng << 5;
+    return bench_rng;
+}
+
+// Addresses of 16 byte aligned DMEM blocks that leave room for size bytes before the end of the buffer
+static uint16_t bench_addr(uint16_t min, int size) {
+    int blocks = (0x3C0 + DMEM_BUF_SIZE - size - min) / 16;
+    return (uint16_t)(min + (bench_rand() % blocks) * 16);
+}
+
+#define BENCH_CALL(simd, kernel, ...) ((simd) ? kernel##_simd(__VA_ARGS__) : kernel##_scalar(__VA_ARGS__))
+#define BENCH_COMMANDS 32
+
+static void bench_adpcm(bool simd, struct MixerBenchStates *states) {
+    int16_t book[8 * 2 * 8];
+    for (int i = 0; i < 8 * 2 * 8; i++) {
+        book[i] = (int16_t)bench_rand();
+    }
+    aLoadADPCMImpl(sizeof(book), book);
+    aSetLoopImpl(&states->adpcm_loop);
+
+    // Frame headers pick one of the 8 loaded predictors, which any byte of the input may turn out to be
+    for (int i = 0; i < 0x100; i++) {
+        *BUF_U8(0x3C0 + i) &= 0xF7;
+    }
+
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+        uint8_t flags = (uint8_t)(bench_rand() % 3) | ((bench_rand() & 1) ? 4 : 0);
+        aSetBufferImpl(0, 0x3C0, 0x4C0, (uint16_t)((bench_rand() % 16 + 1) * 32));
+        BENCH_CALL(simd, aADPCMdec, flags, states->adpcm);
+    }
+}
+
+static void bench_resample(bool simd, struct MixerBenchStates *states) {
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+        uint8_t flags = (uint8_t)(bench_rand() & (A_INIT | 2));
+        uint16_t pitch = (uint16_t)bench_rand();
+        aSetBufferImpl(0, 0x6E0, 0xA00, (uint16_t)((bench_rand() % 16 + 1) * 16));
+        BENCH_CALL(simd, aResample, flags, pitch, states->resample);
+    }
+}
+
+static void bench_env_mixer(bool simd, struct MixerBenchStates *states) {
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+        uint16_t n_samples = (uint16_t)(bench_rand() % 0xB0 + 1);
+        uint32_t wet_dry_addr = 0;
+        for (int j = 0; j < 4; j++) {
+            wet_dry_addr = (wet_dry_addr << 8) | (bench_addr(0x3C0, 0x180) >> 4);
+        }
+        uint32_t bits = bench_rand();
+
+        aEnvSetup1Impl((uint8_t)bench_rand(), (uint16_t)bench_rand(), (uint16_t)bench_rand(), (uint16_t)bench_rand());
+        aEnvSetup2Impl((uint16_t)bench_rand(), (uint16_t)bench_rand());
+        BENCH_CALL(simd, aEnvMixer, bench_addr(0x3C0, 0x180), n_samples, bits & 1, (bits & 2) != 0, (bits & 4) != 0,
+                   (bits & 8) != 0, (bits & 16) != 0, (int32_t)wet_dry_addr, 0);
+    }
+}
+
+static void bench_mix(bool simd, struct MixerBenchStates *states) {
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+        uint16_t count = (uint16_t)(bench_rand() % 32 + 1);
+        int16_t gain = (bench_rand() % 4 == 0) ? -0x8000 : (int16_t)bench_rand();
+        uint16_t in_addr = bench_addr(0x3C0, 0x200);
+        BENCH_CALL(simd, aMix, count, gain, in_addr, bench_addr(0x3C0, 0x200));
+    }
+}
+
+static void bench_add_mixer(bool simd, struct MixerBenchStates *states) {
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+        uint16_t count = (uint16_t)(bench_rand() % 0x200);
+        uint16_t in_addr = bench_addr(0x3C0, 0x200);
+        BENCH_CALL(simd, aAddMixer, in_addr, bench_addr(0x3C0, 0x200), count);
+    }
+}
+
+// Left, right and destination never overlap in the game
+static void bench_interleave(bool simd, struct MixerBenchStates *states) {
+    for (int i = 0; i < BENCH_COMMANDS; i++) {
+        uint16_t c = (uint16_t)(bench_rand() % 0x100 + 1);
+        uint16_t left = (uint16_t)(0x3C0 + (bench_rand() % 16) * 16);
+        uint16_t right = (uint16_t)(0x5C0 + (bench_rand() % 16) * 16);
+        BENCH_CALL(simd, aInterleave, (uint16_t)(0x7C0 + (bench_rand() % 32) * 16), left, right, c);
+    }
+}
+
+static double bench_now_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Every iteration starts from the same DMEM and states, so both versions see identical command streams
+static double bench_run(void (*stream)(bool, struct MixerBenchStates *), bool simd, uint32_t iterations,
+                        struct RspAudio *audio, struct MixerBenchStates *states) {
+    double elapsed = 0.0;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        bench_rng = 0x2545F491;
+        memset(audio, 0, sizeof(*audio));
+        for (int j = 0; j < DMEM_BUF_SIZE; j++) {
+            audio->buf.as_u8[j] = (uint8_t)bench_rand();
+        }
+        for (int j = 0; j < 16; j++) {
+            states->adpcm[j] = (int16_t)bench_rand();
+            states->adpcm_loop[j] = (int16_t)bench_rand();
+            states->resample[j] = (int16_t)bench_rand();
+        }
+        // Resample states only ever hold a whole-sample offset of 0 or -9 to -15 bytes
+        int offset = bench_rand() % 8;
+        states->resample[5] = (int16_t)(offset != 0 ? -8 - offset : 0);
+
+        double start = bench_now_ms();
+        stream(simd, states);
+        elapsed += bench_now_ms() - start;
+    }
+
+    return elapsed;
+}
+
+int mixer_benchmark(uint32_t iterations, struct MixerBenchmarkTiming *timings, int max_timings) {
+    static struct RspAudio audio[2];
+    static const struct {
+        const char *kernel;
+        void (*stream)(bool, struct MixerBenchStates *);
+    } streams[] = {
+        { "ADPCMdec", bench_adpcm },
+        { "Resample", bench_resample },
+        { "EnvMixer", bench_env_mixer },
+        { "Mix", bench_mix },
+        { "AddMixer", bench_add_mixer },
+        { "Interleave", bench_interleave },
+    };
+    struct RspAudio *live = rspa_current;
+    int count = 0;
+
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    for (size_t i = 0; i < sizeof(streams) / sizeof(streams[0]) && count < max_timings; i++) {
+        struct MixerBenchStates states[2];
+        struct MixerBenchmarkTiming *timing = &timings[count++];
+
+        timing->kernel = streams[i].kernel;
+        rspa_current = &audio[0];
+        timing->scalar_ms = bench_run(streams[i].stream, false, iterations, &audio[0], &states[0]);
+        rspa_current = &audio[1];
+        timing->simd_ms = bench_run(streams[i].stream, true, iterations, &audio[1], &states[1]);
+        // The loop state pointer is the only field that differs by design
+        audio[1].adpcm_loop_state = audio[0].adpcm_loop_state;
+        timing->matches = memcmp(&audio[0], &audio[1], sizeof(audio[0])) == 0 && memcmp(&states[0], &states[1], sizeof(states[0])) == 0;
+    }
+
+    rspa_current = live;
+    return count;
+}
+
+#else
+
+int mixer_benchmark(uint32_t iterations, struct MixerBenchmarkTiming *timings, int max_timings) {
+    return 0;
+}
+
+#endif
@@ -60,6 +60,24 @@ void aHiLoGainImpl(uint8_t g, uint16_t count, uint16_t addr);
 void aUnkCmd3Impl(uint16_t a, uint16_t b, uint16_t c);
 void aUnkCmd19Impl(uint8_t f, uint16_t count, uint16_t out_addr, uint16_t in_addr);
 
+// ADPCMdec, Resample, EnvMixer, Mix, AddMixer and Interleave have vector versions picked at compile time: SSE2 on x86
+// and x64, NEON when both __ARM_NEON and __aarch64__ are defined.
+bool mixer_simd_available(void);
+void mixer_set_simd(bool enabled);
+
+struct MixerBenchmarkTiming {
+    const char *kernel;
+    double scalar_ms;
+    double simd_ms;
+    bool matches;
+};
+
+// Runs generated command streams through the scalar and the vector kernels on a private DMEM and compares the DMEM and
+// states they leave behind. Returns the number of timings filled in, 0 without vector kernels.
+// The streams are seeded random commands kept to the parameter ranges the synthesis code uses, not recorded game audio: the
+// kernels are called directly rather than through a command list, so there is no DMEM command stream to record.
+int mixer_benchmark(uint32_t iterations, struct MixerBenchmarkTiming *timings, int max_timings);
+
 #define aSegment(pkt, s, b) do { } while(0)
 #define aClearBuffer(pkt, d, c) aClearBufferImpl(d, c)
 #define aLoadBuffer(pkt, s, d, c) aLoadBufferImpl(s, d, c)
@@ -250,6 +250,10 @@ typedef struct {
     /* 0x0E */ s16      intensity;
 } TitleCardContext; // size = 0x10
 
+// The actor grid wraps around every ACTOR_GRID_DIM cells in x and z
+#define ACTOR_GRID_DIM 32
+#define ACTOR_GRID_CELL_SIZE 512.0f
+
 typedef struct {
     /* 0x00 */ s32    length; // number of actors loaded of this category
     /* 0x04 */ Actor* head; // pointer to head of the linked list of this category (most recent actor added)
@@ -279,7 +283,9 @@ typedef struct {
     /* 0x0128 */ TitleCardContext titleCtx;
     /* 0x0138 */ char   unk_138[0x04];
     /* 0x013C */ void*  absoluteSpace; // Space used to allocate actor overlays of alloc type 1
-} ActorContext; // size = 0x140
+    /* 0x0140 */ struct Actor* idLists[ACTOR_ID_MAX]; // Actors of each id, most recently added to their category first
+    /* 0x0788 */ struct Actor* gridCells[ACTOR_GRID_DIM * ACTOR_GRID_DIM]; // Actors bucketed by world.pos xz, see `Actor_FindInRadius`
+} ActorContext; // size = 0x1788
 
 typedef struct {
     /* 0x00 */ char  unk_00[0x4];
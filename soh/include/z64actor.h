@@ -188,8 +188,13 @@ typedef struct Actor {
     /* 0x134 */ ActorFunc draw; // Draw Routine. Called by `Actor_Draw`
     /* 0x138 */ ActorResetFunc reset;
     /* 0x138 */ ActorOverlay* overlayEntry; // Pointer to the overlay table entry for this actor
-    /* 0x13C */ char dbgPad[0x10]; // Padding that only exists in the debug rom
-} Actor; // size = 0x14C
+    /* 0x13C */ struct Actor* prevById; // Previous actor with the same id, see `ActorContext.idLists`
+    /* 0x140 */ struct Actor* nextById; // Next actor with the same id
+    /* 0x144 */ struct Actor* prevInCell; // Previous actor in the same `ActorContext.gridCells` cell
+    /* 0x148 */ struct Actor* nextInCell; // Next actor in the same cell
+    /* 0x14C */ s16 gridCell; // Index of the cell holding this actor in `ActorContext.gridCells`
+    /* 0x150 */ char dbgPad[0x10]; // Padding that only exists in the debug rom
+} Actor; // size = 0x160
 
 typedef enum {
     /* 0 */ FOOT_LEFT,
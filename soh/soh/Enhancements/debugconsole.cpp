@@ -2,6 +2,12 @@
 #include "../libultraship/SohImGuiImpl.h"
 #include <vector>
 #include <string>
+#include <chrono>
+
+extern "C" {
+#include <ultra64.h>
+}
+#include "Lib/Fast3D/gfx_pc.h"
 
 #define Path _Path
 #define PATH_HACK
@@ -15,10 +21,14 @@ extern "C" {
 #include "variables.h"
 #include "functions.h"
 #include "macros.h"
+#include "mixer.h"
 extern GlobalContext* gGlobalCtx;
+void ResourceMgr_RequestPatchRescan(void);
 }
 
 #include "cvar.h"
+#include "Lib/Fast3D/gfx_texture_decode.h"
+#include "Lib/Fast3D/gfx_capture.h"
 
 #define CMD_REGISTER SohImGui::BindCmd
 
@@ -374,6 +384,161 @@ static bool GetCVarHandler(const std::vector<std::string>& args) {
     return CMD_SUCCESS;
 }
 
+static bool TextureDecodeBenchmarkHandler(const std::vector<std::string>& args) {
+    uint32_t texels = 64 * 64;
+    uint32_t iterations = 1000;
+
+    try {
+        if (args.size() > 1)
+            texels = std::stoi(args[1]);
+        if (args.size() > 2)
+            iterations = std::stoi(args[2]);
+    } catch (std::invalid_argument const& ex) {
+        ERROR("[SOH] Texel and iteration counts must be numbers.");
+        return CMD_FAILED;
+    }
+
+    for (const auto& timing : gfx_texture_decode_benchmark(texels, iterations)) {
+        INFO("[SOH] %-6s scalar %8.3f ms  simd %8.3f ms  %5.2fx%s", timing.format, timing.scalar_ms, timing.simd_ms,
+             timing.scalar_ms / timing.simd_ms, timing.matches ? "" : "  MISMATCH");
+    }
+
+    return CMD_SUCCESS;
+}
+
+static bool VertexBenchmarkHandler(const std::vector<std::string>& args) {
+    uint32_t vertices = 4096;
+
+    try {
+        if (args.size() > 1)
+            vertices = std::stoi(args[1]);
+    } catch (std::invalid_argument const& ex) {
+        ERROR("[SOH] Vertex count must be a number.");
+        return CMD_FAILED;
+    }
+
+    GfxVertexCheckResult result = gfx_vertex_check_random(vertices);
+    if (!result.simd) {
+        ERROR("[SOH] This build has no vector vertex transform.");
+        return CMD_FAILED;
+    }
+
+    INFO("[SOH] %u vertices  scalar %8.3f ms  simd %8.3f ms  %5.2fx  %u mismatches", result.vertices, result.scalar_ms, result.simd_ms,
+         result.scalar_ms / result.simd_ms, result.mismatches);
+    return CMD_SUCCESS;
+}
+
+static bool VertexCheckHandler(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        ERROR("[SOH] Expected 0 or 1.");
+        return CMD_FAILED;
+    }
+
+    GfxVertexCheckResult result = gfx_vertex_check_live_results();
+    if (!result.simd) {
+        ERROR("[SOH] This build has no vector vertex transform.");
+        return CMD_FAILED;
+    }
+
+    if (args[1] != "0") {
+        gfx_vertex_check_live(true);
+        INFO("[SOH] Checking every loaded vertex batch against the scalar transform.");
+    } else {
+        gfx_vertex_check_live(false);
+        INFO("[SOH] %u vertices checked, %u mismatches.", result.vertices, result.mismatches);
+    }
+
+    return CMD_SUCCESS;
+}
+
+static bool MixerBenchmarkHandler(const std::vector<std::string>& args) {
+    uint32_t iterations = 1000;
+
+    try {
+        if (args.size() > 1)
+            iterations = std::stoi(args[1]);
+    } catch (std::invalid_argument const& ex) {
+        ERROR("[SOH] Iteration count must be a number.");
+        return CMD_FAILED;
+    }
+
+    MixerBenchmarkTiming timings[16];
+    int count = mixer_benchmark(iterations, timings, 16);
+    if (count == 0) {
+        ERROR("[SOH] This build has no vector audio kernels.");
+        return CMD_FAILED;
+    }
+
+    for (int i = 0; i < count; i++) {
+        INFO("[SOH] %-10s scalar %8.3f ms  simd %8.3f ms  %5.2fx%s", timings[i].kernel, timings[i].scalar_ms, timings[i].simd_ms,
+             timings[i].scalar_ms / timings[i].simd_ms, timings[i].matches ? "" : "  MISMATCH");
+    }
+
+    return CMD_SUCCESS;
+}
+
+static bool MixerSimdHandler(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        ERROR("[SOH] Expected 0 or 1.");
+        return CMD_FAILED;
+    }
+
+    bool enabled = args[1] != "0";
+    mixer_set_simd(enabled);
+    INFO("[SOH] Audio mixing uses the %s kernels.", enabled && mixer_simd_available() ? "vector" : "scalar");
+    return CMD_SUCCESS;
+}
+
+static bool StaticCollisionBenchmarkHandler(const std::vector<std::string>& args) {
+    uint32_t queries = 100000;
+
+    if (gGlobalCtx == nullptr) {
+        ERROR("GlobalCtx == nullptr");
+        return CMD_FAILED;
+    }
+
+    try {
+        if (args.size() > 1)
+            queries = std::stoi(args[1]);
+    } catch (std::invalid_argument const& ex) {
+        ERROR("[SOH] Query count must be a number.");
+        return CMD_FAILED;
+    }
+
+    CollisionContext* colCtx = &gGlobalCtx->colCtx;
+    s32 mismatches[4];
+    if (!BgCheck_CompareFlatStaticLookup(colCtx, queries, 1, mismatches)) {
+        ERROR("[SOH] The scene collision has not been flattened.");
+        return CMD_FAILED;
+    }
+
+    double ms[2];
+    for (int flat = 0; flat < 2; flat++) {
+        auto start = std::chrono::steady_clock::now();
+        BgCheck_RunStaticQueries(colCtx, queries, 1, flat);
+        ms[flat] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    INFO("[SOH] %u static queries  lists %8.3f ms  flat %8.3f ms  %5.2fx", queries, ms[0], ms[1], ms[0] / ms[1]);
+    INFO("[SOH] mismatches  floor %d  wall %d  ceiling %d  line %d", mismatches[0], mismatches[1], mismatches[2],
+         mismatches[3]);
+    return CMD_SUCCESS;
+}
+
+static bool ReloadPatchesHandler(const std::vector<std::string>& args) {
+    ResourceMgr_RequestPatchRescan();
+    INFO("[SOH] The patches directory will be scanned again on the next scene or game state change.");
+    return CMD_SUCCESS;
+}
+
+static bool CaptureFrameHandler(const std::vector<std::string>& args) {
+    const std::string path = args.size() > 1 ? args[1] : "frame.gfxcap";
+
+    gfx_capture_next_frame(path);
+    INFO("[SOH] Capturing the next frame to %s, set GFX REPLAY to it to benchmark it on the null backend.", path.c_str());
+    return CMD_SUCCESS;
+}
+
 void DebugConsole_Init(void) {
     CMD_REGISTER("kill", { KillPlayerHandler, "Commit suicide." });
     CMD_REGISTER("map",  { LoadSceneHandler, "Load up kak?" });
@@ -417,6 +582,21 @@ void DebugConsole_Init(void) {
                              { { "slot", ArgumentType::NUMBER }, { "item id", ArgumentType::NUMBER } } });
     CMD_REGISTER("entrance",
                  { EntranceHandler, "Sends player to the entered entrance (hex)", { { "entrance", ArgumentType::NUMBER } } });
+    CMD_REGISTER("texbench", { TextureDecodeBenchmarkHandler, "Times the texture format converters against their scalar versions.",
+                               { { "texels", ArgumentType::NUMBER, true }, { "iterations", ArgumentType::NUMBER, true } } });
+    CMD_REGISTER("vtxbench", { VertexBenchmarkHandler, "Runs random vertices through the scalar and vector vertex transforms and compares them.",
+                               { { "vertices", ArgumentType::NUMBER, true } } });
+    CMD_REGISTER("vtxcheck", { VertexCheckHandler, "Compares the vector vertex transform against the scalar one on live frames, 0 stops and reports.",
+                               { { "enabled", ArgumentType::NUMBER } } });
+    CMD_REGISTER("mixbench", { MixerBenchmarkHandler, "Runs generated audio command streams through the scalar and vector mixer kernels and compares them.",
+                               { { "iterations", ArgumentType::NUMBER, true } } });
+    CMD_REGISTER("mixsimd", { MixerSimdHandler, "Switches audio mixing between the vector and scalar kernels.",
+                              { { "enabled", ArgumentType::NUMBER } } });
+    CMD_REGISTER("colbench", { StaticCollisionBenchmarkHandler, "Runs static collision queries through the flattened lookup and the node lists and compares them.",
+                               { { "queries", ArgumentType::NUMBER, true } } });
+    CMD_REGISTER("reloadpatches", { ReloadPatchesHandler, "Picks up patch archives that were rewritten in place." });
+    CMD_REGISTER("gfxcapture", { CaptureFrameHandler, "Writes the next rendered frame to a file for replay benchmarks.",
+                                 { { "path", ArgumentType::TEXT, true } } });
 
     DebugConsole_LoadCVars();
 }
@@ -0,0 +1,393 @@
+#include "actorProfiler.h"
+#include "../libultraship/SohImGuiImpl.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <z64.h>
+#include "variables.h"
+}
+
+#define ACTORPROF_CATEGORY_MAX 12
+#define ACTORPROF_CSV_PATH "actor_profile.csv"
+
+typedef struct {
+    uint64_t ticks[ACTORPROF_ACTOR_PHASE_MAX];
+    uint32_t calls[ACTORPROF_ACTOR_PHASE_MAX];
+} ActorProfileEntry;
+
+typedef struct {
+    std::array<ActorProfileEntry, ACTOR_ID_MAX> actors;
+    std::array<uint8_t, ACTOR_ID_MAX> actorCategories; // category each ID was last profiled in
+    std::array<ActorProfileEntry, ACTORPROF_CATEGORY_MAX> categories;
+    std::array<uint64_t, ACTORPROF_FRAME_PHASE_MAX> phases;
+} ActorProfileFrame;
+
+static const char* sCategoryNames[ACTORPROF_CATEGORY_MAX] = {
+    "Switch", "Bg", "Player", "Explosive", "Npc", "Enemy", "Prop", "ItemAction", "Misc", "Boss", "Door", "Chest",
+};
+
+static const char* sActorPhaseNames[ACTORPROF_ACTOR_PHASE_MAX] = {
+    "update",
+    "draw",
+    "func_8003F8EC",
+};
+
+static const char* sFramePhaseNames[ACTORPROF_FRAME_PHASE_MAX] = {
+    "DynaPoly_Setup",
+    "CollisionCheck_AT",
+    "CollisionCheck_OC",
+    "CollisionCheck_Damage",
+};
+
+static std::atomic<bool> sProfilerRunning = false;
+static std::atomic<bool> sCsvRequested = false;
+
+// Only touched by the game thread
+static ActorProfileFrame sCurrentFrame;
+static std::ofstream sCsvStream;
+static uint64_t sFrameCount = 0;
+
+// Published at the end of each game frame for the window
+static std::mutex sPublishedMutex;
+static ActorProfileFrame sLastFrame;
+static ActorProfileFrame sTotals;
+static uint32_t sTotalFrames = 0;
+
+static double TicksToMicros(uint64_t ticks) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(ticks)).count();
+}
+
+static void AddFrame(ActorProfileFrame& dest, const ActorProfileFrame& src) {
+    for (size_t i = 0; i < src.actors.size(); i++) {
+        for (size_t j = 0; j < ACTORPROF_ACTOR_PHASE_MAX; j++) {
+            dest.actors[i].ticks[j] += src.actors[i].ticks[j];
+            dest.actors[i].calls[j] += src.actors[i].calls[j];
+        }
+        if (src.actors[i].calls[ACTORPROF_UPDATE] != 0 || src.actors[i].calls[ACTORPROF_DRAW] != 0) {
+            dest.actorCategories[i] = src.actorCategories[i];
+        }
+    }
+    for (size_t i = 0; i < src.categories.size(); i++) {
+        for (size_t j = 0; j < ACTORPROF_ACTOR_PHASE_MAX; j++) {
+            dest.categories[i].ticks[j] += src.categories[i].ticks[j];
+            dest.categories[i].calls[j] += src.categories[i].calls[j];
+        }
+    }
+    for (size_t i = 0; i < src.phases.size(); i++) {
+        dest.phases[i] += src.phases[i];
+    }
+}
+
+static const char* GetActorName(int16_t actorId) {
+    const char* name = gActorOverlayTable[actorId].name;
+
+    return name != nullptr ? name : "<unset>";
+}
+
+static void WriteCsvEntry(const char* kind, int32_t id, const char* name, const char* category,
+                          const ActorProfileEntry& entry) {
+    for (size_t j = 0; j < ACTORPROF_ACTOR_PHASE_MAX; j++) {
+        if (entry.calls[j] != 0) {
+            sCsvStream << sFrameCount << ',' << kind << ',' << id << ',' << name << ',' << category << ','
+                       << sActorPhaseNames[j] << ',' << TicksToMicros(entry.ticks[j]) << ',' << entry.calls[j]
+                       << '\n';
+        }
+    }
+}
+
+// One row per measured (actor ID, category or frame phase, phase) so the file can be pivoted offline
+static void WriteCsvFrame(const ActorProfileFrame& frame) {
+    for (size_t i = 0; i < frame.actors.size(); i++) {
+        WriteCsvEntry("actor", i, GetActorName(i), sCategoryNames[frame.actorCategories[i]], frame.actors[i]);
+    }
+    for (size_t i = 0; i < frame.categories.size(); i++) {
+        WriteCsvEntry("category", i, sCategoryNames[i], sCategoryNames[i], frame.categories[i]);
+    }
+    for (size_t i = 0; i < frame.phases.size(); i++) {
+        if (frame.phases[i] != 0) {
+            sCsvStream << sFrameCount << ",frame," << i << ',' << sFramePhaseNames[i] << ",," << sFramePhaseNames[i]
+                       << ',' << TicksToMicros(frame.phases[i]) << ",1\n";
+        }
+    }
+}
+
+extern "C" uint64_t ActorProfiler_Start(void) {
+    if (!sProfilerRunning.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+extern "C" void ActorProfiler_EndActor(uint64_t start, int16_t actorId, uint8_t category, int32_t phase) {
+    if (start == 0 || actorId < 0 || actorId >= ACTOR_ID_MAX || category >= ACTORPROF_CATEGORY_MAX) {
+        return;
+    }
+
+    uint64_t ticks = std::chrono::steady_clock::now().time_since_epoch().count() - start;
+
+    sCurrentFrame.actors[actorId].ticks[phase] += ticks;
+    sCurrentFrame.actors[actorId].calls[phase]++;
+    sCurrentFrame.actorCategories[actorId] = category;
+    sCurrentFrame.categories[category].ticks[phase] += ticks;
+    sCurrentFrame.categories[category].calls[phase]++;
+}
+
+extern "C" void ActorProfiler_EndPhase(uint64_t start, int32_t phase) {
+    if (start == 0) {
+        return;
+    }
+
+    sCurrentFrame.phases[phase] += std::chrono::steady_clock::now().time_since_epoch().count() - start;
+}
+
+extern "C" void ActorProfiler_EndFrame(void) {
+    bool csvRequested = sCsvRequested.load();
+
+    if (csvRequested != sCsvStream.is_open()) {
+        if (csvRequested) {
+            sCsvStream.open(ACTORPROF_CSV_PATH, std::ios::out | std::ios::trunc);
+            sCsvStream << "frame,kind,id,name,category,phase,us,calls\n";
+        } else {
+            sCsvStream.close();
+        }
+    }
+
+    if (!sProfilerRunning.load()) {
+        return;
+    }
+
+    if (sCsvStream.is_open()) {
+        WriteCsvFrame(sCurrentFrame);
+    }
+    sFrameCount++;
+
+    {
+        std::lock_guard<std::mutex> lock(sPublishedMutex);
+        sLastFrame = sCurrentFrame;
+        AddFrame(sTotals, sCurrentFrame);
+        sTotalFrames++;
+    }
+
+    sCurrentFrame = {};
+}
+
+typedef struct {
+    int16_t id;
+    uint8_t category;
+    double micros[ACTORPROF_ACTOR_PHASE_MAX];
+    double total;
+    double count;
+} ActorProfileRow;
+
+enum ActorProfileColumn {
+    COLUMN_NAME,
+    COLUMN_ID,
+    COLUMN_CATEGORY,
+    COLUMN_COUNT,
+    COLUMN_UPDATE,
+    COLUMN_DRAW,
+    COLUMN_DYNA_MOVE,
+    COLUMN_TOTAL,
+};
+
+static double GetRowColumn(const ActorProfileRow& row, int column) {
+    switch (column) {
+        case COLUMN_ID:
+            return row.id;
+        case COLUMN_CATEGORY:
+            return row.category;
+        case COLUMN_COUNT:
+            return row.count;
+        case COLUMN_UPDATE:
+            return row.micros[ACTORPROF_UPDATE];
+        case COLUMN_DRAW:
+            return row.micros[ACTORPROF_DRAW];
+        case COLUMN_DYNA_MOVE:
+            return row.micros[ACTORPROF_DYNA_MOVE];
+        default:
+            return row.total;
+    }
+}
+
+static void SortRows(std::vector<ActorProfileRow>& rows, const ImGuiTableSortSpecs* sortSpecs, bool actorRows) {
+    if (sortSpecs == nullptr || sortSpecs->SpecsCount == 0) {
+        return;
+    }
+
+    const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[0];
+    bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+    int column = spec.ColumnUserID;
+
+    std::stable_sort(rows.begin(), rows.end(), [&](const ActorProfileRow& a, const ActorProfileRow& b) {
+        if (column == COLUMN_NAME) {
+            const char* nameA = actorRows ? GetActorName(a.id) : sCategoryNames[a.category];
+            const char* nameB = actorRows ? GetActorName(b.id) : sCategoryNames[b.category];
+            int cmp = strcmp(nameA, nameB);
+            return ascending ? cmp < 0 : cmp > 0;
+        }
+        double valueA = GetRowColumn(a, column);
+        double valueB = GetRowColumn(b, column);
+        return ascending ? valueA < valueB : valueA > valueB;
+    });
+}
+
+static void BuildRow(ActorProfileRow& row, const ActorProfileEntry& entry, uint32_t frames) {
+    row.total = 0.0;
+    for (size_t j = 0; j < ACTORPROF_ACTOR_PHASE_MAX; j++) {
+        row.micros[j] = TicksToMicros(entry.ticks[j]) / frames;
+        row.total += row.micros[j];
+    }
+    row.count = (double)std::max(entry.calls[ACTORPROF_UPDATE], entry.calls[ACTORPROF_DRAW]) / frames;
+}
+
+static void DrawProfileTable(const char* id, std::vector<ActorProfileRow>& rows, bool actorRows) {
+    ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+
+    if (!ImGui::BeginTable(id, actorRows ? 8 : 7, flags)) {
+        return;
+    }
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn(actorRows ? "Actor" : "Category", ImGuiTableColumnFlags_WidthStretch, 0.0f, COLUMN_NAME);
+    if (actorRows) {
+        ImGui::TableSetupColumn("ID", 0, 0.0f, COLUMN_ID);
+    }
+    ImGui::TableSetupColumn(actorRows ? "Category" : "Index", 0, 0.0f, COLUMN_CATEGORY);
+    ImGui::TableSetupColumn("Count", 0, 0.0f, COLUMN_COUNT);
+    ImGui::TableSetupColumn("Update (us)", 0, 0.0f, COLUMN_UPDATE);
+    ImGui::TableSetupColumn("Draw (us)", 0, 0.0f, COLUMN_DRAW);
+    ImGui::TableSetupColumn("Dyna (us)", 0, 0.0f, COLUMN_DYNA_MOVE);
+    ImGui::TableSetupColumn("Total (us)", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending,
+                            0.0f, COLUMN_TOTAL);
+    ImGui::TableHeadersRow();
+
+    SortRows(rows, ImGui::TableGetSortSpecs(), actorRows);
+
+    for (const ActorProfileRow& row : rows) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(actorRows ? GetActorName(row.id) : sCategoryNames[row.category]);
+        if (actorRows) {
+            ImGui::TableNextColumn();
+            ImGui::Text("0x%03X", row.id);
+        }
+        ImGui::TableNextColumn();
+        if (actorRows) {
+            ImGui::TextUnformatted(sCategoryNames[row.category]);
+        } else {
+            ImGui::Text("%d", row.category);
+        }
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", row.count);
+        for (size_t j = 0; j < ACTORPROF_ACTOR_PHASE_MAX; j++) {
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", row.micros[j]);
+        }
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", row.total);
+    }
+
+    ImGui::EndTable();
+}
+
+void DrawActorProfiler(bool& open) {
+    static bool showAverage = true;
+    static bool streamCsv = false;
+
+    sProfilerRunning = open || streamCsv;
+    if (!open) {
+        return;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(640, 520), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Actor Profiler", &open)) {
+        ImGui::End();
+        return;
+    }
+
+    bool reset = ImGui::Button("Reset");
+    ActorProfileFrame frame;
+    uint32_t frames;
+    {
+        std::lock_guard<std::mutex> lock(sPublishedMutex);
+        if (reset) {
+            sTotals = {};
+            sTotalFrames = 0;
+        }
+        frame = showAverage ? sTotals : sLastFrame;
+        frames = showAverage ? std::max(sTotalFrames, 1u) : 1;
+    }
+
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Average", showAverage)) {
+        showAverage = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Last Frame", !showAverage)) {
+        showAverage = false;
+    }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Stream CSV", &streamCsv)) {
+        sCsvRequested = streamCsv;
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Writes every profiled frame to " ACTORPROF_CSV_PATH ", even with this window closed");
+    }
+    if (showAverage) {
+        ImGui::Text("Averaged over %u frames", frames);
+    }
+
+    for (size_t i = 0; i < ACTORPROF_FRAME_PHASE_MAX; i++) {
+        ImGui::Text("%-22s %8.1f us", sFramePhaseNames[i], TicksToMicros(frame.phases[i]) / frames);
+    }
+
+    std::vector<ActorProfileRow> rows;
+
+    if (ImGui::BeginTabBar("ActorProfilerTabBar", ImGuiTabBarFlags_NoCloseWithMiddleMouseButton)) {
+        if (ImGui::BeginTabItem("Actors")) {
+            for (size_t i = 0; i < frame.actors.size(); i++) {
+                const ActorProfileEntry& entry = frame.actors[i];
+
+                if (entry.calls[ACTORPROF_UPDATE] == 0 && entry.calls[ACTORPROF_DRAW] == 0) {
+                    continue;
+                }
+                ActorProfileRow& row = rows.emplace_back();
+                row.id = i;
+                row.category = frame.actorCategories[i];
+                BuildRow(row, entry, frames);
+            }
+            DrawProfileTable("ActorProfilerActors", rows, true);
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem("Categories")) {
+            for (size_t i = 0; i < frame.categories.size(); i++) {
+                ActorProfileRow& row = rows.emplace_back();
+                row.id = -1;
+                row.category = i;
+                BuildRow(row, frame.categories[i], frames);
+            }
+            DrawProfileTable("ActorProfilerCategories", rows, false);
+            ImGui::EndTabItem();
+        }
+
+        ImGui::EndTabBar();
+    }
+
+    ImGui::End();
+}
+
+void InitActorProfiler() {
+    SohImGui::AddWindow("Debug", "Actor Profiler", DrawActorProfiler);
+}
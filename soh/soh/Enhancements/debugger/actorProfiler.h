@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ACTORPROF_UPDATE,    // actor->update
+    ACTORPROF_DRAW,      // actor->draw
+    ACTORPROF_DYNA_MOVE, // func_8003F8EC after each update
+    ACTORPROF_ACTOR_PHASE_MAX
+} ActorProfilerActorPhase;
+
+typedef enum {
+    ACTORPROF_DYNAPOLY_SETUP,
+    ACTORPROF_COLCHK_AT,
+    ACTORPROF_COLCHK_OC,
+    ACTORPROF_COLCHK_DAMAGE,
+    ACTORPROF_FRAME_PHASE_MAX
+} ActorProfilerFramePhase;
+
+// Returns a start timestamp to pass to the End functions, or 0 if the profiler isn't running
+uint64_t ActorProfiler_Start(void);
+void ActorProfiler_EndActor(uint64_t start, int16_t actorId, uint8_t category, int32_t phase);
+void ActorProfiler_EndPhase(uint64_t start, int32_t phase);
+// Publishes the game frame's totals to the window and the CSV stream
+void ActorProfiler_EndFrame(void);
+
+#ifdef __cplusplus
+}
+
+void InitActorProfiler();
+#endif
@@ -1,6 +1,8 @@
 #include "debugger.h"
 #include "debugSaveEditor.h"
+#include "actorProfiler.h"
 
 void Debug_Init(void) {
     InitSaveEditor();
+    InitActorProfiler();
 }
@@ -20,21 +20,99 @@
 #include <Cutscene.h>
 #include <Texture.h>
 #include "Lib/stb/stb_image.h"
+#include "Lib/Fast3D/gfx_pc.h"
 #include "AudioPlayer.h"
 #include "../soh/Enhancements/debugconsole.h"
 #include "../soh/Enhancements/debugger/debugger.h"
 #include "Utils/BitConverter.h"
 #include "variables.h"
+#include <atomic>
+#include <chrono>
 
 OTRGlobals* OTRGlobals::Instance;
 
+// 528 and 544 relate to 60 fps at 32 kHz 32000/60 = 533.333..
+// in an ideal world, one third of the calls should use num_samples=544 and two thirds num_samples=528
+#define SAMPLES_HIGH 560
+#define SAMPLES_LOW 528
+// PAL values
+//#define SAMPLES_HIGH 656
+//#define SAMPLES_LOW 624
+#define AUDIO_FRAMES_PER_UPDATE (R_UPDATE_RATE > 0 ? R_UPDATE_RATE : 1 )
+#define NUM_AUDIO_CHANNELS 2
+#define AUDIO_MAX_FRAMES_AHEAD 16
+
+// Fixed size queue with exactly one producer and one consumer thread, the two counters are all the synchronization it needs.
+// The producer fills Back() and publishes it with Push(), the consumer reads Front() and releases it with Pop().
+template <typename T, uint32_t N>
+struct SpscRing {
+    static_assert((N & (N - 1)) == 0, "The counters wrap around, N has to divide 2^32");
+
+    std::atomic<uint32_t> read;
+    std::atomic<uint32_t> write;
+    T slots[N];
+
+    uint32_t Size() {
+        return write.load(std::memory_order_acquire) - read.load(std::memory_order_acquire);
+    }
+
+    T* Back() {
+        const uint32_t w = write.load(std::memory_order_relaxed);
+        return w - read.load(std::memory_order_acquire) == N ? nullptr : &slots[w % N];
+    }
+
+    void Push() {
+        write.store(write.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    T* Front() {
+        const uint32_t r = read.load(std::memory_order_relaxed);
+        return r == write.load(std::memory_order_acquire) ? nullptr : &slots[r % N];
+    }
+
+    void Pop() {
+        read.store(read.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+struct AudioFrame {
+    s16 samples[SAMPLES_HIGH * NUM_AUDIO_CHANNELS];
+    u32 num_samples;
+};
+
+// With WINDOW/AUDIO FRAMES AHEAD at 0 the audio thread makes the audio for each game frame while it is drawn and the frame waits for it.
+// Otherwise one thread synthesizes up to that many audio frames ahead of the device and another one hands them to the device as it
+// runs low, the game only exchanges messages with them through the rings below.
 static struct {
     std::condition_variable cv_to_thread, cv_from_thread;
     std::mutex mutex;
     bool initialized;
     bool processing;
+    uint32_t frames_ahead;
+    SpscRing<AudioFrame, AUDIO_MAX_FRAMES_AHEAD> frames;
+    SpscRing<u32, 4> cmd_mesgs; // Game to audio, the capacity of gAudioContext.cmdProcMsgs
+    SpscRing<u32, 1> reset_mesgs; // Audio to game, gAudioContext.audioResetMesgs
+    SpscRing<u32, 16> load_mesgs; // Audio to game, gAudioContext.externalLoadMesgBuf
 } audio;
 
+// With WINDOW/RENDER PIPELINE set the game runs on a thread of its own and builds the next frame in the other GfxPool while this one is drawn.
+// Window events, the menus and everything touching the rendering API stay on the main thread, and the game is only started once they are done.
+static struct {
+    std::condition_variable cv_to_thread, cv_from_thread, cv_rendered;
+    std::mutex mutex;
+    void (*run_one_game_iter)(void);
+    bool enabled;
+    bool running; // The game thread is inside run_one_game_iter
+    bool rendering; // The main thread is drawing the frame before the one the game works on
+    bool clear_texture_cache;
+    Gfx* commands; // Finished by the game and not drawn yet
+    int frame_divisor;
+    // The main thread keeps resizing the draw area and the window while the game runs, the game sees them as they were when it was started.
+    GfxDimensions dimensions;
+    uint32_t window_width, window_height;
+    std::vector<std::shared_ptr<Ship::Resource>> retired; // Replaced while the previous frame was built, it may still point at them
+} pipeline;
+
 OTRGlobals::OTRGlobals() {
     context = Ship::GlobalCtx2::CreateInstance("Ship of Harkinian");
     context->GetWindow()->Init();
@@ -85,17 +163,75 @@ extern "C" uint64_t GetPerfCounter() {
     return ticks.QuadPart;
 }
 
-// C->C++ Bridge
-extern "C" void Graph_ProcessFrame(void (*run_one_game_iter)(void)) {
-    OTRGlobals::Instance->context->GetWindow()->MainLoop(run_one_game_iter);
+template <uint32_t N>
+static s32 Audio_SendMesg(SpscRing<u32, N>& ring, u32 msg) {
+    u32* slot = ring.Back();
+    if (slot == nullptr) {
+        return -1;
+    }
+
+    *slot = msg;
+    ring.Push();
+    return 0;
 }
 
-// C->C++ Bridge
-extern "C" void Graph_ProcessGfxCommands(Gfx* commands) {
-    OTRGlobals::Instance->context->GetWindow()->SetFrameDivisor(R_UPDATE_RATE);
+template <uint32_t N>
+static s32 Audio_RecvMesg(SpscRing<u32, N>& ring, u32* msg) {
+    const u32* slot = ring.Front();
+    if (slot == nullptr) {
+        return -1;
+    }
+
+    if (msg != nullptr) {
+        *msg = *slot;
+    }
+    ring.Pop();
+    return 0;
+}
+
+static void Audio_SynthesisThread() {
+    // Two short frames for every long one average out to 533.33 samples
+    static const u32 frame_samples[3] = { SAMPLES_LOW, SAMPLES_LOW, SAMPLES_LOW + 16 };
+
+    for (uint32_t i = 0;; i++) {
+        while (audio.frames.Size() >= audio.frames_ahead) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        AudioFrame* frame = audio.frames.Back();
+        frame->num_samples = frame_samples[i % 3];
+        AudioMgr_CreateNextAudioBuffer(frame->samples, frame->num_samples);
+        audio.frames.Push();
+    }
+}
+
+static void Audio_PlaybackThread() {
+    for (;;) {
+        const AudioFrame* frame = audio.frames.Front();
+        if (frame == nullptr || AudioPlayer_Buffered() >= AudioPlayer_GetDesiredBuffered()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
 
+        AudioPlayer_Play((const u8*)frame->samples, frame->num_samples * (sizeof(int16_t) * NUM_AUDIO_CHANNELS));
+        audio.frames.Pop();
+    }
+}
+
+static void Audio_StartFrame() {
     if (!audio.initialized) {
         audio.initialized = true;
+        audio.frames_ahead = OTRGlobals::Instance->context->GetWindow()->GetAudioFramesAhead();
+        if (audio.frames_ahead > AUDIO_MAX_FRAMES_AHEAD) {
+            audio.frames_ahead = AUDIO_MAX_FRAMES_AHEAD;
+        }
+
+        if (audio.frames_ahead > 0) {
+            std::thread(Audio_SynthesisThread).detach();
+            std::thread(Audio_PlaybackThread).detach();
+            return;
+        }
+
         std::thread([]() {
             for (;;) {
                 {
@@ -105,15 +241,6 @@ extern "C" void Graph_ProcessGfxCommands(Gfx* commands) {
                     }
                 }
                 //AudioMgr_ThreadEntry(&gAudioMgr);
-                // 528 and 544 relate to 60 fps at 32 kHz 32000/60 = 533.333..
-                // in an ideal world, one third of the calls should use num_samples=544 and two thirds num_samples=528
-                #define SAMPLES_HIGH 560
-                #define SAMPLES_LOW 528
-                // PAL values
-                //#define SAMPLES_HIGH 656
-                //#define SAMPLES_LOW 624
-                #define AUDIO_FRAMES_PER_UPDATE (R_UPDATE_RATE > 0 ? R_UPDATE_RATE : 1 )
-                #define NUM_AUDIO_CHANNELS 2
                 int samples_left = AudioPlayer_Buffered();
                 u32 num_audio_samples = samples_left < AudioPlayer_GetDesiredBuffered() ? SAMPLES_HIGH : SAMPLES_LOW;
                 // printf("Audio samples: %d %u\n", samples_left, num_audio_samples);
@@ -138,20 +265,197 @@ extern "C" void Graph_ProcessGfxCommands(Gfx* commands) {
         }).detach();
     }
 
+    // The synthesis thread keeps going on its own
+    if (audio.frames_ahead > 0) {
+        return;
+    }
+
     {
         std::unique_lock<std::mutex> Lock(audio.mutex);
         audio.processing = true;
     }
     audio.cv_to_thread.notify_one();
+}
 
-    OTRGlobals::Instance->context->GetWindow()->RunCommands(commands);
+static void Audio_WaitForFrame() {
+    std::unique_lock<std::mutex> Lock(audio.mutex);
+    while (audio.processing) {
+        audio.cv_from_thread.wait(Lock);
+    }
+}
+
+// C->C++ Bridge
+extern "C" s32 Audio_SendCmdMesg(u32 msg) {
+    return Audio_SendMesg(audio.cmd_mesgs, msg);
+}
+
+// C->C++ Bridge
+extern "C" s32 Audio_RecvCmdMesg(u32* msg) {
+    return Audio_RecvMesg(audio.cmd_mesgs, msg);
+}
+
+// C->C++ Bridge
+extern "C" s32 Audio_SendResetMesg(u32 msg) {
+    return Audio_SendMesg(audio.reset_mesgs, msg);
+}
+
+// C->C++ Bridge
+extern "C" s32 Audio_RecvResetMesg(u32* msg) {
+    return Audio_RecvMesg(audio.reset_mesgs, msg);
+}
+
+// C->C++ Bridge
+extern "C" s32 Audio_SendLoadMesg(u32 msg) {
+    return Audio_SendMesg(audio.load_mesgs, msg);
+}
+
+// C->C++ Bridge
+extern "C" s32 Audio_RecvLoadMesg(u32* msg) {
+    return Audio_RecvMesg(audio.load_mesgs, msg);
+}
+
+static void Pipeline_WaitForGame() {
+    std::unique_lock<std::mutex> Lock(pipeline.mutex);
+    while (pipeline.running) {
+        pipeline.cv_from_thread.wait(Lock);
+    }
+}
+
+static void Pipeline_RunGame() {
+    const auto window = OTRGlobals::Instance->context->GetWindow();
+    uint32_t window_width = window->GetCurrentWidth();
+    uint32_t window_height = window->GetCurrentHeight();
 
     {
-        std::unique_lock<std::mutex> Lock(audio.mutex);
-        while (audio.processing) {
-            audio.cv_from_thread.wait(Lock);
+        std::unique_lock<std::mutex> Lock(pipeline.mutex);
+        pipeline.dimensions = gfx_current_dimensions;
+        pipeline.window_width = window_width;
+        pipeline.window_height = window_height;
+        pipeline.running = true;
+    }
+    pipeline.cv_to_thread.notify_one();
+}
+
+// Resources can only go away while nothing is drawn, called from the game thread.
+static void Pipeline_WaitForRender() {
+    std::unique_lock<std::mutex> Lock(pipeline.mutex);
+    while (pipeline.rendering) {
+        pipeline.cv_rendered.wait(Lock);
+    }
+}
+
+static void Pipeline_ClearTextureCache() {
+    if (!pipeline.enabled) {
+        gfx_texture_cache_clear();
+        return;
+    }
+
+    std::unique_lock<std::mutex> Lock(pipeline.mutex);
+    pipeline.clear_texture_cache = true;
+}
+
+static void Pipeline_Start() {
+    OTRGlobals::Instance->context->GetWindow()->SetPixelDepthDeferred(true);
+    OTRGlobals::Instance->context->GetResourceManager()->SetDeferReplacedRelease(true);
+    pipeline.enabled = true;
+
+    std::thread([]() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> Lock(pipeline.mutex);
+                while (!pipeline.running) {
+                    pipeline.cv_to_thread.wait(Lock);
+                }
+            }
+
+            pipeline.run_one_game_iter();
+
+            {
+                std::unique_lock<std::mutex> Lock(pipeline.mutex);
+                pipeline.running = false;
+            }
+            pipeline.cv_from_thread.notify_one();
         }
+    }).detach();
+}
+
+static void Graph_RunOneIteration() {
+    const auto window = OTRGlobals::Instance->context->GetWindow();
+
+    // The first frame runs here like it would without the pipeline, it creates framebuffers from inside the game.
+    if (!pipeline.enabled) {
+        pipeline.run_one_game_iter();
+
+        if (window->IsRenderPipelined()) {
+            Pipeline_Start();
+        }
+        return;
+    }
+
+    Pipeline_WaitForGame();
+
+    // That frame was drawn as it was made, so the game has to make one before there is anything to draw.
+    if (pipeline.commands == nullptr) {
+        Pipeline_RunGame();
+        Pipeline_WaitForGame();
+    }
+
+    // Neither thread is working on a frame until the game is started again below.
+    pipeline.retired = OTRGlobals::Instance->context->GetResourceManager()->TakeReplacedResources();
+
+    if (pipeline.clear_texture_cache) {
+        pipeline.clear_texture_cache = false;
+        gfx_texture_cache_clear();
+    }
+
+    Gfx* commands = pipeline.commands;
+    pipeline.commands = nullptr;
+
+    if (commands == nullptr) {
+        return;
+    }
+
+    window->SetFrameDivisor(pipeline.frame_divisor);
+    window->StartFrame();
+
+    pipeline.rendering = true;
+    Pipeline_RunGame();
+
+    window->RenderFrame(commands);
+
+    {
+        std::unique_lock<std::mutex> Lock(pipeline.mutex);
+        pipeline.rendering = false;
     }
+    pipeline.cv_rendered.notify_all();
+}
+
+// C->C++ Bridge
+extern "C" void Graph_ProcessFrame(void (*run_one_game_iter)(void)) {
+    pipeline.run_one_game_iter = run_one_game_iter;
+    OTRGlobals::Instance->context->GetWindow()->MainLoop(Graph_RunOneIteration);
+}
+
+// C->C++ Bridge
+extern "C" void Graph_ProcessGfxCommands(Gfx* commands) {
+    // Pipelined, this is the game thread. The frame is drawn by the main thread while the game builds the next one.
+    if (pipeline.enabled) {
+        Audio_StartFrame();
+        Audio_WaitForFrame();
+
+        std::unique_lock<std::mutex> Lock(pipeline.mutex);
+        pipeline.commands = commands;
+        pipeline.frame_divisor = R_UPDATE_RATE;
+        return;
+    }
+
+    OTRGlobals::Instance->context->GetWindow()->SetFrameDivisor(R_UPDATE_RATE);
+
+    Audio_StartFrame();
+
+    OTRGlobals::Instance->context->GetWindow()->RunCommands(commands);
+
+    Audio_WaitForFrame();
 
     // OTRTODO: FIGURE OUT END FRAME POINT
    /* if (OTRGlobals::Instance->context->GetWindow()->lastScancode != -1)
@@ -159,6 +463,11 @@ extern "C" void Graph_ProcessGfxCommands(Gfx* commands) {
 
 }
 
+// C->C++ Bridge
+extern "C" void Graph_WaitForRender() {
+    Pipeline_WaitForRender();
+}
+
 float divisor_num = 0.0f;
 
 extern "C" void OTRGetPixelDepthPrepare(float x, float y) {
@@ -195,6 +504,25 @@ extern "C" void ResourceMgr_InvalidateCache() {
     OTRGlobals::Instance->context->GetResourceManager()->InvalidateResourceCache();
 }
 
+extern "C" void ResourceMgr_EvictResources() {
+    Pipeline_WaitForRender();
+
+    // Texture cache entries are keyed by address, evicted textures must not be matched by whatever gets allocated there next.
+    if (OTRGlobals::Instance->context->GetResourceManager()->EvictResources() > 0)
+        Pipeline_ClearTextureCache();
+}
+
+extern "C" void ResourceMgr_RefreshPatches() {
+    Pipeline_WaitForRender();
+
+    if (OTRGlobals::Instance->context->GetResourceManager()->RefreshPatches() > 0)
+        Pipeline_ClearTextureCache();
+}
+
+extern "C" void ResourceMgr_RequestPatchRescan() {
+    OTRGlobals::Instance->context->GetResourceManager()->RequestPatchRescan();
+}
+
 
 extern "C" void ResourceMgr_LoadFile(const char* resName) {
     OTRGlobals::Instance->context->GetResourceManager()->LoadResource(resName);
@@ -307,6 +635,7 @@ extern "C" char* ResourceMgr_LoadArrayByNameAsVec3s(const char* path) {
         }
 
         res->cachedGameAsset = data;
+        res->cachedGameAssetSize = sizeof(Vec3s) * res->scalars.size();
 
         return (char*)data;
     }
@@ -402,6 +731,11 @@ extern "C" CollisionHeader* ResourceMgr_LoadColByName(const char* path)
     }
 
     colRes->cachedGameAsset = colHeader;
+    colRes->cachedGameAssetSize = sizeof(CollisionHeader) + sizeof(Vec3s) * colHeader->numVertices +
+                                  sizeof(CollisionPoly) * colHeader->numPolygons +
+                                  sizeof(SurfaceType) * colRes->polygonTypes.size() +
+                                  (sizeof(CamData) + sizeof(Vec3s)) * colRes->camData->entries.size() +
+                                  sizeof(WaterBox) * colHeader->numWaterBoxes;
 
     return (CollisionHeader*)colHeader;
 }
@@ -436,6 +770,7 @@ extern "C" AnimationHeaderCommon* ResourceMgr_LoadAnimByName(const char* path) {
         return (AnimationHeaderCommon*)res->cachedGameAsset;
 
     AnimationHeaderCommon* anim = nullptr;
+    size_t animSize = 0;
 
     if (res->type == Ship::AnimationType::Normal) {
         AnimationHeader* animNormal = (AnimationHeader*)malloc(sizeof(AnimationHeader));
@@ -455,6 +790,8 @@ extern "C" AnimationHeaderCommon* ResourceMgr_LoadAnimByName(const char* path) {
         }
 
         animNormal->staticIndexMax = res->limit;
+        animSize = sizeof(AnimationHeader) + res->rotationValues.size() * sizeof(int16_t) +
+                   res->rotationIndices.size() * sizeof(Vec3s);
 
         anim = (AnimationHeaderCommon*)animNormal;
     }
@@ -482,17 +819,22 @@ extern "C" AnimationHeaderCommon* ResourceMgr_LoadAnimByName(const char* path) {
         for (int i = 0; i < res->refIndexArr.size(); i++)
             animCurve->refIndex[i] = res->refIndexArr[i];
 
+        animSize = sizeof(TransformUpdateIndex) + res->copyValuesArr.size() * sizeof(s16) +
+                   res->transformDataArr.size() * sizeof(TransformData) + res->refIndexArr.size();
+
         anim = (AnimationHeaderCommon*)animCurve;
     }
     else {
         LinkAnimationHeader* animLink = (LinkAnimationHeader*)malloc(sizeof(LinkAnimationHeader));
         animLink->common.frameCount = res->frameCount;
         animLink->segment = (void*)res->segPtr;
+        animSize = sizeof(LinkAnimationHeader);
 
         anim = (AnimationHeaderCommon*)animLink;
     }
 
     res->cachedGameAsset = anim;
+    res->cachedGameAssetSize = animSize;
 
     return anim;
 }
@@ -504,21 +846,33 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
         return (SkeletonHeader*)res->cachedGameAsset;
 
     SkeletonHeader* baseHeader = nullptr;
+    size_t skelSize = 0;
+
+    // The converted limbs point into these display lists, so the skeleton keeps them from being evicted.
+    const auto loadDList = [&res](const std::string& dListPath) {
+        auto dList = std::static_pointer_cast<Ship::DisplayList>(
+            OTRGlobals::Instance->context->GetResourceManager()->LoadResource(dListPath));
+        res->assetDependencies.push_back(dList);
+        return (Gfx*)&dList->instructions[0];
+    };
 
     if (res->type == Ship::SkeletonType::Normal)
     {
         baseHeader = (SkeletonHeader*)malloc(sizeof(SkeletonHeader));
+        skelSize += sizeof(SkeletonHeader);
     }
     else if (res->type == Ship::SkeletonType::Curve)
     {
         SkelCurveLimbList* curve = (SkelCurveLimbList*)malloc(sizeof(SkelCurveLimbList));
         curve->limbCount = res->limbCount;
         curve->limbs = (SkelCurveLimb**)malloc(res->limbCount * sizeof(SkelCurveLimb*));
+        skelSize += sizeof(SkelCurveLimbList) + res->limbCount * sizeof(SkelCurveLimb*);
         baseHeader = (SkeletonHeader*)curve;
     }
     else {
         FlexSkeletonHeader* flex = (FlexSkeletonHeader*)malloc(sizeof(FlexSkeletonHeader));
         flex->dListCount = res->dListCount;
+        skelSize += sizeof(FlexSkeletonHeader);
 
         baseHeader = (SkeletonHeader*)flex;
     }
@@ -527,6 +881,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
     {
         baseHeader->limbCount = res->limbCount;
         baseHeader->segment = (void**)malloc(sizeof(StandardLimb*) * res->limbTable.size());
+        skelSize += sizeof(StandardLimb*) * res->limbTable.size();
     }
 
     for (int i = 0; i < res->limbTable.size(); i++) {
@@ -536,6 +891,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
 
         if (limb->limbType == Ship::LimbType::LOD) {
             LodLimb* limbC = (LodLimb*)malloc(sizeof(LodLimb));
+            skelSize += sizeof(LodLimb);
             limbC->jointPos.x = limb->transX;
             limbC->jointPos.y = limb->transY;
             limbC->jointPos.z = limb->transZ;
@@ -543,14 +899,14 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
             limbC->sibling = limb->siblingIndex;
 
             if (limb->dListPtr != "") {
-                auto dList = ResourceMgr_LoadGfxByName(limb->dListPtr.c_str());
+                auto dList = loadDList(limb->dListPtr);
                 limbC->dLists[0] = dList;
             } else {
                 limbC->dLists[0] = nullptr;
             }
 
             if (limb->dList2Ptr != "") {
-                auto dList = ResourceMgr_LoadGfxByName(limb->dList2Ptr.c_str());
+                auto dList = loadDList(limb->dList2Ptr);
                 limbC->dLists[1] = dList;
             } else {
                 limbC->dLists[1] = nullptr;
@@ -561,6 +917,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
         else if (limb->limbType == Ship::LimbType::Standard)
         {
             const auto limbC = new StandardLimb;
+            skelSize += sizeof(StandardLimb);
             limbC->jointPos.x = limb->transX;
             limbC->jointPos.y = limb->transY;
             limbC->jointPos.z = limb->transZ;
@@ -569,7 +926,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
             limbC->dList = nullptr;
 
             if (!limb->dListPtr.empty()) {
-                const auto dList = ResourceMgr_LoadGfxByName(limb->dListPtr.c_str());
+                const auto dList = loadDList(limb->dListPtr);
                 limbC->dList = dList;
             }
 
@@ -578,6 +935,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
         else if (limb->limbType == Ship::LimbType::Curve)
         {
             const auto limbC = new SkelCurveLimb;
+            skelSize += sizeof(SkelCurveLimb);
 
             limbC->firstChildIdx = limb->childIndex;
             limbC->nextLimbIdx = limb->siblingIndex;
@@ -585,12 +943,12 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
             limbC->dList[1] = nullptr;
 
             if (!limb->dListPtr.empty()) {
-                const auto dList = ResourceMgr_LoadGfxByName(limb->dListPtr.c_str());
+                const auto dList = loadDList(limb->dListPtr);
                 limbC->dList[0] = dList;
             }
 
             if (!limb->dList2Ptr.empty()) {
-                const auto dList = ResourceMgr_LoadGfxByName(limb->dList2Ptr.c_str());
+                const auto dList = loadDList(limb->dList2Ptr);
                 limbC->dList[1] = dList;
             }
 
@@ -600,6 +958,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
         else if (limb->limbType == Ship::LimbType::Skin)
         {
             const auto limbC = new SkinLimb;
+            skelSize += sizeof(SkinLimb);
             limbC->jointPos.x = limb->transX;
             limbC->jointPos.y = limb->transY;
             limbC->jointPos.z = limb->transZ;
@@ -616,7 +975,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
                 limbC->segmentType = 0;
 
             if (limb->skinSegmentType == Ship::ZLimbSkinType::SkinType_DList)
-                limbC->segment = ResourceMgr_LoadGfxByName(limb->skinDList.c_str());
+                limbC->segment = loadDList(limb->skinDList);
             else if (limb->skinSegmentType == Ship::ZLimbSkinType::SkinType_4) {
                 const auto animData = new SkinAnimatedLimbData;
                 const int skinDataSize = limb->skinData.size();
@@ -624,7 +983,8 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
                 animData->totalVtxCount = limb->skinVtxCnt;
                 animData->limbModifCount = skinDataSize;
                 animData->limbModifications = new SkinLimbModif[animData->limbModifCount];
-                animData->dlist = ResourceMgr_LoadGfxByName(limb->skinDList2.c_str());
+                skelSize += sizeof(SkinAnimatedLimbData) + sizeof(SkinLimbModif) * animData->limbModifCount;
+                animData->dlist = loadDList(limb->skinDList2);
 
                 for (int i = 0; i < skinDataSize; i++)
                 {
@@ -633,6 +993,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
                     animData->limbModifications[i].unk_4 = limb->skinData[i].unk_4;
 
                     animData->limbModifications[i].skinVertices = new SkinVertex[limb->skinData[i].unk_8_arr.size()];
+                    skelSize += sizeof(SkinVertex) * limb->skinData[i].unk_8_arr.size();
 
                     for (int k = 0; k < limb->skinData[i].unk_8_arr.size(); k++)
                     {
@@ -647,6 +1008,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
 
                     animData->limbModifications[i].limbTransformations =
                         new SkinTransformation[limb->skinData[i].unk_C_arr.size()];
+                    skelSize += sizeof(SkinTransformation) * limb->skinData[i].unk_C_arr.size();
 
                     for (int k = 0; k < limb->skinData[i].unk_C_arr.size(); k++)
                     {
@@ -680,6 +1042,7 @@ extern "C" SkeletonHeader* ResourceMgr_LoadSkeletonByName(const char* path) {
     }
 
     res->cachedGameAsset = baseHeader;
+    res->cachedGameAssetSize = skelSize;
 
     return baseHeader;
 }
@@ -770,10 +1133,16 @@ extern "C" void OTRGfxPrint(const char* str, void* printer, void (*printImpl)(vo
 }
 
 extern "C" uint32_t OTRGetCurrentWidth() {
+    if (pipeline.enabled)
+        return pipeline.window_width;
+
     return OTRGlobals::Instance->context->GetWindow()->GetCurrentWidth();
 }
 
 extern "C" uint32_t OTRGetCurrentHeight() {
+    if (pipeline.enabled)
+        return pipeline.window_height;
+
     return OTRGlobals::Instance->context->GetWindow()->GetCurrentHeight();
 }
 
@@ -787,6 +1156,9 @@ extern "C" void OTRControllerCallback(ControllerCallback* controller) {
 }
 
 extern "C" float OTRGetAspectRatio() {
+    if (pipeline.enabled)
+        return pipeline.dimensions.aspect_ratio;
+
     return gfx_current_dimensions.aspect_ratio;
 }
 
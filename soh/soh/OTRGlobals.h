@@ -22,6 +22,7 @@ private:
 void InitOTR();
 void Graph_ProcessFrame(void (*run_one_game_iter)(void));
 void Graph_ProcessGfxCommands(Gfx* commands);
+void Graph_WaitForRender();
 void OTRLogString(const char* src);
 void OTRGfxPrint(const char* str, void* printer, void (*printImpl)(void*, char));
 void OTRGetPixelDepthPrepare(float x, float y);
@@ -29,6 +30,10 @@ uint16_t OTRGetPixelDepth(float x, float y);
 int32_t OTRGetLastScancode();
 uint32_t ResourceMgr_GetGameVersion();
 void ResourceMgr_CacheDirectory(const char* resName);
+void ResourceMgr_EvictResources();
+void ResourceMgr_RefreshPatches();
+void ResourceMgr_RequestPatchRescan();
+void OTRScene_WaitForRoomLoad();
 void ResourceMgr_LoadFile(const char* resName);
 char* ResourceMgr_LoadFileFromDisk(const char* filePath);
 char* ResourceMgr_LoadTexByName(const char* texPath);
@@ -64,4 +69,10 @@ int AudioPlayer_Buffered(void);
 int AudioPlayer_GetDesiredBuffered(void);
 void AudioPlayer_Play(const uint8_t* buf, uint32_t len);
 void AudioMgr_CreateNextAudioBuffer(s16* samples, u32 num_samples);
+s32 Audio_SendCmdMesg(u32 msg);
+s32 Audio_RecvCmdMesg(u32* msg);
+s32 Audio_SendResetMesg(u32 msg);
+s32 Audio_RecvResetMesg(u32* msg);
+s32 Audio_SendLoadMesg(u32 msg);
+s32 Audio_RecvLoadMesg(u32* msg);
 #endif
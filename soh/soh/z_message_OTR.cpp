@@ -11,9 +11,14 @@ extern "C" MessageTableEntry* sNesMessageEntryTablePtr;
 extern "C" MessageTableEntry* sStaffMessageEntryTablePtr;
 //extern "C" MessageTableEntry* _message_0xFFFC_nes;
 
+// The message tables point into the text for as long as the game runs, so it must never be evicted from the resource cache.
+static std::shared_ptr<Ship::Text> sNesMessageText;
+static std::shared_ptr<Ship::Text> sStaffMessageText;
+
 extern "C" void OTRMessage_Init()
 {
 	auto file = std::static_pointer_cast<Ship::Text>(OTRGlobals::Instance->context->GetResourceManager()->LoadResource("text/nes_message_data_static/nes_message_data_static"));
+	sNesMessageText = file;
 
 	sNesMessageEntryTablePtr = (MessageTableEntry*)malloc(sizeof(MessageTableEntry) * file->messages.size());
 
@@ -31,6 +36,7 @@ extern "C" void OTRMessage_Init()
 	}
 
 	auto file2 = std::static_pointer_cast<Ship::Text>(OTRGlobals::Instance->context->GetResourceManager()->LoadResource("text/staff_message_data_static/staff_message_data_static"));
+	sStaffMessageText = file2;
 
 	sStaffMessageEntryTablePtr = (MessageTableEntry*)malloc(sizeof(MessageTableEntry) * file2->messages.size());
 
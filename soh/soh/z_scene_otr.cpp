@@ -200,6 +200,12 @@ bool func_80098674(GlobalContext* globalCtx, Ship::SceneCommand* cmd)
         }
 
         colRes->cachedGameAsset = colHeader;
+        colRes->cachedGameAssetSize = sizeof(CollisionHeader) + sizeof(Vec3s) * colHeader->numVertices +
+                                      sizeof(CollisionPoly) * colHeader->numPolygons +
+                                      sizeof(SurfaceType) * colRes->polygonTypes.size() +
+                                      sizeof(CamData) * colRes->camData->entries.size() +
+                                      sizeof(Vec3s) * colRes->camData->cameraPositionData.size() +
+                                      sizeof(WaterBox) * colHeader->numWaterBoxes;
     }
 
     BgCheck_Allocate(&globalCtx->colCtx, globalCtx, colHeader);
@@ -876,11 +882,56 @@ s32 OTRScene_ExecuteCommands(GlobalContext* globalCtx, Ship::Scene* scene)
     return 0;
 }
 
+// The room requested by OTRfunc_8009728C, loaded in the background while OTRfunc_800973FC polls it.
+static std::shared_ptr<Ship::ResourcePromise> sRoomLoadPromise;
+
+// Starts loading every room a transition actor connects to roomNum, so walking through a door finds it already parsed.
+static void OTRScene_PrefetchAdjacentRooms(GlobalContext* globalCtx, s32 roomNum) {
+    auto resMgr = OTRGlobals::Instance->context->GetResourceManager();
+
+    for (s32 i = 0; i < globalCtx->transiActorCtx.numActors; i++) {
+        TransitionActorEntry* entry = &globalCtx->transiActorCtx.list[i];
+
+        if (entry->sides[0].room != roomNum && entry->sides[1].room != roomNum)
+            continue;
+
+        for (s32 side = 0; side < 2; side++) {
+            s32 adjacentRoom = entry->sides[side].room;
+
+            if (adjacentRoom >= 0 && adjacentRoom != roomNum && adjacentRoom < globalCtx->numRooms)
+                resMgr->LoadResourceAsync(globalCtx->roomList[adjacentRoom].fileName);
+        }
+    }
+}
+
 extern "C" s32 OTRfunc_800973FC(GlobalContext* globalCtx, RoomContext* roomCtx) {
     if (roomCtx->status == 1) {
         //if (!osRecvMesg(&roomCtx->loadQueue, NULL, OS_MESG_NOBLOCK)) {
-        if (1)
+        bool loaded = true;
+
+        if (sRoomLoadPromise != nullptr) {
+            std::unique_lock<std::mutex> Lock(sRoomLoadPromise->ResourceLoadMutex);
+            loaded = sRoomLoadPromise->bHasResourceLoaded;
+        }
+
+        if (loaded)
         {
+            if (sRoomLoadPromise != nullptr) {
+                roomCtx->roomToLoad = (Ship::Scene*)sRoomLoadPromise->Resource.get();
+                sRoomLoadPromise = nullptr;
+
+                // The background load failed, try once more on this thread before giving up on the room.
+                if (roomCtx->roomToLoad == nullptr) {
+                    roomCtx->roomToLoad = (Ship::Scene*)OTRGlobals::Instance->context->GetResourceManager()
+                                              ->LoadResource(globalCtx->roomList[roomCtx->curRoom.num].fileName)
+                                              .get();
+                }
+            }
+
+            if (roomCtx->roomToLoad == nullptr) {
+                Fault_AddHungupAndCrashImpl("ROOM LOAD FAILED", globalCtx->roomList[roomCtx->curRoom.num].fileName);
+            }
+
             roomCtx->status = 0;
             roomCtx->curRoom.segment = roomCtx->unk_34;
             gSegments[3] = VIRTUAL_TO_PHYSICAL(roomCtx->unk_34);
@@ -888,6 +939,7 @@ extern "C" s32 OTRfunc_800973FC(GlobalContext* globalCtx, RoomContext* roomCtx)
             OTRScene_ExecuteCommands(globalCtx, roomCtx->roomToLoad);
             Player_SetBootData(globalCtx, GET_PLAYER(globalCtx));
             Actor_SpawnTransitionActors(globalCtx, &globalCtx->actorCtx);
+            OTRScene_PrefetchAdjacentRooms(globalCtx, roomCtx->curRoom.num);
 
             return 1;
         }
@@ -898,6 +950,17 @@ extern "C" s32 OTRfunc_800973FC(GlobalContext* globalCtx, RoomContext* roomCtx)
     return 1;
 }
 
+extern "C" void OTRScene_WaitForRoomLoad() {
+    if (sRoomLoadPromise == nullptr)
+        return;
+
+    std::unique_lock<std::mutex> Lock(sRoomLoadPromise->ResourceLoadMutex);
+
+    while (!sRoomLoadPromise->bHasResourceLoaded) {
+        sRoomLoadPromise->ResourceLoadNotifier.wait(Lock);
+    }
+}
+
 extern "C" s32 OTRfunc_8009728C(GlobalContext* globalCtx, RoomContext* roomCtx, s32 roomNum) {
     u32 size;
 
@@ -919,9 +982,9 @@ extern "C" s32 OTRfunc_8009728C(GlobalContext* globalCtx, RoomContext* roomCtx,
         //DmaMgr_SendRequest2(&roomCtx->dmaRequest, roomCtx->unk_34, globalCtx->roomList[roomNum].vromStart, size, 0,
                             //&roomCtx->loadQueue, NULL, "../z_room.c", 1036);
 
-        auto roomData = OTRGlobals::Instance->context->GetResourceManager()->LoadResource(globalCtx->roomList[roomNum].fileName);
+        sRoomLoadPromise = OTRGlobals::Instance->context->GetResourceManager()->LoadResourceAsync(globalCtx->roomList[roomNum].fileName);
         roomCtx->status = 1;
-        roomCtx->roomToLoad = (Ship::Scene*)roomData.get();
+        roomCtx->roomToLoad = nullptr;
 
         roomCtx->unk_30 ^= 1;
 
@@ -39,8 +39,10 @@ extern u64 rspAspMainDataStart[];
 extern u64 rspAspMainDataEnd[];
 
 void AudioMgr_CreateNextAudioBuffer(s16* samples, u32 num_samples) {
+    static u32 sLastCmdMesg = 0;
     // OTRTODO: uintptr_t?
     u32 sp4C;
+    OSMesg loadMsg;
 
     gAudioContext.totalTaskCnt++;
 
@@ -51,7 +53,7 @@ void AudioMgr_CreateNextAudioBuffer(s16* samples, u32 num_samples) {
     if (gAudioContext.resetStatus != 0) {
         if (AudioHeap_ResetStep() == 0) {
             if (gAudioContext.resetStatus == 0) {
-                osSendMesg(gAudioContext.audioResetQueueP, gAudioContext.audioResetSpecIdToLoad, OS_MESG_NOBLOCK);
+                Audio_SendResetMesg(gAudioContext.audioResetSpecIdToLoad);
             }
         }
     }
@@ -59,16 +61,24 @@ void AudioMgr_CreateNextAudioBuffer(s16* samples, u32 num_samples) {
     int j = 0;
     if (gAudioContext.resetStatus == 0) {
         // msg = 0000RREE R = read pos, E = End Pos
-        while (osRecvMesg(gAudioContext.cmdProcQueueP, (OSMesg*)&sp4C, OS_MESG_NOBLOCK) != -1) {
+        while (Audio_RecvCmdMesg(&sp4C) != -1) {
             Audio_ProcessCmds(sp4C);
+            sLastCmdMesg = sp4C;
             j++;
         }
+        // The game thread owns the write position, so finish the batch a 0xF8 command cut short here instead of
+        // scheduling it like the N64 audio thread did
         if ((j == 0) && (gAudioContext.cmdQueueFinished)) {
-            Audio_ScheduleProcessCmds();
+            Audio_ProcessCmds(sLastCmdMesg);
         }
     }
     s32 writtenCmds;
     AudioSynth_Update(gAudioContext.curAbiCmdBuf, &writtenCmds, samples, num_samples);
+
+    // Finished async loads go to the game through its own ring, externalLoadQueue stays on this thread
+    while (osRecvMesg(&gAudioContext.externalLoadQueue, &loadMsg, OS_MESG_NOBLOCK) != -1) {
+        Audio_SendLoadMesg((u32)(uintptr_t)loadMsg);
+    }
     gAudioContext.audioRandom = (gAudioContext.audioRandom + gAudioContext.totalTaskCnt) * osGetCount();
 }
 
@@ -432,9 +442,7 @@ s32 Audio_ScheduleProcessCmds(void) {
         D_801304E8 = (u8)((gAudioContext.cmdWrPos - gAudioContext.cmdRdPos) + 0x100);
     }
 
-    ret =
-        osSendMesg(gAudioContext.cmdProcQueueP,
-                   (void*)(((gAudioContext.cmdRdPos & 0xFF) << 8) | (gAudioContext.cmdWrPos & 0xFF)), OS_MESG_NOBLOCK);
+    ret = Audio_SendCmdMesg(((gAudioContext.cmdRdPos & 0xFF) << 8) | (gAudioContext.cmdWrPos & 0xFF));
     if (ret != -1) {
         gAudioContext.cmdRdPos = gAudioContext.cmdWrPos;
         ret = 0;
@@ -517,7 +525,7 @@ void Audio_ProcessCmds(u32 msg) {
 u32 func_800E5E20(u32* out) {
     u32 sp1C;
 
-    if (osRecvMesg(&gAudioContext.externalLoadQueue, (OSMesg*)&sp1C, OS_MESG_NOBLOCK) == -1) {
+    if (Audio_RecvLoadMesg(&sp1C) == -1) {
         *out = 0;
         return 0;
     }
@@ -536,9 +544,9 @@ void func_800E5EA4(s32 arg0, u32* arg1, u32* arg2) {
 
 s32 func_800E5EDC(void) {
     s32 pad;
-    s32 sp18;
+    u32 sp18;
 
-    if (osRecvMesg(gAudioContext.audioResetQueueP, (OSMesg*)&sp18, OS_MESG_NOBLOCK) == -1) {
+    if (Audio_RecvResetMesg(&sp18) == -1) {
         return 0;
     } else if (gAudioContext.audioResetSpecIdToLoad != sp18) {
         return -1;
@@ -550,13 +558,13 @@ s32 func_800E5EDC(void) {
 void func_800E5F34(void) {
     // macro?
     // clang-format off
-    s32 chk = -1; s32 sp28; do {} while (osRecvMesg(gAudioContext.audioResetQueueP, (OSMesg*)&sp28, OS_MESG_NOBLOCK) != chk);
+    s32 chk = -1; u32 sp28; do {} while (Audio_RecvResetMesg(&sp28) != chk);
     // clang-format on
 }
 
 s32 func_800E5F88(s32 resetPreloadID) {
     s32 resetStatus;
-    OSMesg msg;
+    u32 msg;
     s32 pad;
 
     func_800E5F34();
@@ -569,7 +577,7 @@ s32 func_800E5F88(s32 resetPreloadID) {
             gAudioContext.audioResetSpecIdToLoad = resetPreloadID;
             return -3;
         } else {
-            osRecvMesg(gAudioContext.audioResetQueueP, &msg, OS_MESG_BLOCK);
+            Audio_RecvResetMesg(&msg);
         }
     }
 
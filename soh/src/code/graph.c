@@ -486,9 +486,16 @@ static void RunFrame()
         }
 
         runFrameContext.nextOvl = Graph_GetNextGameState(runFrameContext.gameState);
+        // The last frame of this game state may still be drawn, and its display lists point into the memory freed below.
+        Graph_WaitForRender();
         GameState_Destroy(runFrameContext.gameState);
         SystemArena_FreeDebug(runFrameContext.gameState, "../graph.c", 1227);
         Overlay_FreeGameState(runFrameContext.ovl);
+
+        // Nothing from the old game state can still point into the resource cache, so this is where it may shrink back to its budget
+        // and where mods added or removed since the last game state get picked up.
+        ResourceMgr_RefreshPatches();
+        ResourceMgr_EvictResources();
     }
     Graph_Destroy(&runFrameContext.gfxCtx);
     osSyncPrintf("グラフィックスレッド実行終了\n"); // "End of graphic thread execution"
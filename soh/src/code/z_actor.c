@@ -6,6 +6,7 @@
 #include "objects/gameplay_keep/gameplay_keep.h"
 #include "objects/gameplay_dangeon_keep/gameplay_dangeon_keep.h"
 #include "objects/object_bdoor/object_bdoor.h"
+#include "soh/Enhancements/debugger/actorProfiler.h"
 
 #ifdef _MSC_VER
 #include <string.h>
@@ -2275,6 +2276,7 @@ void Actor_UpdateAll(GlobalContext* globalCtx, ActorContext* actorCtx) {
     Actor* sp74;
     ActorEntry* actorEntry;
     s32 i;
+    u64 profStart;
 
     player = GET_PLAYER(globalCtx);
 
@@ -2373,8 +2375,13 @@ void Actor_UpdateAll(GlobalContext* globalCtx, ActorContext* actorCtx) {
                     if (actor->colorFilterTimer != 0) {
                         actor->colorFilterTimer--;
                     }
+                    profStart = ActorProfiler_Start();
                     actor->update(actor, globalCtx);
+                    ActorProfiler_EndActor(profStart, actor->id, i, ACTORPROF_UPDATE);
+                    Actor_UpdateGridCell(actorCtx, actor);
+                    profStart = ActorProfiler_Start();
                     func_8003F8EC(globalCtx, &globalCtx->colCtx.dyna, actor);
+                    ActorProfiler_EndActor(profStart, actor->id, i, ACTORPROF_DYNA_MOVE);
                 }
 
                 CollisionCheck_ResetDamage(&actor->colChkInfo);
@@ -2384,7 +2391,9 @@ void Actor_UpdateAll(GlobalContext* globalCtx, ActorContext* actorCtx) {
         }
 
         if (i == ACTORCAT_BG) {
+            profStart = ActorProfiler_Start();
             DynaPoly_Setup(globalCtx, &globalCtx->colCtx.dyna);
+            ActorProfiler_EndPhase(profStart, ACTORPROF_DYNAPOLY_SETUP);
         }
     }
 
@@ -2406,6 +2415,13 @@ void Actor_UpdateAll(GlobalContext* globalCtx, ActorContext* actorCtx) {
     func_8002C7BC(&actorCtx->targetCtx, player, actor, globalCtx);
     TitleCard_Update(globalCtx, &actorCtx->titleCtx);
     DynaPoly_UpdateBgActorTransforms(globalCtx, &globalCtx->colCtx.dyna);
+
+    // Catch actors that were moved by other actors' updates
+    for (i = 0; i < ARRAY_COUNT(actorCtx->actorLists); i++) {
+        for (actor = actorCtx->actorLists[i].head; actor != NULL; actor = actor->next) {
+            Actor_UpdateGridCell(actorCtx, actor);
+        }
+    }
 }
 
 void Actor_FaultPrint(Actor* actor, char* command) {
@@ -2433,6 +2449,7 @@ void Actor_FaultPrint(Actor* actor, char* command) {
 void Actor_Draw(GlobalContext* globalCtx, Actor* actor) {
     FaultClient faultClient;
     Lights* lights;
+    u64 profStart;
 
     Fault_AddClient(&faultClient, Actor_FaultPrint, actor, "Actor_draw");
 
@@ -2477,7 +2494,9 @@ void Actor_Draw(GlobalContext* globalCtx, Actor* actor) {
         }
     }
 
+    profStart = ActorProfiler_Start();
     actor->draw(actor, globalCtx);
+    ActorProfiler_EndActor(profStart, actor->id, actor->category, ACTORPROF_DRAW);
 
     if (actor->colorFilterTimer != 0) {
         if (actor->colorFilterParams & 0x2000) {
@@ -2805,6 +2824,57 @@ void func_80031C3C(ActorContext* actorCtx, GlobalContext* globalCtx) {
     ActorOverlayTable_Cleanup();
 }
 
+/**
+ * Gets the index of the cell in `actorCtx->gridCells` covering `pos`. The grid wraps, and positions too far out to
+ * convert (or NaN) all share cell 0.
+ */
+static s16 Actor_GetGridCell(Vec3f* pos) {
+    f32 cellX = pos->x * (1.0f / ACTOR_GRID_CELL_SIZE);
+    f32 cellZ = pos->z * (1.0f / ACTOR_GRID_CELL_SIZE);
+
+    if (!(fabsf(cellX) < 0x10000) || !(fabsf(cellZ) < 0x10000)) {
+        return 0;
+    }
+    // offset to truncate towards negative infinity
+    return ((s32)(cellX + 0x10000) & (ACTOR_GRID_DIM - 1)) |
+           (((s32)(cellZ + 0x10000) & (ACTOR_GRID_DIM - 1)) * ACTOR_GRID_DIM);
+}
+
+static void Actor_UnlinkGridCell(ActorContext* actorCtx, Actor* actor) {
+    if (actor->prevInCell != NULL) {
+        actor->prevInCell->nextInCell = actor->nextInCell;
+    } else {
+        actorCtx->gridCells[actor->gridCell] = actor->nextInCell;
+    }
+    if (actor->nextInCell != NULL) {
+        actor->nextInCell->prevInCell = actor->prevInCell;
+    }
+    actor->prevInCell = NULL;
+    actor->nextInCell = NULL;
+}
+
+static void Actor_LinkGridCell(ActorContext* actorCtx, Actor* actor, s16 cell) {
+    actor->gridCell = cell;
+    actor->prevInCell = NULL;
+    actor->nextInCell = actorCtx->gridCells[cell];
+    if (actor->nextInCell != NULL) {
+        actor->nextInCell->prevInCell = actor;
+    }
+    actorCtx->gridCells[cell] = actor;
+}
+
+/**
+ * Moves an actor in a category list to the grid cell of its current world position.
+ */
+void Actor_UpdateGridCell(ActorContext* actorCtx, Actor* actor) {
+    s16 cell = Actor_GetGridCell(&actor->world.pos);
+
+    if (cell != actor->gridCell) {
+        Actor_UnlinkGridCell(actorCtx, actor);
+        Actor_LinkGridCell(actorCtx, actor, cell);
+    }
+}
+
 /**
  * Adds a given actor instance at the front of the actor list of the specified category.
  * Also sets the actor instance as being of that category.
@@ -2824,6 +2894,18 @@ void Actor_AddToCategory(ActorContext* actorCtx, Actor* actorToAdd, u8 actorCate
 
     actorCtx->actorLists[actorCategory].head = actorToAdd;
     actorToAdd->next = prevHead;
+
+    // Also add it to the head of its ID list, so the actors of an ID in a given category are in the same order there as
+    // in the category list
+    prevHead = actorCtx->idLists[actorToAdd->id];
+    if (prevHead != NULL) {
+        prevHead->prevById = actorToAdd;
+    }
+    actorCtx->idLists[actorToAdd->id] = actorToAdd;
+    actorToAdd->prevById = NULL;
+    actorToAdd->nextById = prevHead;
+
+    Actor_LinkGridCell(actorCtx, actorToAdd, Actor_GetGridCell(&actorToAdd->world.pos));
 }
 
 /**
@@ -2851,6 +2933,19 @@ Actor* Actor_RemoveFromCategory(GlobalContext* globalCtx, ActorContext* actorCtx
     actorToRemove->next = NULL;
     actorToRemove->prev = NULL;
 
+    if (actorToRemove->prevById != NULL) {
+        actorToRemove->prevById->nextById = actorToRemove->nextById;
+    } else {
+        actorCtx->idLists[actorToRemove->id] = actorToRemove->nextById;
+    }
+    if (actorToRemove->nextById != NULL) {
+        actorToRemove->nextById->prevById = actorToRemove->prevById;
+    }
+    actorToRemove->nextById = NULL;
+    actorToRemove->prevById = NULL;
+
+    Actor_UnlinkGridCell(actorCtx, actorToRemove);
+
     if ((actorToRemove->room == globalCtx->roomCtx.curRoom.num) && (actorToRemove->category == ACTORCAT_ENEMY) &&
         (actorCtx->actorLists[ACTORCAT_ENEMY].length == 0)) {
         Flags_SetTempClear(globalCtx, globalCtx->roomCtx.curRoom.num);
@@ -3047,6 +3142,7 @@ Actor* Actor_Spawn(ActorContext* actorCtx, GlobalContext* globalCtx, s16 actorId
 
     temp = gSegments[6];
     Actor_Init(actor, globalCtx);
+    Actor_UpdateGridCell(actorCtx, actor);
     gSegments[6] = temp;
 
     return actor;
@@ -3263,15 +3359,19 @@ Actor* func_80032AF0(GlobalContext* globalCtx, ActorContext* actorCtx, Actor** a
 
 /**
  * Finds the first actor instance of a specified ID and category if there is one.
+ * Only the actors with that ID are walked, in the order of the category list.
  */
 Actor* Actor_Find(ActorContext* actorCtx, s32 actorId, s32 actorCategory) {
-    Actor* actor = actorCtx->actorLists[actorCategory].head;
+    Actor* actor;
 
-    while (actor != NULL) {
-        if (actorId == actor->id) {
+    if (actorId < 0 || actorId >= ACTOR_ID_MAX) {
+        return NULL;
+    }
+
+    for (actor = actorCtx->idLists[actorId]; actor != NULL; actor = actor->nextById) {
+        if (actor->category == actorCategory) {
             return actor;
         }
-        actor = actor->next;
     }
 
     return NULL;
@@ -4226,7 +4326,20 @@ u8 func_800353E8(GlobalContext* globalCtx) {
  * specified category rather than a specific ID.
  */
 Actor* Actor_FindNearby(GlobalContext* globalCtx, Actor* refActor, s16 actorId, u8 actorCategory, f32 range) {
-    Actor* actor = globalCtx->actorCtx.actorLists[actorCategory].head;
+    Actor* actor;
+
+    if (actorId >= 0 && actorId < ACTOR_ID_MAX) {
+        // The ID list holds the category's actors of this ID in the same order as the category list
+        for (actor = globalCtx->actorCtx.idLists[actorId]; actor != NULL; actor = actor->nextById) {
+            if (actor->category == actorCategory && actor != refActor &&
+                Actor_WorldDistXYZToActor(refActor, actor) <= range) {
+                return actor;
+            }
+        }
+        return NULL;
+    }
+
+    actor = globalCtx->actorCtx.actorLists[actorCategory].head;
 
     while (actor != NULL) {
         if (actor == refActor || ((actorId != -1) && (actorId != actor->id))) {
@@ -4243,6 +4356,72 @@ Actor* Actor_FindNearby(GlobalContext* globalCtx, Actor* refActor, s16 actorId,
     return NULL;
 }
 
+/**
+ * Finds up to `maxActors` actors with `actorId` (-1 for any) in `actorCategory` (-1 for any) whose world position is
+ * within `radius` of `pos`, looking only in the grid cells the radius covers. Results are in no particular order.
+ * Actors are filed under the cell of their position as of spawning, their own update or the end of Actor_UpdateAll,
+ * so an actor moved by another actor during Actor_UpdateAll can be missed until the end of that frame.
+ * Returns the number of actors written to `actors`
+ */
+s32 Actor_FindInRadius(GlobalContext* globalCtx, Vec3f* pos, f32 radius, s16 actorId, s32 actorCategory,
+                       Actor** actors, s32 maxActors) {
+    ActorContext* actorCtx = &globalCtx->actorCtx;
+    Actor* actor;
+    f32 minX = (pos->x - radius) * (1.0f / ACTOR_GRID_CELL_SIZE);
+    f32 maxX = (pos->x + radius) * (1.0f / ACTOR_GRID_CELL_SIZE);
+    f32 minZ = (pos->z - radius) * (1.0f / ACTOR_GRID_CELL_SIZE);
+    f32 maxZ = (pos->z + radius) * (1.0f / ACTOR_GRID_CELL_SIZE);
+    s32 cellMinX = 0;
+    s32 cellMaxX = ACTOR_GRID_DIM - 1;
+    s32 cellMinZ = 0;
+    s32 cellMaxZ = ACTOR_GRID_DIM - 1;
+    s32 cellX;
+    s32 cellZ;
+    s32 count = 0;
+
+    if (!(radius >= 0.0f)) {
+        return 0;
+    }
+
+    // Cover the whole grid if the radius reaches positions Actor_GetGridCell files under cell 0
+    if (fabsf(minX) < 0x10000 && fabsf(maxX) < 0x10000 && fabsf(minZ) < 0x10000 && fabsf(maxZ) < 0x10000) {
+        cellMinX = (s32)(minX + 0x10000);
+        cellMaxX = (s32)(maxX + 0x10000);
+        cellMinZ = (s32)(minZ + 0x10000);
+        cellMaxZ = (s32)(maxZ + 0x10000);
+
+        // The grid wraps, so a span of ACTOR_GRID_DIM cells or more would visit some cells twice
+        if (cellMaxX - cellMinX >= ACTOR_GRID_DIM) {
+            cellMinX = 0;
+            cellMaxX = ACTOR_GRID_DIM - 1;
+        }
+        if (cellMaxZ - cellMinZ >= ACTOR_GRID_DIM) {
+            cellMinZ = 0;
+            cellMaxZ = ACTOR_GRID_DIM - 1;
+        }
+    }
+
+    for (cellZ = cellMinZ; cellZ <= cellMaxZ; cellZ++) {
+        for (cellX = cellMinX; cellX <= cellMaxX; cellX++) {
+            actor = actorCtx->gridCells[(cellX & (ACTOR_GRID_DIM - 1)) |
+                                        ((cellZ & (ACTOR_GRID_DIM - 1)) * ACTOR_GRID_DIM)];
+
+            for (; actor != NULL; actor = actor->nextInCell) {
+                if (((actorId == -1) || (actor->id == actorId)) &&
+                    ((actorCategory == -1) || (actor->category == actorCategory)) &&
+                    (Math_Vec3f_DistXYZ(pos, &actor->world.pos) <= radius)) {
+                    if (count >= maxActors) {
+                        return count;
+                    }
+                    actors[count++] = actor;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
 s32 func_800354B4(GlobalContext* globalCtx, Actor* actor, f32 range, s16 arg3, s16 arg4, s16 arg5) {
     Player* player = GET_PLAYER(globalCtx);
     s16 var1;
@@ -1,5 +1,7 @@
 #include "global.h"
 #include "vt.h"
+#include <stdlib.h>
+#include <string.h>
 
 #include <soh/OTRGlobals.h>
 
@@ -511,6 +513,676 @@ void StaticLookup_AddPoly(StaticLookup* lookup, CollisionContext* colCtx, Collis
     }
 }
 
+// Flattened static lookup
+// Every SSList of the scene's StaticLookups is baked into a run of BgStaticPolyBlocks when the scene collision is
+// allocated. A block holds four polys in list order along with the float data the static queries read, so that four
+// polys can be rejected at a time without following SSNodes or reading CollisionPolys and vertices. Polys left over are
+// tested exactly as the SSList walks do, and those walks remain the reference the flattened queries are checked against.
+
+// The lane masks are built with SSE2 or NEON where the target always has them, and with plain loops elsewhere.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BGFLAT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define BGFLAT_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define BGFLAT_LANES 4
+#define BGFLAT_ALL_LANES ((1 << BGFLAT_LANES) - 1)
+
+typedef struct {
+    /* 0x000 */ f32 minY[BGFLAT_LANES];     // lowest vertex y
+    /* 0x010 */ f32 lineMinY[BGFLAT_LANES]; // CollisionPoly_GetMinY, as BgCheck_CheckLineAgainstSSList uses it
+    /* 0x020 */ f32 minX[BGFLAT_LANES];
+    /* 0x030 */ f32 maxX[BGFLAT_LANES];
+    /* 0x040 */ f32 minZ[BGFLAT_LANES];
+    /* 0x050 */ f32 maxZ[BGFLAT_LANES];
+    /* 0x060 */ f32 nx[BGFLAT_LANES]; // unit normal
+    /* 0x070 */ f32 ny[BGFLAT_LANES];
+    /* 0x080 */ f32 nz[BGFLAT_LANES];
+    /* 0x090 */ f32 snx[BGFLAT_LANES]; // normal as stored in the CollisionPoly
+    /* 0x0A0 */ f32 sny[BGFLAT_LANES];
+    /* 0x0B0 */ f32 snz[BGFLAT_LANES];
+    /* 0x0C0 */ f32 dist[BGFLAT_LANES];
+    /* 0x0D0 */ f32 normMag[BGFLAT_LANES]; // length of the unit normal, NaN if Math3D_DistPlaneToPos would refuse it
+    /* 0x0E0 */ f32 facingX[BGFLAT_LANES]; // fabsf(nx) / xz length of the normal, NaN if that length is near zero
+    /* 0x0F0 */ f32 facingZ[BGFLAT_LANES];
+    /* 0x100 */ Vec3f vtx[BGFLAT_LANES][3];
+    /* 0x190 */ u16 flags_vIA[BGFLAT_LANES];
+    /* 0x198 */ s16 polyId[BGFLAT_LANES];
+} BgStaticPolyBlock; // size = 0x1A0
+
+typedef struct {
+    u32 blockStart;
+    u16 count; // polys in the list, the last block may be partially used
+} BgStaticFlatList;
+
+typedef struct {
+    BgStaticFlatList floor;
+    BgStaticFlatList wall;
+    BgStaticFlatList ceiling;
+} BgStaticFlatLookup;
+
+static struct {
+    CollisionContext* colCtx; // context the tables were baked from
+    CollisionHeader* colHeader;
+    BgStaticFlatLookup* lookupTbl; // parallel to colCtx->lookupTbl
+    BgStaticPolyBlock* blocks;
+    u32 lookupMax;
+    u32 blockMax;
+    u32 blockCount;
+    s32 enabled;
+} sBgStaticFlat;
+
+s32 BgCheck_ComputeWallDisplacement(CollisionContext* colCtx, CollisionPoly* poly, f32* posX, f32* posZ, f32 nx, f32 ny,
+                                    f32 nz, f32 invXZlength, f32 planeDist, f32 radius, CollisionPoly** wallPolyPtr);
+
+#if defined(BGFLAT_SSE2)
+typedef __m128 BgF32x4;
+
+#define BgF32x4_Load(p) _mm_loadu_ps(p)
+#define BgF32x4_Set(f) _mm_set1_ps(f)
+#define BgF32x4_Add(a, b) _mm_add_ps(a, b)
+#define BgF32x4_Sub(a, b) _mm_sub_ps(a, b)
+#define BgF32x4_Mul(a, b) _mm_mul_ps(a, b)
+#define BgF32x4_Div(a, b) _mm_div_ps(a, b)
+#define BgF32x4_Abs(a) _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)))
+#define BgF32x4_LtMask(a, b) _mm_movemask_ps(_mm_cmplt_ps(a, b))
+#define BgF32x4_LeMask(a, b) _mm_movemask_ps(_mm_cmple_ps(a, b))
+#elif defined(BGFLAT_NEON)
+typedef float32x4_t BgF32x4;
+
+static inline s32 BgU32x4_Mask(uint32x4_t m) {
+    static const u32 sLaneBits[4] = { 1, 2, 4, 8 };
+
+    return vaddvq_u32(vandq_u32(m, vld1q_u32(sLaneBits)));
+}
+
+#define BgF32x4_Load(p) vld1q_f32(p)
+#define BgF32x4_Set(f) vdupq_n_f32(f)
+#define BgF32x4_Add(a, b) vaddq_f32(a, b)
+#define BgF32x4_Sub(a, b) vsubq_f32(a, b)
+#define BgF32x4_Mul(a, b) vmulq_f32(a, b)
+#define BgF32x4_Div(a, b) vdivq_f32(a, b)
+#define BgF32x4_Abs(a) vabsq_f32(a)
+#define BgF32x4_LtMask(a, b) BgU32x4_Mask(vcltq_f32(a, b))
+#define BgF32x4_LeMask(a, b) BgU32x4_Mask(vcleq_f32(a, b))
+#else
+typedef struct {
+    f32 v[BGFLAT_LANES];
+} BgF32x4;
+
+static inline BgF32x4 BgF32x4_Load(const f32* p) {
+    BgF32x4 r;
+    s32 i;
+
+    for (i = 0; i < BGFLAT_LANES; i++) {
+        r.v[i] = p[i];
+    }
+    return r;
+}
+
+static inline BgF32x4 BgF32x4_Set(f32 f) {
+    BgF32x4 r;
+    s32 i;
+
+    for (i = 0; i < BGFLAT_LANES; i++) {
+        r.v[i] = f;
+    }
+    return r;
+}
+
+#define BGFLAT_SCALAR_OP(name, expr)                   \
+    static inline BgF32x4 name(BgF32x4 a, BgF32x4 b) { \
+        BgF32x4 r;                                     \
+        s32 i;                                         \
+        for (i = 0; i < BGFLAT_LANES; i++) {           \
+            r.v[i] = (expr);                           \
+        }                                              \
+        return r;                                      \
+    }
+
+BGFLAT_SCALAR_OP(BgF32x4_Add, a.v[i] + b.v[i])
+BGFLAT_SCALAR_OP(BgF32x4_Sub, a.v[i] - b.v[i])
+BGFLAT_SCALAR_OP(BgF32x4_Mul, a.v[i] * b.v[i])
+BGFLAT_SCALAR_OP(BgF32x4_Div, a.v[i] / b.v[i])
+
+static inline BgF32x4 BgF32x4_Abs(BgF32x4 a) {
+    s32 i;
+
+    for (i = 0; i < BGFLAT_LANES; i++) {
+        a.v[i] = fabsf(a.v[i]);
+    }
+    return a;
+}
+
+static inline s32 BgF32x4_LtMask(BgF32x4 a, BgF32x4 b) {
+    s32 mask = 0;
+    s32 i;
+
+    for (i = 0; i < BGFLAT_LANES; i++) {
+        mask |= (a.v[i] < b.v[i]) << i;
+    }
+    return mask;
+}
+
+static inline s32 BgF32x4_LeMask(BgF32x4 a, BgF32x4 b) {
+    s32 mask = 0;
+    s32 i;
+
+    for (i = 0; i < BGFLAT_LANES; i++) {
+        mask |= (a.v[i] <= b.v[i]) << i;
+    }
+    return mask;
+}
+#endif
+
+/**
+ * Get the flattened lists of `lookup`, or NULL if the SSLists have to be walked
+ */
+static BgStaticFlatLookup* BgCheck_GetFlatLookup(CollisionContext* colCtx, StaticLookup* lookup) {
+    if (!sBgStaticFlat.enabled || sBgStaticFlat.colCtx != colCtx || sBgStaticFlat.colHeader != colCtx->colHeader) {
+        return NULL;
+    }
+    return &sBgStaticFlat.lookupTbl[lookup - colCtx->lookupTbl];
+}
+
+/**
+ * Lanes of `block` in use by `list`
+ */
+static s32 BgCheck_FlatBlockLanes(BgStaticFlatList* list, u32 blockIndex) {
+    s32 remaining = list->count - blockIndex * BGFLAT_LANES;
+
+    return remaining >= BGFLAT_LANES ? BGFLAT_ALL_LANES : (1 << remaining) - 1;
+}
+
+/**
+ * Lanes of `block` whose vIA flags exclude them from a check with `xpFlags`
+ */
+static s32 BgCheck_FlatExcludedLanes(BgStaticPolyBlock* block, u16 xpFlags) {
+    s32 mask = 0;
+    s32 i;
+
+    for (i = 0; i < BGFLAT_LANES; i++) {
+        if (COLPOLY_VIA_FLAG_TEST(block->flags_vIA[i], xpFlags)) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+/**
+ * Lanes of `block` whose triangle bounds come within `chkDist` of (`x`,`z`) and whose normal is not horizontal,
+ * the first rejections of Math3D_TriChkPointParaYIntersectInsideTri and Math3D_TriChkPointParaYIntersectDist
+ */
+static s32 BgCheck_FlatYCandidates(BgStaticPolyBlock* block, f32 x, f32 z, f32 chkDist) {
+    BgF32x4 vx = BgF32x4_Set(x);
+    BgF32x4 vz = BgF32x4_Set(z);
+    BgF32x4 vChkDist = BgF32x4_Set(chkDist);
+
+    return ~BgF32x4_LtMask(BgF32x4_Abs(BgF32x4_Load(block->ny)), BgF32x4_Set(0.008f)) &
+           BgF32x4_LeMask(BgF32x4_Sub(BgF32x4_Load(block->minZ), vChkDist), vz) &
+           BgF32x4_LeMask(vz, BgF32x4_Add(BgF32x4_Load(block->maxZ), vChkDist)) &
+           BgF32x4_LeMask(BgF32x4_Sub(BgF32x4_Load(block->minX), vChkDist), vx) &
+           BgF32x4_LeMask(vx, BgF32x4_Add(BgF32x4_Load(block->maxX), vChkDist)) & BGFLAT_ALL_LANES;
+}
+
+/**
+ * Flattened BgCheck_RaycastFloorStaticList
+ */
+static f32 BgCheck_RaycastFloorStaticFlat(CollisionContext* colCtx, u16 xpFlags, BgStaticFlatList* list,
+                                          CollisionPoly** outPoly, Vec3f* pos, f32 yIntersectMin, f32 chkDist,
+                                          s32 flags) {
+    BgStaticPolyBlock* block;
+    f32 result = yIntersectMin;
+    f32 yIntersect;
+    s32 live;
+    s32 stop;
+    s32 test;
+    s32 lane;
+    u32 i;
+
+    for (i = 0; i * BGFLAT_LANES < list->count; i++) {
+        block = &sBgStaticFlat.blocks[list->blockStart + i];
+
+        live = BgCheck_FlatBlockLanes(list, i) & ~BgCheck_FlatExcludedLanes(block, xpFlags);
+        if (flags & 1) {
+            live &= ~BgF32x4_LtMask(BgF32x4_Load(block->ny), BgF32x4_Set(0.0f));
+        }
+
+        // polys are sorted by their lowest vertex, so the walk ends at the first one entirely above pos
+        stop = live & BgF32x4_LtMask(BgF32x4_Set(pos->y), BgF32x4_Load(block->minY));
+        if (stop != 0) {
+            live &= (stop & -stop) - 1;
+        }
+
+        test = live & BgCheck_FlatYCandidates(block, pos->x, pos->z, chkDist);
+        for (lane = 0; test != 0; lane++, test >>= 1) {
+            if (!(test & 1)) {
+                continue;
+            }
+            if (Math3D_TriChkPointParaYIntersectInsideTri(&block->vtx[lane][0], &block->vtx[lane][1],
+                                                          &block->vtx[lane][2], block->nx[lane], block->ny[lane],
+                                                          block->nz[lane], block->dist[lane], pos->z, pos->x,
+                                                          &yIntersect, chkDist) == true) {
+                // if poly is closer to pos without going over
+                if (yIntersect < pos->y && result < yIntersect) {
+                    result = yIntersect;
+                    *outPoly = &colCtx->colHeader->polyList[block->polyId[lane]];
+                }
+            }
+        }
+
+        if (stop != 0) {
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ * Lanes of `block` the sphere at `resultPos` may push against when tested along z (`zFacing`) or x
+ * Mirrors the plane distance, facing and bounds rejections of BgCheck_SphVsStaticWall
+ */
+static s32 BgCheck_FlatWallCandidates(BgStaticPolyBlock* block, Vec3f* resultPos, f32 radius, s32 zFacing) {
+    BgF32x4 vRadius = BgF32x4_Set(radius);
+    BgF32x4 planeDist;
+    BgF32x4 center;
+    s32 mask;
+
+    planeDist = BgF32x4_Add(BgF32x4_Mul(BgF32x4_Load(block->nx), BgF32x4_Set(resultPos->x)),
+                            BgF32x4_Mul(BgF32x4_Load(block->ny), BgF32x4_Set(resultPos->y)));
+    planeDist = BgF32x4_Add(planeDist, BgF32x4_Mul(BgF32x4_Load(block->nz), BgF32x4_Set(resultPos->z)));
+    planeDist = BgF32x4_Div(BgF32x4_Add(planeDist, BgF32x4_Load(block->dist)), BgF32x4_Load(block->normMag));
+    mask = ~BgF32x4_LtMask(vRadius, BgF32x4_Abs(planeDist));
+
+    if (zFacing) {
+        center = BgF32x4_Set(resultPos->z);
+        mask &= ~BgF32x4_LtMask(BgF32x4_Load(block->facingZ), BgF32x4_Set(0.4f)) &
+                BgF32x4_LeMask(BgF32x4_Sub(BgF32x4_Load(block->minZ), vRadius), center) &
+                BgF32x4_LeMask(center, BgF32x4_Add(BgF32x4_Load(block->maxZ), vRadius));
+    } else {
+        center = BgF32x4_Set(resultPos->x);
+        mask &= ~BgF32x4_LtMask(BgF32x4_Load(block->facingX), BgF32x4_Set(0.4f)) &
+                BgF32x4_LeMask(BgF32x4_Sub(BgF32x4_Load(block->minX), vRadius), center) &
+                BgF32x4_LeMask(center, BgF32x4_Add(BgF32x4_Load(block->maxX), vRadius));
+    }
+    return mask & BGFLAT_ALL_LANES;
+}
+
+/**
+ * One of the two passes of BgCheck_SphVsStaticWall over a flattened wall list, pushing `resultPos` out along z if
+ * `zFacing`, else along x
+ */
+static s32 BgCheck_SphVsStaticWallFlatPass(CollisionContext* colCtx, BgStaticFlatList* list, u16 xpFlags, Vec3f* pos,
+                                           Vec3f* resultPos, f32 radius, CollisionPoly** outPoly, s32 zFacing) {
+    BgStaticPolyBlock* block;
+    s32 result = false;
+    s32 lanes;
+    s32 stop;
+    s32 test;
+    s32 lane;
+    u32 i;
+    f32 nx;
+    f32 ny;
+    f32 nz;
+    f32 normalXZ;
+    f32 invNormalXZ;
+    f32 planeDist;
+    f32 facing;
+    f32 intersect;
+
+    for (i = 0; i * BGFLAT_LANES < list->count; i++) {
+        block = &sBgStaticFlat.blocks[list->blockStart + i];
+        lanes = BgCheck_FlatBlockLanes(list, i);
+
+        stop = lanes & BgF32x4_LtMask(BgF32x4_Set(pos->y), BgF32x4_Load(block->minY));
+        if (stop != 0) {
+            lanes &= (stop & -stop) - 1;
+        }
+        lanes &= ~BgCheck_FlatExcludedLanes(block, xpFlags);
+        test = lanes & BgCheck_FlatWallCandidates(block, resultPos, radius, zFacing);
+
+        for (lane = 0; lane < BGFLAT_LANES; lane++) {
+            if (!(test & (1 << lane))) {
+                continue;
+            }
+
+            nx = block->nx[lane];
+            ny = block->ny[lane];
+            nz = block->nz[lane];
+            normalXZ = sqrtf(SQ(nx) + SQ(nz));
+            planeDist = Math3D_DistPlaneToPos(nx, ny, nz, block->dist[lane], resultPos);
+            if (radius < fabsf(planeDist)) {
+                continue;
+            }
+
+            ASSERT(!IS_ZERO(normalXZ), "!IS_ZERO(ac_size)", "../z_bgcheck.c", zFacing ? 2854 : 2964);
+
+            invNormalXZ = 1.0f / normalXZ;
+            facing = fabsf(zFacing ? nz : nx) * invNormalXZ;
+            if (facing < 0.4f) {
+                continue;
+            }
+
+            if (zFacing) {
+                if (!Math3D_TriChkPointParaZIntersect(&block->vtx[lane][0], &block->vtx[lane][1], &block->vtx[lane][2],
+                                                      nx, ny, nz, block->dist[lane], resultPos->x, pos->y,
+                                                      &intersect) ||
+                    fabsf(intersect - resultPos->z) > radius / facing || (intersect - resultPos->z) * nz > 4.0f) {
+                    continue;
+                }
+            } else {
+                if (!Math3D_TriChkPointParaXIntersect(&block->vtx[lane][0], &block->vtx[lane][1], &block->vtx[lane][2],
+                                                      nx, ny, nz, block->dist[lane], pos->y, resultPos->z,
+                                                      &intersect) ||
+                    fabsf(intersect - resultPos->x) > radius / facing || (intersect - resultPos->x) * nx > 4.0f) {
+                    continue;
+                }
+            }
+
+            BgCheck_ComputeWallDisplacement(colCtx, &colCtx->colHeader->polyList[block->polyId[lane]], &resultPos->x,
+                                            &resultPos->z, nx, ny, nz, invNormalXZ, planeDist, radius, outPoly);
+            result = true;
+
+            // the sphere moved, so the remaining lanes are tested against its new position
+            test = lanes & ~((2 << lane) - 1) & BgCheck_FlatWallCandidates(block, resultPos, radius, zFacing);
+        }
+
+        if (stop != 0) {
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ * Flattened BgCheck_SphVsStaticWall
+ */
+static s32 BgCheck_SphVsStaticWallFlat(BgStaticFlatLookup* flat, CollisionContext* colCtx, u16 xpFlags, f32* outX,
+                                       f32* outZ, Vec3f* pos, f32 radius, CollisionPoly** outPoly) {
+    Vec3f resultPos;
+    s32 result;
+
+    if (flat->wall.count == 0) {
+        return false;
+    }
+    resultPos = *pos;
+
+    result = BgCheck_SphVsStaticWallFlatPass(colCtx, &flat->wall, xpFlags, pos, &resultPos, radius, outPoly, true);
+    if (BgCheck_SphVsStaticWallFlatPass(colCtx, &flat->wall, xpFlags, pos, &resultPos, radius, outPoly, false)) {
+        result = true;
+    }
+
+    *outX = resultPos.x;
+    *outZ = resultPos.z;
+    return result;
+}
+
+/**
+ * Flattened BgCheck_CheckStaticCeiling
+ */
+static s32 BgCheck_CheckStaticCeilingFlat(BgStaticFlatLookup* flat, u16 xpFlags, CollisionContext* colCtx, f32* outY,
+                                          Vec3f* pos, f32 checkHeight, CollisionPoly** outPoly) {
+    BgStaticFlatList* list = &flat->ceiling;
+    BgStaticPolyBlock* block;
+    s32 result = false;
+    f32 ceilingY;
+    f32 intersectDist;
+    s32 test;
+    s32 lane;
+    u32 i;
+
+    if (list->count == 0) {
+        return false;
+    }
+
+    *outY = pos->y;
+
+    for (i = 0; i * BGFLAT_LANES < list->count; i++) {
+        block = &sBgStaticFlat.blocks[list->blockStart + i];
+        test = BgCheck_FlatBlockLanes(list, i) & ~BgCheck_FlatExcludedLanes(block, xpFlags) &
+               BgCheck_FlatYCandidates(block, pos->x, pos->z, 1.0f);
+
+        for (lane = 0; test != 0; lane++, test >>= 1) {
+            if (!(test & 1)) {
+                continue;
+            }
+            if (Math3D_TriChkPointParaYIntersectDist(&block->vtx[lane][0], &block->vtx[lane][1], &block->vtx[lane][2],
+                                                     block->nx[lane], block->ny[lane], block->nz[lane],
+                                                     block->dist[lane], pos->z, pos->x, &ceilingY, 1.0f)) {
+                intersectDist = ceilingY - *outY;
+
+                if (intersectDist > 0.0f && intersectDist < checkHeight && intersectDist * block->ny[lane] <= 0) {
+                    *outY = ceilingY - checkHeight;
+                    *outPoly = &colCtx->colHeader->polyList[block->polyId[lane]];
+                    result = true;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Lanes of `block` whose plane the line `posA` to `posB` may cross, the first rejection of CollisionPoly_LineVsPoly
+ */
+static s32 BgCheck_FlatLineCandidates(BgStaticPolyBlock* block, Vec3f* posA, Vec3f* posB) {
+    BgF32x4 snx = BgF32x4_Load(block->snx);
+    BgF32x4 sny = BgF32x4_Load(block->sny);
+    BgF32x4 snz = BgF32x4_Load(block->snz);
+    BgF32x4 dist = BgF32x4_Load(block->dist);
+    BgF32x4 frac = BgF32x4_Set(COLPOLY_NORMAL_FRAC);
+    BgF32x4 zero = BgF32x4_Set(0.0f);
+    BgF32x4 planeDistA;
+    BgF32x4 planeDistB;
+
+    planeDistA = BgF32x4_Add(BgF32x4_Mul(snx, BgF32x4_Set(posA->x)), BgF32x4_Mul(sny, BgF32x4_Set(posA->y)));
+    planeDistA = BgF32x4_Add(planeDistA, BgF32x4_Mul(snz, BgF32x4_Set(posA->z)));
+    planeDistA = BgF32x4_Add(BgF32x4_Mul(planeDistA, frac), dist);
+    planeDistB = BgF32x4_Add(BgF32x4_Mul(snx, BgF32x4_Set(posB->x)), BgF32x4_Mul(sny, BgF32x4_Set(posB->y)));
+    planeDistB = BgF32x4_Add(planeDistB, BgF32x4_Mul(snz, BgF32x4_Set(posB->z)));
+    planeDistB = BgF32x4_Add(BgF32x4_Mul(planeDistB, frac), dist);
+
+    return ~((BgF32x4_LeMask(zero, planeDistA) & BgF32x4_LeMask(zero, planeDistB)) |
+             (BgF32x4_LtMask(planeDistA, zero) & BgF32x4_LtMask(planeDistB, zero))) &
+           BGFLAT_ALL_LANES;
+}
+
+/**
+ * Flattened BgCheck_CheckLineAgainstSSList
+ */
+static s32 BgCheck_CheckLineAgainstFlatList(BgStaticFlatList* list, CollisionContext* colCtx, u16 xpFlags1,
+                                            u16 xpFlags2, Vec3f* posA, Vec3f* posB, Vec3f* outPos,
+                                            CollisionPoly** outPoly, f32* outDistSq, f32 chkDist, s32 bccFlags) {
+    BgStaticPolyBlock* block;
+    CollisionPoly* curPoly;
+    Vec3f polyIntersect;
+    u8* checkedPoly;
+    s32 result = false;
+    s32 lanes;
+    s32 test;
+    s32 lane;
+    s16 polyId;
+    u32 i;
+    f32 distSq;
+
+    for (i = 0; i * BGFLAT_LANES < list->count; i++) {
+        block = &sBgStaticFlat.blocks[list->blockStart + i];
+        lanes = BgCheck_FlatBlockLanes(list, i);
+        test = BgCheck_FlatLineCandidates(block, posA, posB);
+
+        for (lane = 0; lane < BGFLAT_LANES && (lanes & (1 << lane)); lane++) {
+            polyId = block->polyId[lane];
+            checkedPoly = &colCtx->polyNodes.polyCheckTbl[polyId];
+
+            if (*checkedPoly == true || COLPOLY_VIA_FLAG_TEST(block->flags_vIA[lane], xpFlags1) ||
+                !(xpFlags2 == 0 || COLPOLY_VIA_FLAG_TEST(block->flags_vIA[lane], xpFlags2))) {
+                continue;
+            }
+            *checkedPoly = true;
+            if (posA->y < block->lineMinY[lane] && posB->y < block->lineMinY[lane]) {
+                return result;
+            }
+            if (!(test & (1 << lane))) {
+                continue;
+            }
+
+            curPoly = &colCtx->colHeader->polyList[polyId];
+            if (CollisionPoly_LineVsPoly(curPoly, colCtx->colHeader->vtxList, posA, posB, &polyIntersect,
+                                         (bccFlags & BGCHECK_CHECK_ONE_FACE) != 0, chkDist)) {
+                distSq = Math3D_Vec3fDistSq(posA, &polyIntersect);
+                if (distSq < *outDistSq) {
+                    *outDistSq = distSq;
+                    *outPos = polyIntersect;
+                    *posB = polyIntersect;
+                    *outPoly = curPoly;
+                    result = true;
+
+                    // posB moved onto this poly, so the remaining lanes are tested against the shorter line
+                    test = BgCheck_FlatLineCandidates(block, posA, posB);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Append the polys of `ssList` to the flattened blocks as `list`, or only count the blocks needed if there is no
+ * room for them yet
+ */
+static void BgCheck_FlattenSSList(CollisionContext* colCtx, SSList* ssList, BgStaticFlatList* list) {
+    CollisionPoly* polyList = colCtx->colHeader->polyList;
+    Vec3s* vtxList = colCtx->colHeader->vtxList;
+    BgStaticPolyBlock* block = NULL;
+    CollisionPoly* poly;
+    SSNode* curNode;
+    Vec3f* vtx;
+    s32 lane;
+    s32 i;
+    f32 normalXZ;
+    fu nan;
+
+    nan.i = 0x7FC00000;
+
+    list->blockStart = sBgStaticFlat.blockCount;
+    list->count = 0;
+    if (ssList->head == SS_NULL) {
+        return;
+    }
+
+    curNode = &colCtx->polyNodes.tbl[ssList->head];
+    while (true) {
+        lane = list->count % BGFLAT_LANES;
+        if (lane == 0) {
+            block = sBgStaticFlat.blockCount < sBgStaticFlat.blockMax ? &sBgStaticFlat.blocks[sBgStaticFlat.blockCount]
+                                                                      : NULL;
+            sBgStaticFlat.blockCount++;
+            if (block != NULL) {
+                bzero(block, sizeof(BgStaticPolyBlock));
+            }
+        }
+        list->count++;
+
+        if (block != NULL) {
+            poly = &polyList[curNode->polyId];
+            vtx = block->vtx[lane];
+            Math_Vec3s_ToVec3f(&vtx[0], &vtxList[COLPOLY_VTX_INDEX(poly->flags_vIA)]);
+            Math_Vec3s_ToVec3f(&vtx[1], &vtxList[COLPOLY_VTX_INDEX(poly->flags_vIB)]);
+            Math_Vec3s_ToVec3f(&vtx[2], &vtxList[poly->vIC]);
+
+            block->minY[lane] = vtx[0].y;
+            block->minX[lane] = block->maxX[lane] = vtx[0].x;
+            block->minZ[lane] = block->maxZ[lane] = vtx[0].z;
+            for (i = 1; i < 3; i++) {
+                block->minY[lane] = CLAMP_MAX(block->minY[lane], vtx[i].y);
+                block->minX[lane] = CLAMP_MAX(block->minX[lane], vtx[i].x);
+                block->maxX[lane] = CLAMP_MIN(block->maxX[lane], vtx[i].x);
+                block->minZ[lane] = CLAMP_MAX(block->minZ[lane], vtx[i].z);
+                block->maxZ[lane] = CLAMP_MIN(block->maxZ[lane], vtx[i].z);
+            }
+            block->lineMinY[lane] = CollisionPoly_GetMinY(poly, vtxList);
+
+            block->snx[lane] = poly->normal.x;
+            block->sny[lane] = poly->normal.y;
+            block->snz[lane] = poly->normal.z;
+            block->nx[lane] = COLPOLY_GET_NORMAL(poly->normal.x);
+            block->ny[lane] = COLPOLY_GET_NORMAL(poly->normal.y);
+            block->nz[lane] = COLPOLY_GET_NORMAL(poly->normal.z);
+            block->dist[lane] = poly->dist;
+
+            block->normMag[lane] = sqrtf(SQ(block->nx[lane]) + SQ(block->ny[lane]) + SQ(block->nz[lane]));
+            if (IS_ZERO(block->normMag[lane])) {
+                block->normMag[lane] = nan.f;
+            }
+            normalXZ = sqrtf(SQ(block->nx[lane]) + SQ(block->nz[lane]));
+            if (IS_ZERO(normalXZ)) {
+                block->facingX[lane] = block->facingZ[lane] = nan.f;
+            } else {
+                block->facingX[lane] = fabsf(block->nx[lane]) * (1.0f / normalXZ);
+                block->facingZ[lane] = fabsf(block->nz[lane]) * (1.0f / normalXZ);
+            }
+
+            block->flags_vIA[lane] = poly->flags_vIA;
+            block->polyId[lane] = curNode->polyId;
+        }
+
+        if (curNode->next == SS_NULL) {
+            break;
+        }
+        curNode = &colCtx->polyNodes.tbl[curNode->next];
+    }
+}
+
+/**
+ * Bake the flattened copy of every StaticLookup list of `colCtx`
+ */
+static void BgCheck_FlattenStaticLookup(CollisionContext* colCtx) {
+    u32 lookupCount = colCtx->subdivAmount.x * colCtx->subdivAmount.y * colCtx->subdivAmount.z;
+    StaticLookup* lookup;
+    BgStaticFlatLookup* flat;
+    u32 i;
+
+    sBgStaticFlat.colCtx = NULL;
+    sBgStaticFlat.enabled = CVar_GetS32("gFlatStaticCollision", 1) != 0;
+
+    if (sBgStaticFlat.lookupMax < lookupCount) {
+        free(sBgStaticFlat.lookupTbl);
+        sBgStaticFlat.lookupTbl = malloc(lookupCount * sizeof(BgStaticFlatLookup));
+        sBgStaticFlat.lookupMax = sBgStaticFlat.lookupTbl != NULL ? lookupCount : 0;
+        if (sBgStaticFlat.lookupTbl == NULL) {
+            return;
+        }
+    }
+
+    // the first pass only counts blocks if the previous scene needed fewer
+    while (true) {
+        sBgStaticFlat.blockCount = 0;
+        for (i = 0; i < lookupCount; i++) {
+            lookup = &colCtx->lookupTbl[i];
+            flat = &sBgStaticFlat.lookupTbl[i];
+            BgCheck_FlattenSSList(colCtx, &lookup->floor, &flat->floor);
+            BgCheck_FlattenSSList(colCtx, &lookup->wall, &flat->wall);
+            BgCheck_FlattenSSList(colCtx, &lookup->ceiling, &flat->ceiling);
+        }
+        if (sBgStaticFlat.blockCount <= sBgStaticFlat.blockMax) {
+            break;
+        }
+
+        free(sBgStaticFlat.blocks);
+        sBgStaticFlat.blocks = malloc(sBgStaticFlat.blockCount * sizeof(BgStaticPolyBlock));
+        sBgStaticFlat.blockMax = sBgStaticFlat.blocks != NULL ? sBgStaticFlat.blockCount : 0;
+        if (sBgStaticFlat.blocks == NULL) {
+            return;
+        }
+    }
+
+    sBgStaticFlat.colCtx = colCtx;
+    sBgStaticFlat.colHeader = colCtx->colHeader;
+}
+
 /**
  * Locates the closest static poly directly underneath `pos`, starting at list `ssList`
  * returns yIntersect of the closest poly, or `yIntersectMin`
@@ -576,9 +1248,13 @@ f32 BgCheck_RaycastFloorStatic(StaticLookup* lookup, CollisionContext* colCtx, u
                                Vec3f* pos, u32 arg5, f32 chkDist, f32 yIntersectMin) {
     s32 flag; // skip polys with normal.y < 0
     f32 yIntersect = yIntersectMin;
+    BgStaticFlatLookup* flat = BgCheck_GetFlatLookup(colCtx, lookup);
 
     if (arg5 & 4) {
-        yIntersect = BgCheck_RaycastFloorStaticList(colCtx, xpFlags, &lookup->floor, poly, pos, yIntersect, chkDist, 0);
+        yIntersect =
+            flat != NULL
+                ? BgCheck_RaycastFloorStaticFlat(colCtx, xpFlags, &flat->floor, poly, pos, yIntersect, chkDist, 0)
+                : BgCheck_RaycastFloorStaticList(colCtx, xpFlags, &lookup->floor, poly, pos, yIntersect, chkDist, 0);
     }
 
     if ((arg5 & 2) || (arg5 & 8)) {
@@ -587,7 +1263,9 @@ f32 BgCheck_RaycastFloorStatic(StaticLookup* lookup, CollisionContext* colCtx, u
             flag = 1;
         }
         yIntersect =
-            BgCheck_RaycastFloorStaticList(colCtx, xpFlags, &lookup->wall, poly, pos, yIntersect, chkDist, flag);
+            flat != NULL
+                ? BgCheck_RaycastFloorStaticFlat(colCtx, xpFlags, &flat->wall, poly, pos, yIntersect, chkDist, flag)
+                : BgCheck_RaycastFloorStaticList(colCtx, xpFlags, &lookup->wall, poly, pos, yIntersect, chkDist, flag);
     }
 
     if (arg5 & 1) {
@@ -595,8 +1273,10 @@ f32 BgCheck_RaycastFloorStatic(StaticLookup* lookup, CollisionContext* colCtx, u
         if (arg5 & 0x10) {
             flag = 1;
         }
-        yIntersect =
-            BgCheck_RaycastFloorStaticList(colCtx, xpFlags, &lookup->ceiling, poly, pos, yIntersect, chkDist, flag);
+        yIntersect = flat != NULL ? BgCheck_RaycastFloorStaticFlat(colCtx, xpFlags, &flat->ceiling, poly, pos,
+                                                                   yIntersect, chkDist, flag)
+                                  : BgCheck_RaycastFloorStaticList(colCtx, xpFlags, &lookup->ceiling, poly, pos,
+                                                                   yIntersect, chkDist, flag);
     }
 
     return yIntersect;
@@ -667,6 +1347,11 @@ s32 BgCheck_SphVsStaticWall(StaticLookup* lookup, CollisionContext* colCtx, u16
     f32 zMax;
     f32 xMin;
     f32 xMax;
+    BgStaticFlatLookup* flat = BgCheck_GetFlatLookup(colCtx, lookup);
+
+    if (flat != NULL) {
+        return BgCheck_SphVsStaticWallFlat(flat, colCtx, xpFlags, outX, outZ, pos, radius, outPoly);
+    }
 
     result = false;
     if (lookup->wall.head == SS_NULL) {
@@ -860,6 +1545,11 @@ s32 BgCheck_CheckStaticCeiling(StaticLookup* lookup, u16 xpFlags, CollisionConte
     Vec3s* vtxList;
     SSNode* curNode;
     s32 curPolyId;
+    BgStaticFlatLookup* flat = BgCheck_GetFlatLookup(colCtx, lookup);
+
+    if (flat != NULL) {
+        return BgCheck_CheckStaticCeilingFlat(flat, xpFlags, colCtx, outY, pos, checkHeight, outPoly);
+    }
 
     if (lookup->ceiling.head == SS_NULL) {
         return false;
@@ -980,6 +1670,26 @@ s32 BgCheck_CheckLineInSubdivision(StaticLookup* lookup, CollisionContext* colCt
                                    Vec3f* posA, Vec3f* posB, Vec3f* outPos, CollisionPoly** outPoly, f32 chkDist,
                                    f32* outDistSq, u32 bccFlags) {
     s32 result = false;
+    BgStaticFlatLookup* flat = BgCheck_GetFlatLookup(colCtx, lookup);
+
+    if (flat != NULL) {
+        if ((bccFlags & BGCHECK_CHECK_FLOOR) &&
+            BgCheck_CheckLineAgainstFlatList(&flat->floor, colCtx, xpFlags1, xpFlags2, posA, posB, outPos, outPoly,
+                                             outDistSq, chkDist, bccFlags)) {
+            result = true;
+        }
+        if ((bccFlags & BGCHECK_CHECK_WALL) &&
+            BgCheck_CheckLineAgainstFlatList(&flat->wall, colCtx, xpFlags1, xpFlags2, posA, posB, outPos, outPoly,
+                                             outDistSq, chkDist, bccFlags)) {
+            result = true;
+        }
+        if ((bccFlags & BGCHECK_CHECK_CEILING) &&
+            BgCheck_CheckLineAgainstFlatList(&flat->ceiling, colCtx, xpFlags1, xpFlags2, posA, posB, outPos, outPoly,
+                                             outDistSq, chkDist, bccFlags)) {
+            result = true;
+        }
+        return result;
+    }
 
     if ((bccFlags & BGCHECK_CHECK_FLOOR) && lookup->floor.head != SS_NULL) {
         if (BgCheck_CheckLineAgainstSSList(&lookup->floor, colCtx, xpFlags1, xpFlags2, posA, posB, outPos, outPoly,
@@ -1603,6 +2313,7 @@ void BgCheck_Allocate(CollisionContext* colCtx, GlobalContext* globalCtx, Collis
     SSNodeList_Alloc(globalCtx, &colCtx->polyNodes, tblMax, colCtx->colHeader->numPolygons);
 
     lookupTblMemSize = BgCheck_InitializeStaticLookup(colCtx, globalCtx, colCtx->lookupTbl);
+    BgCheck_FlattenStaticLookup(colCtx);
     osSyncPrintf(VT_FGCOL(GREEN));
     osSyncPrintf("/*---結局 BG使用サイズ %dbyte---*/\n", memSize + lookupTblMemSize);
     osSyncPrintf(VT_RST);
@@ -1611,6 +2322,189 @@ void BgCheck_Allocate(CollisionContext* colCtx, GlobalContext* globalCtx, Collis
     DynaPoly_Alloc(globalCtx, &colCtx->dyna);
 }
 
+typedef struct {
+    Vec3f pos;
+    Vec3f posB;
+    f32 radius;
+    f32 checkHeight;
+    u16 xpFlags;
+    u16 xpFlags2;
+    u32 floorFlags; // arg5 of BgCheck_RaycastFloorStatic
+    u32 bccFlags;
+} BgStaticQuery;
+
+typedef struct {
+    f32 floorY;
+    CollisionPoly* floorPoly;
+    s32 wallHit;
+    f32 wallX;
+    f32 wallZ;
+    CollisionPoly* wallPoly;
+    s32 ceilingHit;
+    f32 ceilingY;
+    CollisionPoly* ceilingPoly;
+    s32 lineHit;
+    Vec3f linePos;
+    Vec3f linePosB;
+    f32 lineDistSq;
+    CollisionPoly* linePoly;
+} BgStaticQueryResult;
+
+static u32 BgCheck_QueryRand(u32* seed) {
+    *seed = *seed * 1664525 + 1013904223;
+    return *seed >> 8;
+}
+
+static f32 BgCheck_QueryRandF(u32* seed, f32 min, f32 max) {
+    return min + (max - min) * (BgCheck_QueryRand(seed) & 0xFFFF) * (1.0f / 0xFFFF);
+}
+
+/**
+ * Make a query around a random point of the scene's static collision, or anywhere within its bounds
+ */
+static void BgCheck_MakeStaticQuery(CollisionContext* colCtx, u32* seed, BgStaticQuery* query) {
+    CollisionHeader* colHeader = colCtx->colHeader;
+    CollisionPoly* poly;
+    Vec3f verts[3];
+    f32 a;
+    f32 b;
+
+    if (colHeader->numPolygons != 0 && (BgCheck_QueryRand(seed) & 3) != 0) {
+        poly = &colHeader->polyList[BgCheck_QueryRand(seed) % colHeader->numPolygons];
+        CollisionPoly_GetVertices(poly, colHeader->vtxList, verts);
+        a = BgCheck_QueryRandF(seed, 0.0f, 1.0f);
+        b = BgCheck_QueryRandF(seed, 0.0f, 1.0f - a);
+        query->pos.x = verts[0].x + a * (verts[1].x - verts[0].x) + b * (verts[2].x - verts[0].x);
+        query->pos.y = verts[0].y + a * (verts[1].y - verts[0].y) + b * (verts[2].y - verts[0].y);
+        query->pos.z = verts[0].z + a * (verts[1].z - verts[0].z) + b * (verts[2].z - verts[0].z);
+        query->pos.x += BgCheck_QueryRandF(seed, -60.0f, 60.0f);
+        query->pos.y += BgCheck_QueryRandF(seed, -40.0f, 80.0f);
+        query->pos.z += BgCheck_QueryRandF(seed, -60.0f, 60.0f);
+    } else {
+        query->pos.x = BgCheck_QueryRandF(seed, colCtx->minBounds.x, colCtx->maxBounds.x);
+        query->pos.y = BgCheck_QueryRandF(seed, colCtx->minBounds.y, colCtx->maxBounds.y);
+        query->pos.z = BgCheck_QueryRandF(seed, colCtx->minBounds.z, colCtx->maxBounds.z);
+    }
+
+    query->posB.x = query->pos.x + BgCheck_QueryRandF(seed, -300.0f, 300.0f);
+    query->posB.y = query->pos.y + BgCheck_QueryRandF(seed, -300.0f, 300.0f);
+    query->posB.z = query->pos.z + BgCheck_QueryRandF(seed, -300.0f, 300.0f);
+    query->radius = BgCheck_QueryRandF(seed, 5.0f, 60.0f);
+    query->checkHeight = BgCheck_QueryRandF(seed, 10.0f, 80.0f);
+    query->xpFlags = BgCheck_QueryRand(seed) & 7;
+    query->xpFlags2 = (BgCheck_QueryRand(seed) & 3) == 0 ? (BgCheck_QueryRand(seed) & 7) : 0;
+    query->floorFlags = BgCheck_QueryRand(seed) & 0x1F;
+    query->bccFlags = BgCheck_QueryRand(seed) &
+                      (BGCHECK_CHECK_WALL | BGCHECK_CHECK_FLOOR | BGCHECK_CHECK_CEILING | BGCHECK_CHECK_ONE_FACE);
+}
+
+/**
+ * Run `query` as a floor raycast, wall and ceiling check and line test on the StaticLookup around it
+ */
+static void BgCheck_RunStaticQuery(CollisionContext* colCtx, BgStaticQuery* query, BgStaticQueryResult* result) {
+    StaticLookup* lookup = BgCheck_GetNearestStaticLookup(colCtx, colCtx->lookupTbl, &query->pos);
+
+    result->floorPoly = NULL;
+    result->floorY = BgCheck_RaycastFloorStatic(lookup, colCtx, query->xpFlags, &result->floorPoly, &query->pos,
+                                                query->floorFlags, 1.0f, BGCHECK_Y_MIN);
+
+    result->wallPoly = NULL;
+    result->wallX = result->wallZ = 0.0f;
+    result->wallHit = BgCheck_SphVsStaticWall(lookup, colCtx, query->xpFlags, &result->wallX, &result->wallZ,
+                                              &query->pos, query->radius, &result->wallPoly);
+
+    result->ceilingPoly = NULL;
+    result->ceilingY = 0.0f;
+    result->ceilingHit = BgCheck_CheckStaticCeiling(lookup, query->xpFlags, colCtx, &result->ceilingY, &query->pos,
+                                                    query->checkHeight, &result->ceilingPoly);
+
+    bzero(colCtx->polyNodes.polyCheckTbl, colCtx->colHeader->numPolygons);
+    result->linePoly = NULL;
+    result->linePosB = query->posB;
+    result->linePos = query->posB;
+    result->lineDistSq = Math3D_Vec3fDistSq(&query->pos, &query->posB);
+    result->lineHit = BgCheck_CheckLineInSubdivision(lookup, colCtx, query->xpFlags, query->xpFlags2, &query->pos,
+                                                     &result->linePosB, &result->linePos, &result->linePoly, 1.0f,
+                                                     &result->lineDistSq, query->bccFlags);
+}
+
+/**
+ * Run `count` random static queries through both the SSList walks and the flattened lists, counting the queries whose
+ * floor, wall, ceiling and line results differ in `mismatches`
+ * returns false if there are no flattened lists for `colCtx`
+ */
+s32 BgCheck_CompareFlatStaticLookup(CollisionContext* colCtx, s32 count, u32 seed, s32* mismatches) {
+    s32 enabled = sBgStaticFlat.enabled;
+    u8* checkTbl;
+    BgStaticQuery query;
+    BgStaticQueryResult listResult;
+    BgStaticQueryResult flatResult;
+    s32 i;
+
+    mismatches[0] = mismatches[1] = mismatches[2] = mismatches[3] = 0;
+    if (sBgStaticFlat.colCtx != colCtx || sBgStaticFlat.colHeader != colCtx->colHeader) {
+        return false;
+    }
+    checkTbl = malloc(colCtx->colHeader->numPolygons + 1);
+    if (checkTbl == NULL) {
+        return false;
+    }
+
+    for (i = 0; i < count; i++) {
+        BgCheck_MakeStaticQuery(colCtx, &seed, &query);
+
+        sBgStaticFlat.enabled = false;
+        BgCheck_RunStaticQuery(colCtx, &query, &listResult);
+        memcpy(checkTbl, colCtx->polyNodes.polyCheckTbl, colCtx->colHeader->numPolygons);
+        sBgStaticFlat.enabled = true;
+        BgCheck_RunStaticQuery(colCtx, &query, &flatResult);
+
+        if (listResult.floorY != flatResult.floorY || listResult.floorPoly != flatResult.floorPoly) {
+            mismatches[0]++;
+        }
+        if (listResult.wallHit != flatResult.wallHit || listResult.wallX != flatResult.wallX ||
+            listResult.wallZ != flatResult.wallZ || listResult.wallPoly != flatResult.wallPoly) {
+            mismatches[1]++;
+        }
+        if (listResult.ceilingHit != flatResult.ceilingHit || listResult.ceilingY != flatResult.ceilingY ||
+            listResult.ceilingPoly != flatResult.ceilingPoly) {
+            mismatches[2]++;
+        }
+        if (listResult.lineHit != flatResult.lineHit || listResult.linePoly != flatResult.linePoly ||
+            listResult.lineDistSq != flatResult.lineDistSq || listResult.linePos.x != flatResult.linePos.x ||
+            listResult.linePos.y != flatResult.linePos.y || listResult.linePos.z != flatResult.linePos.z ||
+            memcmp(checkTbl, colCtx->polyNodes.polyCheckTbl, colCtx->colHeader->numPolygons) != 0) {
+            mismatches[3]++;
+        }
+    }
+
+    free(checkTbl);
+    sBgStaticFlat.enabled = enabled;
+    return true;
+}
+
+/**
+ * Run the same `count` random static queries as BgCheck_CompareFlatStaticLookup through the flattened lists if `flat`,
+ * else through the SSList walks, for timing
+ * returns the number of queries that found a wall
+ */
+s32 BgCheck_RunStaticQueries(CollisionContext* colCtx, s32 count, u32 seed, s32 flat) {
+    s32 enabled = sBgStaticFlat.enabled;
+    BgStaticQuery query;
+    BgStaticQueryResult result;
+    s32 walls = 0;
+    s32 i;
+
+    sBgStaticFlat.enabled = flat;
+    for (i = 0; i < count; i++) {
+        BgCheck_MakeStaticQuery(colCtx, &seed, &query);
+        BgCheck_RunStaticQuery(colCtx, &query, &result);
+        walls += result.wallHit;
+    }
+    sBgStaticFlat.enabled = enabled;
+    return walls;
+}
+
 /**
  * Get CollisionHeader
  * original name: T_BGCheck_getBGDataInfo
@@ -2581,6 +3475,16 @@ void DynaPoly_SetBgActorPrevTransform(GlobalContext* globalCtx, BgActor* bgActor
     bgActor->prevTransform = bgActor->curTransform;
 }
 
+// bgActorFlags each BgActor was last expanded with by DynaPoly_SetupIncremental, or 0 if its vertices, polys and
+// lookup lists have to be expanded again. Its nodes then sit at the same indices in polyNodes as its polys in polyList.
+static u16 sBgActorExpandedFlags[BG_ACTOR_MAX];
+
+// Set by func_8003EE6C, which actors call after rewriting the vertices of their CollisionHeader in place. Nothing says
+// which BgActor that was, so DynaPoly_SetupIncremental expands all of them again.
+static s32 sDynaPolyExpandAll;
+
+#define BGACTOR_EXPANDED 0x8000
+
 /**
  * Is BgActor Id
  */
@@ -2610,7 +3514,9 @@ void DynaPoly_Alloc(GlobalContext* globalCtx, DynaCollisionContext* dyna) {
     for (i = 0; i < BG_ACTOR_MAX; i++) {
         BgActor_Initialize(globalCtx, &dyna->bgActors[i]);
         dyna->bgActorFlags[i] = 0;
+        sBgActorExpandedFlags[i] = 0;
     }
+    sDynaPolyExpandAll = false;
     DynaPoly_NullPolyList(&dyna->polyList);
     DynaPoly_AllocPolyList(globalCtx, &dyna->polyList, dyna->polyListMax);
 
@@ -2734,6 +3640,7 @@ void DynaPoly_DeleteBgActor(GlobalContext* globalCtx, DynaCollisionContext* dyna
 
 void func_8003EE6C(GlobalContext* globalCtx, DynaCollisionContext* dyna) {
     dyna->bitFlag |= DYNAPOLY_INVALIDATE_LOOKUP;
+    sDynaPolyExpandAll = true;
 }
 
 /**
@@ -2935,6 +3842,153 @@ void func_8003F8EC(GlobalContext* globalCtx, DynaCollisionContext* dyna, Actor*
     }
 }
 
+/**
+ * Moves an expanded BgActor's vertices to `vtxStartIndex` and renumbers the vertices of its polys, which have not
+ * been moved yet
+ */
+void DynaPoly_MoveBgActorVtx(DynaCollisionContext* dyna, s32 bgId, s32 vtxStartIndex) {
+    BgActor* bgActor = &dyna->bgActors[bgId];
+    s32 delta = vtxStartIndex - bgActor->vtxStartIndex;
+    s32 i;
+
+    memmove(&dyna->vtxList[vtxStartIndex], &dyna->vtxList[bgActor->vtxStartIndex],
+            bgActor->colHeader->numVertices * sizeof(Vec3s));
+
+    for (i = 0; i < bgActor->colHeader->numPolygons; i++) {
+        CollisionPoly* poly = &dyna->polyList[bgActor->dynaLookup.polyStartIndex + i];
+
+        poly->flags_vIA = (COLPOLY_VTX_INDEX(poly->flags_vIA) + delta) | (poly->flags_vIA & 0xE000);
+        poly->flags_vIB = (COLPOLY_VTX_INDEX(poly->flags_vIB) + delta) | (poly->flags_vIB & 0xE000);
+        poly->vIC += delta;
+    }
+    bgActor->vtxStartIndex = vtxStartIndex;
+}
+
+/**
+ * Renumbers the nodes of a dyna lookup list that was moved by `delta` along with its polys
+ */
+void DynaPoly_MoveSSList(DynaCollisionContext* dyna, SSList* ssList, s32 delta) {
+    SSNode* node;
+
+    if (ssList->head == SS_NULL) {
+        return;
+    }
+
+    ssList->head += delta;
+    node = &dyna->polyNodes.tbl[ssList->head];
+    while (true) {
+        node->polyId += delta;
+        if (node->next == SS_NULL) {
+            break;
+        }
+        node->next += delta;
+        node = &dyna->polyNodes.tbl[node->next];
+    }
+}
+
+/**
+ * Moves an expanded BgActor's polys, and the nodes of its lookup lists with them, to `polyStartIndex`
+ */
+void DynaPoly_MoveBgActorPolys(DynaCollisionContext* dyna, s32 bgId, s32 polyStartIndex) {
+    BgActor* bgActor = &dyna->bgActors[bgId];
+    s32 delta = polyStartIndex - bgActor->dynaLookup.polyStartIndex;
+
+    memmove(&dyna->polyList[polyStartIndex], &dyna->polyList[bgActor->dynaLookup.polyStartIndex],
+            bgActor->colHeader->numPolygons * sizeof(CollisionPoly));
+    memmove(&dyna->polyNodes.tbl[polyStartIndex], &dyna->polyNodes.tbl[bgActor->dynaLookup.polyStartIndex],
+            bgActor->colHeader->numPolygons * sizeof(SSNode));
+
+    DynaPoly_MoveSSList(dyna, &bgActor->dynaLookup.floor, delta);
+    DynaPoly_MoveSSList(dyna, &bgActor->dynaLookup.wall, delta);
+    DynaPoly_MoveSSList(dyna, &bgActor->dynaLookup.ceiling, delta);
+    bgActor->dynaLookup.polyStartIndex = polyStartIndex;
+}
+
+/**
+ * Expands only the BgActors that moved, were added or had their flags changed since the last frame, or all of them after
+ * func_8003EE6C. The others keep what they were expanded to and are only moved within the dyna lists when an actor
+ * before them is added or removed.
+ * Each BgActor's nodes are kept next to each other at its poly indices, so they can be moved along with the polys.
+ */
+void DynaPoly_SetupIncremental(GlobalContext* globalCtx, DynaCollisionContext* dyna) {
+    s32 vtxStartIndices[BG_ACTOR_MAX];
+    s32 polyStartIndices[BG_ACTOR_MAX];
+    u8 isExpanded[BG_ACTOR_MAX];
+    s32 vtxStartIndex = 0;
+    s32 polyStartIndex = 0;
+    s32 i;
+
+    for (i = 0; i < BG_ACTOR_MAX; i++) {
+        BgActor* bgActor = &dyna->bgActors[i];
+        Vec3f pos;
+
+        isExpanded[i] = false;
+        if (!(dyna->bgActorFlags[i] & 1)) {
+            continue;
+        }
+
+        vtxStartIndices[i] = vtxStartIndex;
+        polyStartIndices[i] = polyStartIndex;
+        if (dyna->bgActorFlags[i] & 4) {
+            continue;
+        }
+
+        pos = bgActor->actor->world.pos;
+        pos.y += bgActor->actor->shape.yOffset * bgActor->actor->scale.y;
+        ScaleRotPos_SetValue(&bgActor->curTransform, &bgActor->actor->scale, &bgActor->actor->shape.rot, &pos);
+
+        vtxStartIndex += bgActor->colHeader->numVertices;
+        polyStartIndex += bgActor->colHeader->numPolygons;
+        // DynaPoly_ExpandSRT leaves out the ceilings of actors with flag 8 only when it does not transform them, so
+        // those keep going through it
+        isExpanded[i] = !sDynaPolyExpandAll &&
+                        sBgActorExpandedFlags[i] == (dyna->bgActorFlags[i] | BGACTOR_EXPANDED) &&
+                        !(dyna->bgActorFlags[i] & 8) && BgActor_IsTransformUnchanged(bgActor) &&
+                        vtxStartIndex <= dyna->vtxListMax && polyStartIndex <= dyna->polyListMax;
+    }
+
+    // Moving everything toward the start of the lists in order and everything toward the end in reverse order never
+    // writes over an actor that is still waiting to be moved
+    for (i = 0; i < BG_ACTOR_MAX; i++) {
+        if (isExpanded[i] && vtxStartIndices[i] < dyna->bgActors[i].vtxStartIndex) {
+            DynaPoly_MoveBgActorVtx(dyna, i, vtxStartIndices[i]);
+        }
+    }
+    for (i = BG_ACTOR_MAX - 1; i >= 0; i--) {
+        if (isExpanded[i] && vtxStartIndices[i] > dyna->bgActors[i].vtxStartIndex) {
+            DynaPoly_MoveBgActorVtx(dyna, i, vtxStartIndices[i]);
+        }
+    }
+    for (i = 0; i < BG_ACTOR_MAX; i++) {
+        if (isExpanded[i] && polyStartIndices[i] < dyna->bgActors[i].dynaLookup.polyStartIndex) {
+            DynaPoly_MoveBgActorPolys(dyna, i, polyStartIndices[i]);
+        }
+    }
+    for (i = BG_ACTOR_MAX - 1; i >= 0; i--) {
+        if (isExpanded[i] && polyStartIndices[i] > dyna->bgActors[i].dynaLookup.polyStartIndex) {
+            DynaPoly_MoveBgActorPolys(dyna, i, polyStartIndices[i]);
+        }
+    }
+
+    for (i = 0; i < BG_ACTOR_MAX; i++) {
+        s32 vtxIndex;
+        s32 polyIndex;
+
+        if (!(dyna->bgActorFlags[i] & 1) || isExpanded[i]) {
+            continue;
+        }
+
+        vtxIndex = vtxStartIndices[i];
+        polyIndex = polyStartIndices[i];
+        dyna->polyNodes.count = polyIndex;
+        DynaLookup_ResetLists(&dyna->bgActors[i].dynaLookup);
+        DynaPoly_ExpandSRT(globalCtx, dyna, i, &vtxIndex, &polyIndex);
+        sBgActorExpandedFlags[i] = (dyna->bgActorFlags[i] & 4) ? 0 : (dyna->bgActorFlags[i] | BGACTOR_EXPANDED);
+    }
+    dyna->polyNodes.count = polyStartIndex;
+    sDynaPolyExpandAll = false;
+}
+
 /**
  * DynaPolyInfo_setup
  */
@@ -2943,11 +3997,15 @@ void DynaPoly_Setup(GlobalContext* globalCtx, DynaCollisionContext* dyna) {
     s32 vtxStartIndex;
     s32 polyStartIndex;
     s32 i;
+    s32 incremental = CVar_GetS32("gIncrementalDynaPoly", 1) != 0;
 
-    DynaSSNodeList_ResetCount(&dyna->polyNodes);
+    if (!incremental) {
+        DynaSSNodeList_ResetCount(&dyna->polyNodes);
 
-    for (i = 0; i < BG_ACTOR_MAX; i++) {
-        DynaLookup_ResetLists(&dyna->bgActors[i].dynaLookup);
+        for (i = 0; i < BG_ACTOR_MAX; i++) {
+            DynaLookup_ResetLists(&dyna->bgActors[i].dynaLookup);
+            sBgActorExpandedFlags[i] = 0;
+        }
     }
 
     for (i = 0; i < BG_ACTOR_MAX; i++) {
@@ -2958,6 +4016,7 @@ void DynaPoly_Setup(GlobalContext* globalCtx, DynaCollisionContext* dyna) {
             osSyncPrintf(VT_RST);
 
             dyna->bgActorFlags[i] = 0;
+            sBgActorExpandedFlags[i] = 0;
             BgActor_Initialize(globalCtx, &dyna->bgActors[i]);
             dyna->bitFlag |= DYNAPOLY_INVALIDATE_LOOKUP;
         }
@@ -2972,11 +4031,18 @@ void DynaPoly_Setup(GlobalContext* globalCtx, DynaCollisionContext* dyna) {
             }
             actor->bgId = BGACTOR_NEG_ONE;
             dyna->bgActorFlags[i] = 0;
+            sBgActorExpandedFlags[i] = 0;
 
             BgActor_Initialize(globalCtx, &dyna->bgActors[i]);
             dyna->bitFlag |= DYNAPOLY_INVALIDATE_LOOKUP;
         }
     }
+    if (incremental) {
+        DynaPoly_SetupIncremental(globalCtx, dyna);
+        dyna->bitFlag &= ~DYNAPOLY_INVALIDATE_LOOKUP;
+        return;
+    }
+
     vtxStartIndex = 0;
     polyStartIndex = 0;
     for (i = 0; i < BG_ACTOR_MAX; i++) {
@@ -2984,6 +4050,7 @@ void DynaPoly_Setup(GlobalContext* globalCtx, DynaCollisionContext* dyna) {
             DynaPoly_ExpandSRT(globalCtx, dyna, i, &vtxStartIndex, &polyStartIndex);
         }
     }
+    sDynaPolyExpandAll = false;
     dyna->bitFlag &= ~DYNAPOLY_INVALIDATE_LOOKUP;
 }
 
@@ -2590,6 +2590,141 @@ static ColChkVsFunc sACVsFuncs[4][4] = {
       CollisionCheck_AC_QuadVsQuad },
 };
 
+#define COLCHK_BROADPHASE_MARGIN 8.0f
+
+typedef struct {
+    /* 0x00 */ Vec3f min;
+    /* 0x0C */ Vec3f max;
+} ColChkBounds; // size = 0x18
+
+static void CollisionCheck_BoundsAddPoint(ColChkBounds* bounds, f32 x, f32 y, f32 z, f32 pad) {
+    f32 sum = x + y + z;
+
+    if (sum != sum) {
+        // NaN, can't say where this is so let everything through to the narrow phase
+        bounds->min.x = bounds->min.y = bounds->min.z = -FLT_MAX;
+        bounds->max.x = bounds->max.y = bounds->max.z = FLT_MAX;
+        return;
+    }
+    bounds->min.x = CLAMP_MAX(bounds->min.x, x - pad);
+    bounds->min.y = CLAMP_MAX(bounds->min.y, y - pad);
+    bounds->min.z = CLAMP_MAX(bounds->min.z, z - pad);
+    bounds->max.x = CLAMP_MIN(bounds->max.x, x + pad);
+    bounds->max.y = CLAMP_MIN(bounds->max.y, y + pad);
+    bounds->max.z = CLAMP_MIN(bounds->max.z, z + pad);
+}
+
+/**
+ * Gets a box around every part of `collider` the AC and OC narrow phases can test, padded by
+ * COLCHK_BROADPHASE_MARGIN to cover the tolerances of the Math3D tests. A NULL collider or one with no elements gets
+ * an empty box, and a collider of unknown shape an unbounded one.
+ */
+static void CollisionCheck_GetBounds(Collider* collider, ColChkBounds* bounds) {
+    s32 i;
+    s32 j;
+
+    bounds->min.x = bounds->min.y = bounds->min.z = FLT_MAX;
+    bounds->max.x = bounds->max.y = bounds->max.z = -FLT_MAX;
+    if (collider == NULL) {
+        return;
+    }
+
+    switch (collider->shape) {
+        case COLSHAPE_JNTSPH: {
+            ColliderJntSph* jntSph = (ColliderJntSph*)collider;
+
+            if (jntSph->elements == NULL) {
+                break;
+            }
+            for (i = 0; i < jntSph->count; i++) {
+                Sphere16* sphere = &jntSph->elements[i].dim.worldSphere;
+
+                CollisionCheck_BoundsAddPoint(bounds, sphere->center.x, sphere->center.y, sphere->center.z,
+                                              ABS(sphere->radius) + COLCHK_BROADPHASE_MARGIN);
+            }
+            break;
+        }
+        case COLSHAPE_CYLINDER: {
+            Cylinder16* cyl = &((ColliderCylinder*)collider)->dim;
+            f32 bottom = cyl->pos.y + cyl->yShift;
+            // tris are also tested against spheres of the cylinder's radius centered on its top and bottom
+            f32 pad = ABS(cyl->radius) + COLCHK_BROADPHASE_MARGIN;
+
+            CollisionCheck_BoundsAddPoint(bounds, cyl->pos.x, bottom, cyl->pos.z, pad);
+            CollisionCheck_BoundsAddPoint(bounds, cyl->pos.x, bottom + cyl->height, cyl->pos.z, pad);
+            break;
+        }
+        case COLSHAPE_TRIS: {
+            ColliderTris* tris = (ColliderTris*)collider;
+
+            if (tris->elements == NULL) {
+                break;
+            }
+            for (i = 0; i < tris->count; i++) {
+                for (j = 0; j < 3; j++) {
+                    Vec3f* vtx = &tris->elements[i].dim.vtx[j];
+
+                    CollisionCheck_BoundsAddPoint(bounds, vtx->x, vtx->y, vtx->z, COLCHK_BROADPHASE_MARGIN);
+                }
+            }
+            break;
+        }
+        case COLSHAPE_QUAD: {
+            ColliderQuad* quad = (ColliderQuad*)collider;
+
+            for (j = 0; j < 4; j++) {
+                Vec3f* vtx = &quad->dim.quad[j];
+
+                CollisionCheck_BoundsAddPoint(bounds, vtx->x, vtx->y, vtx->z, COLCHK_BROADPHASE_MARGIN);
+            }
+            break;
+        }
+        default:
+            bounds->min.x = bounds->min.y = bounds->min.z = -FLT_MAX;
+            bounds->max.x = bounds->max.y = bounds->max.z = FLT_MAX;
+            break;
+    }
+}
+
+static s32 CollisionCheck_BoundsOverlapYZ(ColChkBounds* a, ColChkBounds* b) {
+    return a->min.y <= b->max.y && b->min.y <= a->max.y && a->min.z <= b->max.z && b->min.z <= a->max.z;
+}
+
+/**
+ * Sorts the first `count` collider indices in `order` by the min x of their bounds
+ */
+static void CollisionCheck_SortBoundsX(ColChkBounds* bounds, u8* order, s32 count) {
+    s32 i;
+    s32 j;
+
+    for (i = 0; i < count; i++) {
+        u8 index = i;
+
+        for (j = i; j > 0 && bounds[order[j - 1]].min.x > bounds[index].min.x; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = index;
+    }
+}
+
+/**
+ * Performs AC collisions between the AT collider and a single AC collider, if they are compatible
+ */
+static void CollisionCheck_ACPair(GlobalContext* globalCtx, CollisionCheckContext* colChkCtx, Collider* colAT,
+                                  Collider* colAC) {
+    if (colAC != NULL && colAC->acFlags & AC_ON) {
+        if (colAC->actor != NULL && colAC->actor->update == NULL) {
+            return;
+        }
+        if ((colAC->acFlags & colAT->atFlags & AC_TYPE_ALL) && (colAT != colAC)) {
+            if (!(colAT->atFlags & AT_SELF) && colAT->actor != NULL && colAC->actor == colAT->actor) {
+                return;
+            }
+            sACVsFuncs[colAT->shape][colAC->shape](globalCtx, colChkCtx, colAT, colAC);
+        }
+    }
+}
+
 /**
  * Iterates through all AC colliders, performing AC collisions with the AT collider.
  */
@@ -2597,18 +2732,36 @@ void CollisionCheck_AC(GlobalContext* globalCtx, CollisionCheckContext* colChkCt
     Collider** col;
 
     for (col = colChkCtx->colAC; col < colChkCtx->colAC + colChkCtx->colACCount; col++) {
-        Collider* colAC = *col;
+        CollisionCheck_ACPair(globalCtx, colChkCtx, colAT, *col);
+    }
+}
 
-        if (colAC != NULL && colAC->acFlags & AC_ON) {
-            if (colAC->actor != NULL && colAC->actor->update == NULL) {
-                continue;
-            }
-            if ((colAC->acFlags & colAT->atFlags & AC_TYPE_ALL) && (colAT != colAC)) {
-                if (!(colAT->atFlags & AT_SELF) && colAT->actor != NULL && colAC->actor == colAT->actor) {
-                    continue;
-                }
-                sACVsFuncs[colAT->shape][colAC->shape](globalCtx, colChkCtx, colAT, colAC);
-            }
+/**
+ * Broad phase for CollisionCheck_AT. Sweeps the AT collider's bounds along the AC colliders sorted by min x, and only
+ * performs AC collisions with the ones whose bounds it overlaps. Candidates are collected into a mask and collided in
+ * list order, so hits are registered in the same order as CollisionCheck_AC.
+ */
+static void CollisionCheck_ACBroadPhase(GlobalContext* globalCtx, CollisionCheckContext* colChkCtx, Collider* colAT,
+                                        ColChkBounds* acBounds, u8* acOrder) {
+    ColChkBounds atBounds;
+    u64 candidates = 0;
+    s32 i;
+
+    CollisionCheck_GetBounds(colAT, &atBounds);
+    for (i = 0; i < colChkCtx->colACCount; i++) {
+        ColChkBounds* bounds = &acBounds[acOrder[i]];
+
+        if (bounds->min.x > atBounds.max.x) {
+            break;
+        }
+        if (bounds->max.x >= atBounds.min.x && CollisionCheck_BoundsOverlapYZ(bounds, &atBounds)) {
+            candidates |= 1ull << acOrder[i];
+        }
+    }
+
+    for (i = 0; candidates != 0; i++, candidates >>= 1) {
+        if (candidates & 1) {
+            CollisionCheck_ACPair(globalCtx, colChkCtx, colAT, colChkCtx->colAC[i]);
         }
     }
 }
@@ -2621,10 +2774,20 @@ void CollisionCheck_AC(GlobalContext* globalCtx, CollisionCheckContext* colChkCt
  */
 void CollisionCheck_AT(GlobalContext* globalCtx, CollisionCheckContext* colChkCtx) {
     Collider** col;
+    ColChkBounds acBounds[COLLISION_CHECK_AC_MAX];
+    u8 acOrder[COLLISION_CHECK_AC_MAX];
+    s32 broadPhase = CVar_GetS32("gCollisionBroadPhase", 1) != 0;
+    s32 i;
 
     if (colChkCtx->colATCount == 0 || colChkCtx->colACCount == 0) {
         return;
     }
+    if (broadPhase) {
+        for (i = 0; i < colChkCtx->colACCount; i++) {
+            CollisionCheck_GetBounds(colChkCtx->colAC[i], &acBounds[i]);
+        }
+        CollisionCheck_SortBoundsX(acBounds, acOrder, colChkCtx->colACCount);
+    }
     for (col = colChkCtx->colAT; col < colChkCtx->colAT + colChkCtx->colATCount; col++) {
         Collider* colAT = *col;
 
@@ -2632,7 +2795,11 @@ void CollisionCheck_AT(GlobalContext* globalCtx, CollisionCheckContext* colChkCt
             if (colAT->actor != NULL && colAT->actor->update == NULL) {
                 continue;
             }
-            CollisionCheck_AC(globalCtx, colChkCtx, colAT);
+            if (broadPhase) {
+                CollisionCheck_ACBroadPhase(globalCtx, colChkCtx, colAT, acBounds, acOrder);
+            } else {
+                CollisionCheck_AC(globalCtx, colChkCtx, colAT);
+            }
         }
     }
     CollisionCheck_SetHitEffects(globalCtx, colChkCtx);
@@ -2876,34 +3043,105 @@ static ColChkVsFunc sOCVsFuncs[4][4] = {
     { NULL, NULL, NULL, NULL },
 };
 
+/**
+ * Performs OC collisions between two colliders on the OC list, if they are compatible
+ */
+static void CollisionCheck_OCPair(GlobalContext* globalCtx, CollisionCheckContext* colChkCtx, Collider* left,
+                                  Collider* right) {
+    ColChkVsFunc vsFunc;
+
+    if (right == NULL || CollisionCheck_SkipOC(right) == 1 || CollisionCheck_Incompatible(left, right) == 1) {
+        return;
+    }
+    vsFunc = sOCVsFuncs[left->shape][right->shape];
+    if (vsFunc == NULL) {
+        // "Not compatible"
+        osSyncPrintf("CollisionCheck_OC():未対応 %d, %d\n", left->shape, right->shape);
+        return;
+    }
+    vsFunc(globalCtx, colChkCtx, left, right);
+}
+
+/**
+ * Broad phase for CollisionCheck_OC. Sweeps the OC colliders' bounds along x, keeping those whose x extents still
+ * overlap the current one active, and sets bit `j` of `pairs[i]` for each pair i < j whose bounds overlap.
+ */
+static void CollisionCheck_OCBroadPhase(CollisionCheckContext* colChkCtx, u64* pairs) {
+    ColChkBounds bounds[COLLISION_CHECK_OC_MAX];
+    u8 order[COLLISION_CHECK_OC_MAX];
+    u8 active[COLLISION_CHECK_OC_MAX];
+    s32 activeCount = 0;
+    s32 i;
+    s32 j;
+
+    for (i = 0; i < colChkCtx->colOCCount; i++) {
+        pairs[i] = 0;
+        CollisionCheck_GetBounds(colChkCtx->colOC[i], &bounds[i]);
+    }
+    CollisionCheck_SortBoundsX(bounds, order, colChkCtx->colOCCount);
+
+    for (i = 0; i < colChkCtx->colOCCount; i++) {
+        u8 index = order[i];
+        s32 kept = 0;
+
+        if (bounds[index].min.x > bounds[index].max.x) {
+            // empty, and so is everything after it
+            break;
+        }
+        for (j = 0; j < activeCount; j++) {
+            u8 other = active[j];
+
+            if (bounds[other].max.x < bounds[index].min.x) {
+                continue;
+            }
+            active[kept++] = other;
+            if (CollisionCheck_BoundsOverlapYZ(&bounds[index], &bounds[other])) {
+                if (other < index) {
+                    pairs[other] |= 1ull << index;
+                } else {
+                    pairs[index] |= 1ull << other;
+                }
+            }
+        }
+        active[kept++] = index;
+        activeCount = kept;
+    }
+}
+
 /**
  * Iterates through all OC colliders and collides them with all subsequent OC colliders on the list. During an OC
  * collision, colliders with overlapping elements move away from each other so that their elements no longer overlap.
  * The relative amount each collider is pushed is determined by the collider's mass. Only JntSph and Cylinder colliders
  * can collide, and each collider must have the OC flag corresponding to the other's OC type. Additionally, OC2_UNK1
  * cannot collide with OC2_UNK2, nor can two colliders that share an actor.
+ * With the broad phase enabled, only pairs whose bounds overlap are collided, still in list order.
  */
 void CollisionCheck_OC(GlobalContext* globalCtx, CollisionCheckContext* colChkCtx) {
     Collider** left;
     Collider** right;
-    ColChkVsFunc vsFunc;
+    u64 pairs[COLLISION_CHECK_OC_MAX];
+    u64 candidates;
+    s32 broadPhase = CVar_GetS32("gCollisionBroadPhase", 1) != 0;
+    s32 i;
 
+    if (broadPhase) {
+        CollisionCheck_OCBroadPhase(colChkCtx, pairs);
+    }
     for (left = colChkCtx->colOC; left < colChkCtx->colOC + colChkCtx->colOCCount; left++) {
         if (*left == NULL || CollisionCheck_SkipOC(*left) == 1) {
             continue;
         }
-        for (right = left + 1; right < colChkCtx->colOC + colChkCtx->colOCCount; right++) {
-            if (*right == NULL || CollisionCheck_SkipOC(*right) == 1 ||
-                CollisionCheck_Incompatible(*left, *right) == 1) {
-                continue;
+        if (broadPhase) {
+            candidates = pairs[left - colChkCtx->colOC];
+            for (i = 0; candidates != 0; i++, candidates >>= 1) {
+                if (candidates & 1) {
+                    CollisionCheck_OCPair(globalCtx, colChkCtx, *left, colChkCtx->colOC[i]);
+                }
             }
-            vsFunc = sOCVsFuncs[(*left)->shape][(*right)->shape];
-            if (vsFunc == NULL) {
-                // "Not compatible"
-                osSyncPrintf("CollisionCheck_OC():未対応 %d, %d\n", (*left)->shape, (*right)->shape);
-                continue;
+        } else {
+            for (right = left + 1; right < colChkCtx->colOC + colChkCtx->colOCCount; right++) {
+                CollisionCheck_OCPair(globalCtx, colChkCtx, *left, *right);
             }
-            vsFunc(globalCtx, colChkCtx, *left, *right);
         }
     }
 }
@@ -234,6 +234,13 @@ void Message_DrawTextChar(GlobalContext* globalCtx, void* textureImage, Gfx** p)
     Gfx* gfx = *p;
     s16 x = msgCtx->textPosX;
     s16 y = msgCtx->textPosY;
+    void* frameTexture;
+
+    // With the render pipeline the previous frame is still being drawn while Font_LoadChar rewrites charTexBuf for the
+    // next message, so every frame draws from a copy in its own graphics pool.
+    frameTexture = Graph_Alloc(globalCtx->state.gfxCtx, FONT_CHAR_TEX_SIZE);
+    memcpy(frameTexture, textureImage, FONT_CHAR_TEX_SIZE);
+    textureImage = frameTexture;
 
     //gSPInvalidateTexCache(gfx++, 0);
     //gSPInvalidateTexCache(gfx++, msgCtx->textboxSegment);
@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include "soh/Enhancements/gameconsole.h"
+#include "soh/Enhancements/debugger/actorProfiler.h"
 
 void* D_8012D1F0 = NULL;
 //UNK_TYPE D_8012D1F4 = 0; // unused
@@ -375,7 +376,7 @@ void Gameplay_Init(GameState* thisx) {
     func_800304DC(globalCtx, &globalCtx->actorCtx, globalCtx->linkActorEntry);
 
     while (!func_800973FC(globalCtx, &globalCtx->roomCtx)) {
-        ; // Empty Loop
+        OTRScene_WaitForRoomLoad();
     }
 
     player = GET_PLAYER(globalCtx);
@@ -418,6 +419,7 @@ void Gameplay_Update(GlobalContext* globalCtx) {
     Input* input;
     u32 i;
     s32 pad2;
+    u64 profStart;
 
     input = globalCtx->state.input;
 
@@ -838,19 +840,25 @@ void Gameplay_Update(GlobalContext* globalCtx) {
                         LOG_NUM("1", 1, "../z_play.c", 3612);
                     }
 
+                    profStart = ActorProfiler_Start();
                     CollisionCheck_AT(globalCtx, &globalCtx->colChkCtx);
+                    ActorProfiler_EndPhase(profStart, ACTORPROF_COLCHK_AT);
 
                     if (1 && HREG(63)) {
                         LOG_NUM("1", 1, "../z_play.c", 3618);
                     }
 
+                    profStart = ActorProfiler_Start();
                     CollisionCheck_OC(globalCtx, &globalCtx->colChkCtx);
+                    ActorProfiler_EndPhase(profStart, ACTORPROF_COLCHK_OC);
 
                     if (1 && HREG(63)) {
                         LOG_NUM("1", 1, "../z_play.c", 3624);
                     }
 
+                    profStart = ActorProfiler_Start();
                     CollisionCheck_Damage(globalCtx, &globalCtx->colChkCtx);
+                    ActorProfiler_EndPhase(profStart, ACTORPROF_COLCHK_DAMAGE);
 
                     if (1 && HREG(63)) {
                         LOG_NUM("1", 1, "../z_play.c", 3631);
@@ -1383,6 +1391,8 @@ void Gameplay_Main(GameState* thisx) {
     if (1 && HREG(63)) {
         LOG_NUM("1", 1, "../z_play.c", 4587);
     }
+
+    ActorProfiler_EndFrame();
 }
 
 // original name: "Game_play_demo_mode_check"